@@ -0,0 +1,6 @@
+#!/bin/bash
+# Kernel microbenchmark: qubit counts 10 to 28, 5 repeats, results appended to benchmark.csv
+
+../bin/benchmark.exe 10 28 5 benchmark.csv
+
+exit 0
@@ -0,0 +1,7 @@
+#!/bin/bash
+# Engine accuracy versus speed against the dense reference: qubit counts 4 to 10, target infidelity 1e-10,
+# results appended to pareto.csv
+
+../bin/pareto.exe 4 10 1e-10 pareto.csv
+
+exit 0
@@ -0,0 +1,769 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Runs many QAOA jobs from a job file in a single process, built as batch.exe
+ * @details The job file holds one job per line as whitespace separated key=value pairs; blank lines and anything after
+ * a '#' are ignored. Keys and their defaults:
+ *   name        identifier echoed in the result                               [job<line number>]
+ *   qubits      number of qubits                                              [4]
+ *   P           ascending ladder of P values, e.g. 1,2,4 or 1-3 or 1-3,5      [1]
+ *   optimiser   nlopt, spsa, adam or cmaes                                    [nlopt]
+ *   method      nlopt method: neldermead, sbplx or cobyla                     [neldermead]
+ *   max_evals   evaluation budget at each P                                   [200]
+ *   starts      number of concurrent starts                                   [1]
+ *   strategy    zero, interp or fourier                                       [interp]
+ *   sampling    0 or 1                                                        [0]
+ *   samples     number of samples when sampling                               [100]
+ *   restricted  0 or 1                                                        [0]
+ *   objective   expectation, cvar:<alpha> or gibbs:<eta>                      [expectation]
+ *   mixer       chebyshev, product, grover or xy                              [chebyshev]
+ *   xy          ring or complete, the pairs coupled by the XY mixer           [ring]
+ *   trotter     Trotter steps per layer of the XY mixer                       [1]
+ *   weight      Hamming weight the XY mixer starts from                       [qubits / 2]
+ *   symmetric   0 or 1, evolve only the bit-flip symmetric half-space         [0]
+ *   lightcone   0 or 1, evaluate MaxCut over light cones (see lightcone.h)    [0]
+ *   cache       MiB of layer-prefix state cache (see state_cache.h)           [0]
+ *   hamiltonian none, maxcut (the Z strings of the graph's cut) or file:<path>
+ *               (see ising.h), applied without storing UC                     [none]
+ *   graph       gnp:<p>, directed:<p>, regular:<d>, weighted:<p>:<w>
+ *               (see graph_generator.h) or file:<path> (adjacency matrix)     [gnp:0.5]
+ *   seed        seed of the graph sweep                                       [1]
+ *   instance    instance number within the sweep                              [0]
+ *   instances   number of consecutive instances optimised together            [1]
+ *   rng         seed of the run's random stream, 0 for the clock              [0]
+ *
+ * Each P of the ladder is started from the optimum of the previous one (grown with grow_params()). A job whose
+ * graph, seed, instance, qubits, mixer (and XY topology), symmetry, light-cone mode and Hamiltonian match the previous
+ * job reuses its UC and UB, so only the optimisation is repeated. A job with instances > 1 runs that many generated
+ * instances through the instance-batched engine (instance_batch.h), which needs a single P and a built-in optimiser.
+ * The usual text reports go to stdout; one JSON object per job is appended to the results file.
+ *
+ * With groups > 1 the cores are split into that many groups and the jobs run concurrently, one per group at a time
+ * (see job_runner.h). Every job then prepares its own UC and UB, and the reports and results are written in job order
+ * once all jobs have finished.
+ *
+ * Usage: batch.exe job_file [results_file [groups]]   (default batch_results.jsonl, 1 group)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <mathimf.h>
+#include "qaoa.h"
+#include "graph_generator.h"
+#include "instance_batch.h"
+#include "ising.h"
+#include "job_runner.h"
+
+#define BATCH_LINE_LENGTH 4096
+#define BATCH_NAME_LENGTH 64
+#define BATCH_MAX_LADDER 64
+
+/*! One job of the job file */
+typedef struct {
+    char name[BATCH_NAME_LENGTH];       /**< Identifier echoed in the result */
+    int num_qubits;                     /**< The number of qubits */
+    int ladder[BATCH_MAX_LADDER];       /**< The P values, ascending */
+    int ladder_length;                  /**< The number of P values */
+    optimiser_t optimiser;              /**< The classical optimiser */
+    int nlopt_method;                   /**< The nlopt method (OPTIMISER_NLOPT only) */
+    int max_evals;                      /**< The evaluation budget at each P */
+    int num_starts;                     /**< The number of concurrent starts */
+    parameter_strategy_t strategy;      /**< The parameter strategy */
+    bool sampling;                      /**< Whether the objective is sampled */
+    int num_samples;                    /**< The number of samples */
+    bool restricted;                    /**< Whether the restricted QAOA is run */
+    objective_t objective;              /**< The objective */
+    double objective_parameter;         /**< CVaR alpha or Gibbs eta */
+    mixer_engine_t mixer;               /**< The mixer engine */
+    xy_topology_t xy_topology;          /**< The pairs coupled by the XY mixer */
+    int xy_steps;                       /**< Trotter steps per layer of the XY mixer */
+    int xy_weight;                      /**< The Hamming weight of the XY mixer's Dicke state (-1 for qubits / 2) */
+    bool symmetric;                     /**< Whether only the bit-flip symmetric half-space is evolved */
+    bool lightcone;                     /**< Whether the expectation is evaluated over light cones */
+    int cache_mb;                       /**< The state cache budget in MiB (0 for none) */
+    char hamiltonian[BATCH_LINE_LENGTH];/**< The Hamiltonian source, "none" to use Cx() */
+    char graph[BATCH_LINE_LENGTH];      /**< The graph source */
+    unsigned seed;                      /**< The seed of the graph sweep */
+    MKL_INT instance;                   /**< The instance number within the sweep */
+    int num_instances;                  /**< The number of consecutive instances optimised together */
+    unsigned rng;                       /**< The seed of the run's random stream (0 for the clock) */
+} batch_job_t;
+
+/*! A job of a concurrent batch, with its own output */
+typedef struct {
+    batch_job_t job;                    /**< The job */
+    FILE *report;                       /**< Receives the job's text reports */
+    FILE *result;                       /**< Receives the job's JSON object */
+} batch_task_t;
+
+/**
+ * @brief Reports a malformed job file and exits
+ * @param line_number The offending line
+ * @param token The offending token
+ */
+void batch_error(int line_number, const char *token) {
+    fprintf(stderr, "Job file line %d: invalid entry '%s'.\n", line_number, token);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Parses a P ladder of comma separated values and ranges
+ * @param value The ladder, e.g. "1-3,5"
+ * @param job The job receiving the ladder
+ * @return False if the ladder is malformed, empty, too long or not ascending
+ */
+bool batch_ladder(const char *value, batch_job_t *job) {
+    int first, last, consumed;
+    job->ladder_length = 0;
+    while (*value != '\0') {
+        if (sscanf(value, "%d%n", &first, &consumed) != 1) {
+            return false;
+        }
+        value += consumed;
+        last = first;
+        if (*value == '-' && sscanf(value + 1, "%d%n", &last, &consumed) == 1) {
+            value += consumed + 1;
+        }
+        for (int P = first; P <= last; ++P) {
+            if (job->ladder_length == BATCH_MAX_LADDER || P <= 0 ||
+                (job->ladder_length > 0 && P <= job->ladder[job->ladder_length - 1])) {
+                return false;
+            }
+            job->ladder[job->ladder_length++] = P;
+        }
+        if (*value == ',') {
+            value++;
+        } else if (*value != '\0') {
+            return false;
+        }
+    }
+    return job->ladder_length > 0;
+}
+
+/**
+ * @brief Parses one line of the job file
+ * @param line The line (modified by tokenisation)
+ * @param line_number The line number, used for the default name and errors
+ * @param job The job to fill, set to the defaults first
+ * @return False if the line holds no job
+ */
+bool batch_parse(char *line, int line_number, batch_job_t *job) {
+    char *comment = strchr(line, '#');
+    char *token;
+    bool found = false;
+    if (comment != NULL) {
+        *comment = '\0';
+    }
+    snprintf(job->name, BATCH_NAME_LENGTH, "job%d", line_number);
+    job->num_qubits = 4;
+    job->ladder[0] = 1;
+    job->ladder_length = 1;
+    job->optimiser = OPTIMISER_NLOPT;
+    job->nlopt_method = NLOPT_LN_NELDERMEAD;
+    job->max_evals = 200;
+    job->num_starts = 1;
+    job->strategy = STRATEGY_INTERP;
+    job->sampling = false;
+    job->num_samples = 100;
+    job->restricted = false;
+    job->objective = OBJECTIVE_EXPECTATION;
+    job->objective_parameter = 0.0;
+    job->mixer = MIXER_CHEBYSHEV;
+    job->xy_topology = XY_RING;
+    job->xy_steps = 1;
+    job->xy_weight = -1;
+    job->symmetric = false;
+    job->lightcone = false;
+    job->cache_mb = 0;
+    strcpy(job->hamiltonian, "none");
+    strcpy(job->graph, "gnp:0.5");
+    job->seed = 1;
+    job->instance = 0;
+    job->num_instances = 1;
+    job->rng = 0;
+
+    for (token = strtok(line, " \t\r\n"); token != NULL; token = strtok(NULL, " \t\r\n")) {
+        char *value = strchr(token, '=');
+        bool valid = true;
+        if (value == NULL) {
+            batch_error(line_number, token);
+        }
+        *value++ = '\0';
+        found = true;
+        if (strcmp(token, "name") == 0) {
+            valid = strlen(value) < BATCH_NAME_LENGTH && strpbrk(value, "\"\\") == NULL;
+            if (valid) {
+                strcpy(job->name, value);
+            }
+        } else if (strcmp(token, "qubits") == 0) {
+            job->num_qubits = atoi(value);
+        } else if (strcmp(token, "P") == 0) {
+            valid = batch_ladder(value, job);
+        } else if (strcmp(token, "optimiser") == 0) {
+            if (strcmp(value, "nlopt") == 0) {
+                job->optimiser = OPTIMISER_NLOPT;
+            } else if (strcmp(value, "spsa") == 0) {
+                job->optimiser = OPTIMISER_SPSA;
+            } else if (strcmp(value, "adam") == 0) {
+                job->optimiser = OPTIMISER_ADAM;
+            } else if (strcmp(value, "cmaes") == 0) {
+                job->optimiser = OPTIMISER_CMAES;
+            } else {
+                valid = false;
+            }
+        } else if (strcmp(token, "method") == 0) {
+            if (strcmp(value, "neldermead") == 0) {
+                job->nlopt_method = NLOPT_LN_NELDERMEAD;
+            } else if (strcmp(value, "sbplx") == 0) {
+                job->nlopt_method = NLOPT_LN_SBPLX;
+            } else if (strcmp(value, "cobyla") == 0) {
+                job->nlopt_method = NLOPT_LN_COBYLA;
+            } else {
+                valid = false;
+            }
+        } else if (strcmp(token, "max_evals") == 0) {
+            job->max_evals = atoi(value);
+        } else if (strcmp(token, "starts") == 0) {
+            job->num_starts = atoi(value);
+        } else if (strcmp(token, "strategy") == 0) {
+            if (strcmp(value, "zero") == 0) {
+                job->strategy = STRATEGY_ZERO;
+            } else if (strcmp(value, "interp") == 0) {
+                job->strategy = STRATEGY_INTERP;
+            } else if (strcmp(value, "fourier") == 0) {
+                job->strategy = STRATEGY_FOURIER;
+            } else {
+                valid = false;
+            }
+        } else if (strcmp(token, "sampling") == 0) {
+            job->sampling = atoi(value) != 0;
+        } else if (strcmp(token, "samples") == 0) {
+            job->num_samples = atoi(value);
+        } else if (strcmp(token, "restricted") == 0) {
+            job->restricted = atoi(value) != 0;
+        } else if (strcmp(token, "objective") == 0) {
+            if (strcmp(value, "expectation") == 0) {
+                job->objective = OBJECTIVE_EXPECTATION;
+            } else if (sscanf(value, "cvar:%lf", &job->objective_parameter) == 1) {
+                job->objective = OBJECTIVE_CVAR;
+            } else if (sscanf(value, "gibbs:%lf", &job->objective_parameter) == 1) {
+                job->objective = OBJECTIVE_GIBBS;
+            } else {
+                valid = false;
+            }
+        } else if (strcmp(token, "mixer") == 0) {
+            if (strcmp(value, "chebyshev") == 0) {
+                job->mixer = MIXER_CHEBYSHEV;
+            } else if (strcmp(value, "product") == 0) {
+                job->mixer = MIXER_PRODUCT;
+            } else if (strcmp(value, "grover") == 0) {
+                job->mixer = MIXER_GROVER;
+            } else if (strcmp(value, "xy") == 0) {
+                job->mixer = MIXER_XY;
+            } else {
+                valid = false;
+            }
+        } else if (strcmp(token, "xy") == 0) {
+            if (strcmp(value, "ring") == 0) {
+                job->xy_topology = XY_RING;
+            } else if (strcmp(value, "complete") == 0) {
+                job->xy_topology = XY_COMPLETE;
+            } else {
+                valid = false;
+            }
+        } else if (strcmp(token, "trotter") == 0) {
+            job->xy_steps = atoi(value);
+            valid = job->xy_steps >= 1;
+        } else if (strcmp(token, "weight") == 0) {
+            job->xy_weight = atoi(value);
+            valid = job->xy_weight >= 0;
+        } else if (strcmp(token, "symmetric") == 0) {
+            job->symmetric = atoi(value) != 0;
+        } else if (strcmp(token, "lightcone") == 0) {
+            job->lightcone = atoi(value) != 0;
+        } else if (strcmp(token, "cache") == 0) {
+            job->cache_mb = atoi(value);
+            valid = job->cache_mb >= 0;
+        } else if (strcmp(token, "hamiltonian") == 0) {
+            valid = strcmp(value, "none") == 0 || strcmp(value, "maxcut") == 0 || strncmp(value, "file:", 5) == 0;
+            if (valid) {
+                strcpy(job->hamiltonian, value);
+            }
+        } else if (strcmp(token, "graph") == 0) {
+            valid = strncmp(value, "gnp:", 4) == 0 || strncmp(value, "directed:", 9) == 0 ||
+                    strncmp(value, "regular:", 8) == 0 || strncmp(value, "weighted:", 9) == 0 ||
+                    strncmp(value, "file:", 5) == 0;
+            if (valid) {
+                strcpy(job->graph, value);
+            }
+        } else if (strcmp(token, "seed") == 0) {
+            job->seed = (unsigned) strtoul(value, NULL, 10);
+        } else if (strcmp(token, "instance") == 0) {
+            job->instance = (MKL_INT) strtoll(value, NULL, 10);
+            valid = job->instance >= 0 && job->instance < GRAPH_MAX_INSTANCES;
+        } else if (strcmp(token, "rng") == 0) {
+            job->rng = (unsigned) strtoul(value, NULL, 10);
+        } else if (strcmp(token, "instances") == 0) {
+            job->num_instances = atoi(value);
+            valid = job->num_instances > 0;
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            value[-1] = '=';
+            batch_error(line_number, token);
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Reads the generated family of a job's graph
+ * @param job The job
+ * @param spec The family and parameters to fill
+ * @return False if the graph is read from a file instead
+ */
+bool batch_graph_spec(batch_job_t *job, graph_spec_t *spec) {
+    spec->num_vertices = job->num_qubits;
+    spec->prob = 0.0;
+    spec->degree = 0;
+    spec->max_weight = 1;
+    if (sscanf(job->graph, "gnp:%lf", &spec->prob) == 1) {
+        spec->family = GRAPH_ERDOS_RENYI;
+    } else if (sscanf(job->graph, "directed:%lf", &spec->prob) == 1) {
+        spec->family = GRAPH_DIRECTED;
+    } else if (sscanf(job->graph, "regular:%d", &spec->degree) == 1) {
+        spec->family = GRAPH_REGULAR;
+    } else if (sscanf(job->graph, "weighted:%lf:%d", &spec->prob, &spec->max_weight) == 2) {
+        spec->family = GRAPH_WEIGHTED;
+    } else if (strncmp(job->graph, "file:", 5) == 0) {
+        return false;
+    } else {
+        fprintf(stderr, "Malformed graph '%s'.\n", job->graph);
+        exit(EXIT_FAILURE);
+    }
+    return true;
+}
+
+/**
+ * @brief Fills the adjacency matrix of a job's instance
+ * @details Generated families are drawn with graph_generate() from the job's seed and instance number; file:<path>
+ * reads num_qubits^2 integers (as print_graph() writes them).
+ * @param job The job
+ * @param graph The num_qubits * num_qubits adjacency matrix to fill
+ */
+void batch_graph(batch_job_t *job, MKL_INT *graph) {
+    int n = job->num_qubits * job->num_qubits;
+    graph_spec_t spec;
+    if (batch_graph_spec(job, &spec)) {
+        graph_generate(&spec, job->seed, job->instance, graph);
+        return;
+    }
+    long long entry;
+    FILE *file = fopen(job->graph + 5, "r");
+    if (file == NULL) {
+        perror("Attempting to open graph file");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; ++i) {
+        if (fscanf(file, "%lld", &entry) != 1) {
+            fprintf(stderr, "Graph file %s holds fewer than %d entries.\n", job->graph + 5, n);
+            exit(EXIT_FAILURE);
+        }
+        graph[i] = (MKL_INT) entry;
+    }
+    fclose(file);
+}
+
+/**
+ * @brief Fills the run and optimisation specifications of a job (main.c's defaults for everything not in the job)
+ * @param job The job
+ * @param run_spec The run specification to fill
+ * @param opt_spec The optimisation specification to fill
+ */
+void batch_specs(batch_job_t *job, run_spec_t *run_spec, optimization_spec_t *opt_spec) {
+    run_spec->correct = true;
+    run_spec->report = false;
+    run_spec->timing = true;
+    run_spec->sampling = job->sampling;
+    run_spec->verbose = false;
+    run_spec->restricted = job->restricted;
+    run_spec->restart = true;
+    run_spec->seed = job->rng;
+    run_spec->num_samples = job->num_samples;
+    run_spec->objective = job->objective;
+    run_spec->cvar_alpha = job->objective == OBJECTIVE_CVAR ? job->objective_parameter : 0.1;
+    run_spec->gibbs_eta = job->objective == OBJECTIVE_GIBBS ? job->objective_parameter : 1.0;
+    run_spec->cheby_tolerance = CHEBY_DEFAULT_TOLERANCE;
+    run_spec->spectral_limit = SPECTRAL_LIMIT_DEFAULT;
+    run_spec->mixer = job->mixer;
+    run_spec->xy_topology = job->xy_topology;
+    run_spec->xy_steps = job->xy_steps;
+    run_spec->xy_weight = job->xy_weight < 0 ? job->num_qubits / 2 : job->xy_weight;
+    run_spec->symmetric = job->symmetric;
+    run_spec->lightcone = job->lightcone;
+    run_spec->block_length = BLOCK_LENGTH_DEFAULT;
+    run_spec->ooc_directory = NULL;
+    run_spec->state_cache_bytes = (size_t) job->cache_mb << 20;
+    run_spec->binding = BINDING_NONE;
+    run_spec->trace_path = NULL;
+    run_spec->trace_format = TRACE_BINARY;
+    run_spec->profile_path = NULL;
+    run_spec->outfile = stdout;
+
+    opt_spec->ftol = 1e-16;
+    opt_spec->xtol = 1e-16;
+    opt_spec->max_evals = job->max_evals;
+    opt_spec->num_starts = job->num_starts;
+    opt_spec->optimiser_type = job->optimiser;
+    opt_spec->nlopt_method = job->nlopt_method;
+    opt_spec->step_size = 0.0;
+    opt_spec->perturbation = 0.0;
+    opt_spec->population = 0;
+    opt_spec->strategy = job->strategy;
+    opt_spec->fourier_q = 0;
+    opt_spec->store_path = NULL;
+    opt_spec->problem_class = NULL;
+    opt_spec->store_seeds = 1;
+    opt_spec->parameters = NULL;
+}
+
+/**
+ * @brief Determines whether two jobs share their instance and mixer, and with them UC and UB
+ * @param a A job
+ * @param b Another job
+ * @return True if the operators prepared for one serve the other
+ */
+bool batch_same_problem(const batch_job_t *a, const batch_job_t *b) {
+    return a->num_qubits == b->num_qubits && a->mixer == b->mixer && a->symmetric == b->symmetric &&
+           (a->mixer != MIXER_XY || a->xy_topology == b->xy_topology) && a->lightcone == b->lightcone &&
+           strcmp(a->hamiltonian, b->hamiltonian) == 0 && strcmp(a->graph, b->graph) == 0 &&
+           ((a->seed == b->seed && a->instance == b->instance) || strncmp(a->graph, "file:", 5) == 0);
+}
+
+/**
+ * @brief Writes a string as a JSON string literal
+ * @param string The string
+ * @param results The output stream
+ */
+void batch_json_string(const char *string, FILE *results) {
+    fputc('"', results);
+    for (; *string != '\0'; ++string) {
+        if (*string == '"' || *string == '\\') {
+            fputc('\\', results);
+        }
+        fputc(*string, results);
+    }
+    fputc('"', results);
+}
+
+/**
+ * @brief Runs a job over several generated instances with the instance-batched engine and records its result
+ * @param job The job, with a single P and a generated graph family
+ * @param report The stream of the text report
+ * @param results The results stream
+ */
+void batch_instances(batch_job_t *job, FILE *report, FILE *results) {
+    machine_spec_t mach_spec;
+    run_spec_t run_spec;
+    optimization_spec_t opt_spec;
+    graph_spec_t spec;
+    instance_batch_t batch;
+    int count = job->num_instances;
+    MKL_INT size = (MKL_INT) job->num_qubits * job->num_qubits;
+
+    if (job->ladder_length != 1 || !batch_graph_spec(job, &spec)) {
+        fprintf(stderr, "Job %s: several instances need a single P and a generated graph.\n", job->name);
+        exit(EXIT_FAILURE);
+    }
+    //Checked before the state-space is sized, light-cone graphs may have more vertices than a state has bits
+    if (job->lightcone) {
+        fprintf(stderr, "Job %s: several instances cannot be evaluated over light cones.\n", job->name);
+        exit(EXIT_FAILURE);
+    }
+    mach_spec.num_qubits = job->num_qubits;
+    mach_spec.P = job->ladder[0];
+    mach_spec.space_dimension = (MKL_INT) 1 << job->num_qubits;
+    batch_specs(job, &run_spec, &opt_spec);
+    run_spec.restart = false;
+
+    MKL_INT *graphs = mkl_malloc(count * size * sizeof(MKL_INT), DEF_ALIGNMENT);
+    cost_data_t *instances = mkl_malloc(count * sizeof(cost_data_t), DEF_ALIGNMENT);
+    check_alloc(graphs);
+    check_alloc(instances);
+    graph_generate_batch(&spec, job->seed, job->instance, count, graphs);
+    for (int k = 0; k < count; ++k) {
+        instances[k].x_range = mach_spec.space_dimension;
+        instances[k].cx_range = mach_spec.space_dimension;
+        instances[k].num_vertices = job->num_qubits;
+        instances[k].hamiltonian = NULL;
+        instances[k].graph = graphs + k * size;
+    }
+
+    instance_batch_create(&batch, &mach_spec, instances, count, &opt_spec, &run_spec, false);
+    instance_batch_optimise(&batch);
+    instance_batch_report(&batch, report);
+
+    fprintf(results, "{\"job\":");
+    batch_json_string(job->name, results);
+    fprintf(results, ",\"qubits\":%d,\"graph\":", job->num_qubits);
+    batch_json_string(job->graph, results);
+    fprintf(results, ",\"seed\":%u,\"instance\":%lld,\"instances\":%d,\"P\":%d,\"seconds\":%.6f,"
+                     "\"instances_per_second\":%.3f,\"results\":[", job->seed, (long long) job->instance, count,
+            mach_spec.P, batch.seconds, count / batch.seconds);
+    for (int k = 0; k < count; ++k) {
+        fprintf(results, "%s{\"value\":%.17g,\"max_value\":%d,\"evals\":%d,\"status\":%d}", k > 0 ? "," : "",
+                batch.value[k], batch.max_value[k], batch.num_evals[k], (int) batch.status[k]);
+    }
+    fprintf(results, "]}\n");
+    fflush(results);
+
+    instance_batch_destroy(&batch);
+    mkl_free(instances);
+    mkl_free(graphs);
+}
+
+/**
+ * @brief Builds the machine and instance of a job
+ * @param job The job
+ * @param mach_spec The machine specification to fill, at the first P of the ladder
+ * @param cost_data The instance to fill, released with batch_release()
+ */
+void batch_setup(batch_job_t *job, machine_spec_t *mach_spec, cost_data_t *cost_data) {
+    mach_spec->num_qubits = job->num_qubits;
+    mach_spec->P = job->ladder[0];
+    //Light-cone jobs never hold the state-space, which may be far beyond 64-bit indices
+    mach_spec->space_dimension = job->lightcone ? 0 : (MKL_INT) 1 << job->num_qubits;
+    cost_data->x_range = mach_spec->space_dimension;
+    cost_data->cx_range = mach_spec->space_dimension;
+    cost_data->num_vertices = job->num_qubits;
+    cost_data->graph = mkl_calloc((size_t) job->num_qubits * job->num_qubits, sizeof(MKL_INT), DEF_ALIGNMENT);
+    check_alloc(cost_data->graph);
+    batch_graph(job, cost_data->graph);
+    if (strcmp(job->hamiltonian, "maxcut") == 0) {
+        cost_data->hamiltonian = ising_maxcut(cost_data->graph, job->num_qubits);
+    } else if (strncmp(job->hamiltonian, "file:", 5) == 0) {
+        cost_data->hamiltonian = ising_read(job->hamiltonian + 5);
+    } else {
+        cost_data->hamiltonian = NULL;
+    }
+}
+
+/**
+ * @brief Releases the operators and instance of a job
+ * @param problem The operators
+ * @param cost_data The instance from batch_setup()
+ */
+void batch_release(qaoa_problem_t *problem, cost_data_t *cost_data) {
+    qaoa_release(problem);
+    mkl_free(cost_data->graph);
+    ising_destroy(cost_data->hamiltonian);
+}
+
+/**
+ * @brief Solves every P of a job's ladder on prepared operators and records its result
+ * @param job The job
+ * @param problem The operators prepared for the job's instance
+ * @param mach_spec The machine specification, at the first P of the ladder (and again on return)
+ * @param cost_data The instance
+ * @param run_spec The run specification of the job
+ * @param opt_spec The optimisation specification of the job, whose parameters are released on return
+ * @param reused Whether the operators were prepared for an earlier job
+ * @param setup_seconds The time taken to prepare the operators for this job
+ * @param results The results stream
+ */
+void batch_solve(batch_job_t *job, qaoa_problem_t *problem, machine_spec_t *mach_spec, cost_data_t *cost_data,
+                 run_spec_t *run_spec, optimization_spec_t *opt_spec, bool reused, double setup_seconds,
+                 FILE *results) {
+    fprintf(results, "{\"job\":");
+    batch_json_string(job->name, results);
+    fprintf(results, ",\"qubits\":%d,\"graph\":", job->num_qubits);
+    batch_json_string(job->graph, results);
+    fprintf(results, ",\"seed\":%u,\"instance\":%lld,\"restricted\":%s,\"sampling\":%s,\"setup_reused\":%s,"
+                     "\"setup_seconds\":%.6f,\"max_value\":%d,\"runs\":[", job->seed, (long long) job->instance,
+            job->restricted ? "true" : "false", job->sampling ? "true" : "false", reused ? "true" : "false",
+            setup_seconds, problem->max_value);
+    for (int k = 0; k < job->ladder_length; ++k) {
+        qaoa_statistics_t statistics;
+        qaoa_data_t meta_spec;
+        for (int P = mach_spec->P + 1; k > 0 && P <= job->ladder[k]; ++P) {
+            grow_params(P, job->restricted, opt_spec);
+        }
+        mach_spec->P = job->ladder[k];
+        qaoa_solve(problem, mach_spec, cost_data, opt_spec, run_spec, k > 0, &statistics);
+        meta_spec.machine_spec = mach_spec;
+        meta_spec.opt_spec = opt_spec;
+        meta_spec.run_spec = run_spec;
+        fprintf(results, "%s{\"P\":%d,\"value\":%.17g,\"best_sample\":", k > 0 ? "," : "", mach_spec->P,
+                statistics.result);
+        if (isfinite(statistics.best_sample)) {
+            fprintf(results, "%.17g", statistics.best_sample);
+        } else {
+            fprintf(results, "null");
+        }
+        fprintf(results, ",\"evals\":%d,\"status\":%d,\"seconds\":%.6f,\"parameters\":[", statistics.num_evals,
+                (int) statistics.term_status, statistics.endTimes[3] - statistics.startTimes[3]);
+        for (int j = 0; j < parameter_count(&meta_spec); ++j) {
+            fprintf(results, "%s%.17g", j > 0 ? "," : "", opt_spec->parameters[j]);
+        }
+        fprintf(results, "]}");
+    }
+    fprintf(results, "]}\n");
+    fflush(results);
+    mkl_free(opt_spec->parameters);
+    mach_spec->P = job->ladder[0];
+}
+
+/**
+ * @brief Runs one job of a concurrent batch from start to finish into its own streams (a job_function_t)
+ * @param task The batch_task_t
+ */
+void batch_task(void *task) {
+    batch_task_t *current = task;
+    machine_spec_t mach_spec;
+    run_spec_t run_spec;
+    optimization_spec_t opt_spec;
+    cost_data_t cost_data;
+    qaoa_problem_t problem;
+    if (current->job.num_instances > 1) {
+        batch_instances(&current->job, current->report, current->result);
+        return;
+    }
+    batch_setup(&current->job, &mach_spec, &cost_data);
+    batch_specs(&current->job, &run_spec, &opt_spec);
+    run_spec.outfile = current->report;
+    qaoa_prepare(&problem, &mach_spec, &cost_data, &run_spec);
+    batch_solve(&current->job, &problem, &mach_spec, &cost_data, &run_spec, &opt_spec, false,
+                problem.uc_seconds + problem.ub_seconds, current->result);
+    batch_release(&problem, &cost_data);
+}
+
+/**
+ * @brief Appends the whole of a temporary stream to another and closes it
+ * @param from The temporary stream
+ * @param to The stream appended to
+ */
+void batch_append(FILE *from, FILE *to) {
+    char buffer[BATCH_LINE_LENGTH];
+    size_t count;
+    rewind(from);
+    while ((count = fread(buffer, 1, sizeof(buffer), from)) > 0) {
+        fwrite(buffer, 1, count, to);
+    }
+    fclose(from);
+    fflush(to);
+}
+
+/**
+ * @brief Runs every job of a job file concurrently on groups of cores
+ * @param jobs The job file
+ * @param results The results stream
+ * @param num_groups The number of groups the cores are divided into
+ */
+void batch_concurrent(FILE *jobs, FILE *results, int num_groups) {
+    char line[BATCH_LINE_LENGTH];
+    int line_number = 0;
+    int num_tasks = 0;
+    int capacity = 16;
+    batch_task_t *tasks = mkl_malloc(capacity * sizeof(batch_task_t), DEF_ALIGNMENT);
+    check_alloc(tasks);
+    while (fgets(line, sizeof(line), jobs) != NULL) {
+        line_number++;
+        if (num_tasks == capacity) {
+            capacity *= 2;
+            tasks = mkl_realloc(tasks, capacity * sizeof(batch_task_t));
+            check_alloc(tasks);
+        }
+        if (!batch_parse(line, line_number, &tasks[num_tasks].job)) {
+            continue;
+        }
+        tasks[num_tasks].report = tmpfile();
+        tasks[num_tasks].result = tmpfile();
+        if (tasks[num_tasks].report == NULL || tasks[num_tasks].result == NULL) {
+            perror("Attempting to open a temporary file");
+            exit(EXIT_FAILURE);
+        }
+        num_tasks++;
+    }
+
+    run_jobs(tasks, num_tasks, sizeof(batch_task_t), num_groups, BINDING_NONE, batch_task);
+    for (int t = 0; t < num_tasks; ++t) {
+        batch_append(tasks[t].report, stdout);
+        batch_append(tasks[t].result, results);
+    }
+    mkl_free(tasks);
+}
+
+int main(int argc, char *argv[]) {
+    char line[BATCH_LINE_LENGTH];
+    int line_number = 0;
+    int num_groups = 1;
+    bool prepared = false;
+    batch_job_t job, previous;
+    qaoa_problem_t problem;
+    machine_spec_t mach_spec;
+    run_spec_t run_spec;
+    cost_data_t cost_data;
+
+    if (argc > 3) {
+        num_groups = atoi(argv[3]);
+    }
+    if (argc < 2 || num_groups < 1) {
+        fprintf(stderr, "Usage: %s job_file [results_file [groups]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    FILE *jobs = fopen(argv[1], "r");
+    if (jobs == NULL) {
+        perror("Attempting to open job file");
+        return EXIT_FAILURE;
+    }
+    FILE *results = fopen(argc > 2 ? argv[2] : "batch_results.jsonl", "a");
+    if (results == NULL) {
+        perror("Attempting to open results file");
+        return EXIT_FAILURE;
+    }
+    if (num_groups > 1) {
+        batch_concurrent(jobs, results, num_groups);
+        fclose(jobs);
+        fclose(results);
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), jobs) != NULL) {
+        line_number++;
+        if (!batch_parse(line, line_number, &job)) {
+            continue;
+        }
+        if (job.num_instances > 1) {
+            batch_instances(&job, stdout, results);
+            continue;
+        }
+        bool reused = prepared && batch_same_problem(&job, &previous);
+
+        if (!reused) {
+            if (prepared) {
+                batch_release(&problem, &cost_data);
+            }
+            batch_setup(&job, &mach_spec, &cost_data);
+        }
+
+        optimization_spec_t opt_spec;
+        batch_specs(&job, &run_spec, &opt_spec);
+
+        double setup_seconds = 0.0;
+        if (!reused) {
+            qaoa_prepare(&problem, &mach_spec, &cost_data, &run_spec);
+            setup_seconds = problem.uc_seconds + problem.ub_seconds;
+            prepared = true;
+        }
+        previous = job;
+        batch_solve(&job, &problem, &mach_spec, &cost_data, &run_spec, &opt_spec, reused, setup_seconds, results);
+    }
+
+    if (prepared) {
+        batch_release(&problem, &cost_data);
+    }
+    fclose(jobs);
+    fclose(results);
+    return 0;
+}
@@ -0,0 +1,371 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief A microbenchmark of the simulation kernels, built as benchmark.exe
+ * @details Times generate_uc(), generate_ub(), spmatrix_expm_z_diag(), spmatrix_expm_cheby(), spmatrix_expm_product_x(),
+ * xy_mixer_expm() (on a ring, one Trotter step),
+ * measure() and sample() in isolation for every qubit count in a range and every power-of-two thread count up to the MKL maximum. Each
+ * kernel reports the mean, standard deviation and minimum time per call over the repeats (after one warm-up call),
+ * its algorithmic bandwidth and that bandwidth as a fraction of a STREAM triad over vectors of the state size.
+ * Results are appended as CSV for regression tracking.
+ *
+ * Usage: benchmark.exe [min_qubits] [max_qubits] [repeats] [csv_file]   (defaults 10 28 5 benchmark.csv)
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <omp.h>
+#include <mathimf.h>
+#include "qaoa.h"
+#include "graph_utils.h"
+#include "ub.h"
+#include "uc.h"
+#include "cost_vector.h"
+#include "state_evolve.h"
+#include "matrix_expm.h"
+#include "measurement.h"
+#include "eigen_solve.h"
+#include "placement.h"
+#include "xy_mixer.h"
+
+#define BENCHMARK_BETA 0.5
+#define BENCHMARK_GAMMA 0.5
+
+/*! The timings of one kernel at one size and thread count */
+typedef struct {
+    double mean;    /**< Mean time per call */
+    double stddev;  /**< Sample standard deviation of the time per call */
+    double min;     /**< Fastest call */
+} bench_timing_t;
+
+/**
+ * @brief Reduces a set of per-call times to their mean, standard deviation and minimum
+ * @param times The time of each call
+ * @param repeats The number of calls
+ * @return The summary statistics
+ */
+bench_timing_t bench_summarise(const double *times, int repeats) {
+    bench_timing_t timing = {0.0, 0.0, times[0]};
+    for (int r = 0; r < repeats; ++r) {
+        timing.mean += times[r] / repeats;
+        timing.min = fmin(timing.min, times[r]);
+    }
+    for (int r = 0; r < repeats && repeats > 1; ++r) {
+        timing.stddev += (times[r] - timing.mean) * (times[r] - timing.mean) / (repeats - 1);
+    }
+    timing.stddev = sqrt(timing.stddev);
+    return timing;
+}
+
+/**
+ * @brief Measures the bandwidth of a STREAM triad (a = b + s*c) over three vectors of the given length
+ * @param length The number of doubles in each vector
+ * @param repeats The number of timed repetitions (the best is used, as in STREAM)
+ * @return The achieved bandwidth in GB/s, counting 24 bytes per element
+ */
+double stream_triad(MKL_INT length, int repeats) {
+    double best = INFINITY;
+    double *a = mkl_malloc(length * sizeof(double), DEF_ALIGNMENT);
+    double *b = mkl_malloc(length * sizeof(double), DEF_ALIGNMENT);
+    double *c = mkl_malloc(length * sizeof(double), DEF_ALIGNMENT);
+    check_alloc(a);
+    check_alloc(b);
+    check_alloc(c);
+#pragma omp parallel for schedule(static)
+    for (MKL_INT j = 0; j < length; ++j) {
+        a[j] = 0.0;
+        b[j] = 1.0;
+        c[j] = 2.0;
+    }
+    for (int r = 0; r <= repeats; ++r) {
+        double start = dsecnd();
+#pragma omp parallel for schedule(static)
+        for (MKL_INT j = 0; j < length; ++j) {
+            a[j] = b[j] + 3.0 * c[j];
+        }
+        if (r > 0) {
+            best = fmin(best, dsecnd() - start);
+        }
+    }
+    mkl_free(a);
+    mkl_free(b);
+    mkl_free(c);
+    return 24.0 * length / best * 1e-9;
+}
+
+/**
+ * @brief Estimates the peak memory used to benchmark a given qubit count
+ * @param num_qubits The number of qubits
+ * @return The bytes held at once by UC, both forms of UB, the state, the Chebyshev work vectors and probabilities
+ */
+double bench_footprint(int num_qubits) {
+    double dimension = pow(2, num_qubits);
+    return dimension * (sizeof(MKL_Complex16) * (7.0 + num_qubits) + sizeof(double) * (num_qubits + 4.0) +
+                        sizeof(MKL_INT) * (num_qubits + 2.0));
+}
+
+/**
+ * @brief Destroys a UB matrix along with the CSR arrays it was created from (which MKL does not own)
+ * @param ub The UB matrix
+ * @param is_complex Whether the matrix has been converted to complex values (convert_ub())
+ */
+void bench_ub_destroy(sparse_matrix_t ub, bool is_complex) {
+    MKL_INT *rows_start, *rows_end, *col_indx, rows, cols;
+    sparse_index_base_t indexing;
+    double *real_values = NULL;
+    MKL_Complex16 *complex_values = NULL;
+    if (is_complex) {
+        mkl_sparse_z_export_csr(ub, &indexing, &rows, &cols, &rows_start, &rows_end, &col_indx, &complex_values);
+    } else {
+        mkl_sparse_d_export_csr(ub, &indexing, &rows, &cols, &rows_start, &rows_end, &col_indx, &real_values);
+    }
+    mkl_sparse_destroy(ub);
+    numa_free(rows_start);
+    numa_free(rows_end);
+    numa_free(col_indx);
+    numa_free(is_complex ? (void *) complex_values : (void *) real_values);
+}
+
+/**
+ * @brief Writes one CSV row
+ * @param csv The output stream
+ * @param kernel The name of the kernel
+ * @param num_qubits The number of qubits
+ * @param threads The number of threads
+ * @param repeats The number of timed calls
+ * @param timing The summary of the timed calls
+ * @param bytes The algorithmic bytes moved per call
+ * @param stream The STREAM triad bandwidth at this size and thread count (GB/s)
+ */
+void bench_row(FILE *csv, const char *kernel, int num_qubits, int threads, int repeats, bench_timing_t timing,
+               long long bytes, double stream) {
+    double bandwidth = bytes / timing.mean * 1e-9;
+    fprintf(csv, "%s,%d,%d,%d,%.9e,%.9e,%.9e,%lld,%.6f,%.6f,%.6f\n", kernel, num_qubits, threads, repeats,
+            timing.mean, timing.stddev, timing.min, bytes, bandwidth, stream, bandwidth / stream);
+    printf("%-10s Q=%2d T=%3d %12.6e s/call (+- %.2e) %8.3f GB/s %6.1f%% of STREAM\n", kernel, num_qubits, threads,
+           timing.mean, timing.stddev, bandwidth, 100.0 * bandwidth / stream);
+}
+
+/**
+ * @brief Benchmarks every kernel at one qubit count and thread count
+ * @param meta_spec A data-structure with the machine, run, cost and statistics specifications set
+ * @param repeats The number of timed calls of each kernel
+ * @param csv The output stream
+ */
+void bench_kernels(qaoa_data_t *meta_spec, int repeats, FILE *csv) {
+    int num_qubits = meta_spec->machine_spec->num_qubits;
+    int threads = mkl_get_max_threads();
+    MKL_INT dimension = meta_spec->machine_spec->space_dimension;
+    MKL_INT ub_nnz = 0;
+    double *times = mkl_malloc((repeats + 1) * sizeof(double), DEF_ALIGNMENT);
+    double *probabilities = numa_allocate((size_t) dimension, sizeof(double));
+    MKL_Complex16 *state = numa_allocate((size_t) dimension, sizeof(MKL_Complex16));
+    check_alloc(times);
+    double stream = stream_triad(2 * dimension, repeats);
+
+    for (int r = 0; r <= repeats; ++r) {
+        double start = dsecnd();
+        generate_uc(meta_spec, Cx, mask);
+        times[r] = dsecnd() - start;
+        if (r < repeats) {
+            cost_vector_free(meta_spec->uc);
+        }
+    }
+    //Written as 32-bit integers, then narrowed
+    size_t cost_size = cost_type_size(meta_spec->uc->type);
+    bench_row(csv, "uc", num_qubits, threads, repeats, bench_summarise(times + 1, repeats),
+              dimension * (long long) (sizeof(int) + (cost_size < sizeof(int) ? sizeof(int) + cost_size : 0)), stream);
+
+    for (int r = 0; r <= repeats; ++r) {
+        double start = dsecnd();
+        ub_nnz = generate_ub(meta_spec, mask);
+        times[r] = dsecnd() - start;
+        if (r < repeats) {
+            bench_ub_destroy(meta_spec->ub, false);
+        }
+    }
+    bench_row(csv, "ub", num_qubits, threads, repeats, bench_summarise(times + 1, repeats),
+              ub_nnz * (long long) (sizeof(double) + sizeof(MKL_INT)) + 2 * (dimension + 1LL) * sizeof(MKL_INT),
+              stream);
+    meta_spec->ub_eigenvalue = max_eigen_find(meta_spec->ub);
+    convert_ub(meta_spec, ub_nnz);
+
+    initialise_state(state, meta_spec->machine_spec);
+    for (int r = 0; r <= repeats; ++r) {
+        double start = dsecnd();
+        spmatrix_expm_z_diag(meta_spec->uc, BENCHMARK_GAMMA, state);
+        times[r] = dsecnd() - start;
+    }
+    bench_row(csv, "phase", num_qubits, threads, repeats, bench_summarise(times + 1, repeats),
+              dimension * (long long) (2 * sizeof(MKL_Complex16) + cost_size), stream);
+
+    for (int r = 0; r <= repeats; ++r) {
+        double start = dsecnd();
+        spmatrix_expm_cheby(&meta_spec->ub, state, (MKL_Complex16) {BENCHMARK_BETA, 0.0},
+                            (MKL_Complex16) {0.0, -meta_spec->ub_eigenvalue},
+                            (MKL_Complex16) {0.0, meta_spec->ub_eigenvalue}, dimension,
+                            meta_spec->run_spec->cheby_tolerance, meta_spec->workspace);
+        times[r] = dsecnd() - start;
+    }
+    bench_row(csv, "mixer", num_qubits, threads, repeats, bench_summarise(times + 1, repeats),
+              cheby_bytes(meta_spec->ub, dimension, cheby_terms(-meta_spec->ub_eigenvalue * BENCHMARK_BETA,
+                                                                meta_spec->run_spec->cheby_tolerance)), stream);
+
+    for (int r = 0; r <= repeats; ++r) {
+        double start = dsecnd();
+        spmatrix_expm_product_x(state, BENCHMARK_BETA, num_qubits, meta_spec->run_spec->block_length, false);
+        times[r] = dsecnd() - start;
+    }
+    bench_row(csv, "mixer_product", num_qubits, threads, repeats, bench_summarise(times + 1, repeats),
+              product_bytes(num_qubits, meta_spec->run_spec->block_length), stream);
+
+    if (num_qubits >= 2) {
+        for (int r = 0; r <= repeats; ++r) {
+            double start = dsecnd();
+            xy_mixer_expm(state, BENCHMARK_BETA, num_qubits, XY_RING, 1, meta_spec->run_spec->block_length);
+            times[r] = dsecnd() - start;
+        }
+        bench_row(csv, "mixer_xy", num_qubits, threads, repeats, bench_summarise(times + 1, repeats),
+                  xy_mixer_bytes(num_qubits, XY_RING, 1, meta_spec->run_spec->block_length), stream);
+    }
+
+    for (int r = 0; r <= repeats; ++r) {
+        double start = dsecnd();
+        measure(state, meta_spec);
+        times[r] = dsecnd() - start;
+    }
+    bench_row(csv, "measure", num_qubits, threads, repeats, bench_summarise(times + 1, repeats),
+              dimension * (long long) (sizeof(MKL_Complex16) + cost_size), stream);
+
+    compute_probabilities(state, probabilities, meta_spec);
+    for (int r = 0; r <= repeats; ++r) {
+        double start = dsecnd();
+        sample(probabilities, meta_spec);
+        times[r] = dsecnd() - start;
+    }
+    bench_row(csv, "sample", num_qubits, threads, repeats, bench_summarise(times + 1, repeats),
+              dimension * (long long) (cost_size + 2 * sizeof(double)), stream);
+
+    bench_ub_destroy(meta_spec->ub, true);
+    cost_vector_free(meta_spec->uc);
+    numa_free(state);
+    numa_free(probabilities);
+    mkl_free(times);
+}
+
+int main(int argc, char *argv[]) {
+    int min_qubits = argc > 1 ? atoi(argv[1]) : 10;
+    int max_qubits = argc > 2 ? atoi(argv[2]) : 28;
+    int repeats = argc > 3 ? atoi(argv[3]) : 5;
+    const char *csv_path = argc > 4 ? argv[4] : "benchmark.csv";
+    int max_threads = mkl_get_max_threads();
+    double memory = (double) sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGE_SIZE);
+
+    if (min_qubits < 1 || max_qubits < min_qubits || repeats < 1) {
+        fprintf(stderr, "Usage: %s [min_qubits] [max_qubits] [repeats] [csv_file]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    FILE *csv = fopen(csv_path, "a");
+    if (csv == NULL) {
+        perror("Attempting to open benchmark file");
+        exit(EXIT_FAILURE);
+    }
+    if (ftell(csv) == 0) {
+        fprintf(csv, "kernel,qubits,threads,repeats,mean_s,stddev_s,min_s,bytes,gbs,stream_gbs,stream_fraction\n");
+    }
+
+    run_spec_t run_spec;
+    run_spec.correct = false;
+    run_spec.report = false;
+    run_spec.timing = false;
+    run_spec.sampling = false;
+    run_spec.verbose = false;
+    run_spec.restricted = false;
+    run_spec.restart = false;
+    run_spec.seed = 1;
+    run_spec.num_samples = 100;
+    run_spec.objective = OBJECTIVE_EXPECTATION;
+    run_spec.cvar_alpha = 0.1;
+    run_spec.gibbs_eta = 1.0;
+    run_spec.cheby_tolerance = CHEBY_DEFAULT_TOLERANCE;
+    run_spec.spectral_limit = SPECTRAL_LIMIT_DEFAULT;
+    run_spec.mixer = MIXER_CHEBYSHEV;
+    run_spec.xy_topology = XY_RING;
+    run_spec.xy_steps = 1;
+    run_spec.xy_weight = 2;
+    run_spec.symmetric = false;
+    run_spec.lightcone = false;
+    run_spec.block_length = BLOCK_LENGTH_DEFAULT;
+    run_spec.ooc_directory = NULL;
+    run_spec.state_cache_bytes = 0;
+    run_spec.binding = BINDING_NONE;
+    run_spec.trace_path = NULL;
+    run_spec.trace_format = TRACE_BINARY;
+    run_spec.profile_path = NULL;
+    run_spec.outfile = stdout;
+
+    mkl_set_dynamic(0);
+    for (int num_qubits = min_qubits; num_qubits <= max_qubits; ++num_qubits) {
+        if (bench_footprint(num_qubits) > 0.8 * memory) {
+            printf("Skipping %d qubits: needs %.1f GB of %.1f GB\n", num_qubits, bench_footprint(num_qubits) * 1e-9,
+                   memory * 1e-9);
+            continue;
+        }
+        machine_spec_t mach_spec;
+        mach_spec.num_qubits = num_qubits;
+        mach_spec.P = 1;
+        mach_spec.space_dimension = (MKL_INT) pow(2, num_qubits);
+
+        cost_data_t cost_data;
+        cost_data.x_range = mach_spec.space_dimension;
+        cost_data.cx_range = mach_spec.space_dimension;
+        cost_data.num_vertices = num_qubits;
+        cost_data.hamiltonian = NULL;
+        cost_data.graph = mkl_malloc(sizeof(MKL_INT) * num_qubits * num_qubits, DEF_ALIGNMENT);
+        check_alloc(cost_data.graph);
+
+        qaoa_statistics_t statistics;
+        statistics.best_sample = -INFINITY;
+        statistics.best_expectation = -INFINITY;
+        statistics.num_evals = 0;
+        statistics.trace = NULL;
+        statistics.trace_length = 0;
+        statistics.start = 0;
+
+        qaoa_data_t meta_spec;
+        meta_spec.machine_spec = &mach_spec;
+        meta_spec.run_spec = &run_spec;
+        meta_spec.cost_data = &cost_data;
+        meta_spec.qaoa_statistics = &statistics;
+        meta_spec.start_statistics = NULL;
+        meta_spec.trace = NULL;
+        meta_spec.lightcone = NULL;
+        meta_spec.grover = NULL;
+        meta_spec.spectral = NULL;
+        meta_spec.state_cache = NULL;
+        check_stream(vslNewStream(&meta_spec.stream, VSL_BRNG_PHILOX4X32X10, run_spec.seed));
+        generate_graph(cost_data.graph, num_qubits, 0.5, meta_spec.stream);
+        meta_spec.profile = NULL;
+        meta_spec.workspace = numa_pool_create((size_t) mach_spec.space_dimension, sizeof(MKL_Complex16));
+        meta_spec.batch_lock = NULL;
+        meta_spec.opt_spec = NULL;
+
+        for (int threads = 1;; threads *= 2) {
+            threads = threads < max_threads ? threads : max_threads;
+            mkl_set_num_threads(threads);
+            omp_set_num_threads(threads);
+            bench_kernels(&meta_spec, repeats, csv);
+            fflush(csv);
+            if (threads == max_threads) {
+                break;
+            }
+        }
+        vslDeleteStream(&meta_spec.stream);
+        numa_pool_destroy(meta_spec.workspace);
+        mkl_free(cost_data.graph);
+    }
+    mkl_set_num_threads(max_threads);
+    omp_set_num_threads(max_threads);
+    fclose(csv);
+    return 0;
+}
@@ -0,0 +1,240 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Allocation, narrowing and the generic kernels of cost vectors
+ * @details Every kernel splits the vector into blocks of COST_BLOCK values shared statically between the threads, so
+ * each thread reads the share of the vector it first touched, and widens the block into a buffer on its stack.
+ */
+
+#include <stdint.h>
+#include "cost_vector.h"
+#include "out_of_core.h"
+#include "placement.h"
+
+/**
+ * @brief Chooses the narrowest storage type holding a range of costs
+ * @param minimum The smallest cost
+ * @param maximum The largest cost
+ * @return The storage type
+ */
+cost_type_t cost_vector_type(long long minimum, long long maximum) {
+    if (minimum >= INT8_MIN && maximum <= INT8_MAX) {
+        return COST_INT8;
+    }
+    if (minimum >= INT16_MIN && maximum <= INT16_MAX) {
+        return COST_INT16;
+    }
+    return COST_INT32;
+}
+
+/**
+ * @brief The size of one value of a storage type
+ * @param type The storage type
+ * @return The size in bytes
+ */
+size_t cost_type_size(cost_type_t type) {
+    switch (type) {
+        case COST_INT8:
+            return sizeof(int8_t);
+        case COST_INT16:
+            return sizeof(int16_t);
+        default:
+            return sizeof(int32_t);
+    }
+}
+
+/**
+ * @brief Allocates a zeroed cost vector, memory-mapped when running out-of-core and otherwise first touched with the
+ * kernels' static partition
+ * @param length The number of values
+ * @param type The storage type
+ * @param directory The out-of-core directory (NULL to hold the vector in memory)
+ * @return The vector, to be released with cost_vector_free()
+ */
+cost_vector_t *cost_vector_allocate(MKL_INT length, cost_type_t type, const char *directory) {
+    cost_vector_t *cost = mkl_malloc(sizeof(cost_vector_t), DEF_ALIGNMENT);
+    check_alloc(cost);
+    cost->type = type;
+    cost->length = length;
+    cost->mapped = directory != NULL;
+    if (cost->mapped) {
+        cost->values = ooc_allocate((size_t) length * cost_type_size(type), directory);
+    } else {
+        cost->values = numa_allocate((size_t) length, cost_type_size(type));
+    }
+    return cost;
+}
+
+/**
+ * @brief Moves a COST_INT32 vector into the narrowest type holding its range
+ * @param cost The vector, released if a narrower copy is made
+ * @param minimum The smallest value present
+ * @param maximum The largest value present
+ * @param directory The out-of-core directory the vector was allocated in (NULL if in memory)
+ * @return The narrowed vector (cost itself if no narrower type holds the range)
+ */
+cost_vector_t *cost_vector_narrow(cost_vector_t *cost, int minimum, int maximum, const char *directory) {
+    cost_type_t type = cost_vector_type(minimum, maximum);
+    const int32_t *source = cost->values;
+    if (type == cost->type) {
+        return cost;
+    }
+    cost_vector_t *narrow = cost_vector_allocate(cost->length, type, directory);
+    if (type == COST_INT8) {
+        int8_t *target = narrow->values;
+#pragma omp parallel for schedule(static)
+        for (MKL_INT i = 0; i < cost->length; ++i) {
+            target[i] = (int8_t) source[i];
+        }
+    } else {
+        int16_t *target = narrow->values;
+#pragma omp parallel for schedule(static)
+        for (MKL_INT i = 0; i < cost->length; ++i) {
+            target[i] = (int16_t) source[i];
+        }
+    }
+    cost_vector_free(cost);
+    return narrow;
+}
+
+/**
+ * @brief The address of a value, for prefetching and placement queries
+ * @param cost The vector
+ * @param index The state
+ * @return The address of its cost
+ */
+const void *cost_vector_address(const cost_vector_t *cost, MKL_INT index) {
+    return (const char *) cost->values + (size_t) index * cost_type_size(cost->type);
+}
+
+/**
+ * @brief Reads a single cost, for code outside the hot loops
+ * @param cost The vector
+ * @param index The state
+ * @return C(index)
+ */
+double cost_vector_get(const cost_vector_t *cost, MKL_INT index) {
+    switch (cost->type) {
+        case COST_INT8:
+            return ((const int8_t *) cost->values)[index];
+        case COST_INT16:
+            return ((const int16_t *) cost->values)[index];
+        default:
+            return ((const int32_t *) cost->values)[index];
+    }
+}
+
+/**
+ * @brief Writes a single cost, which must lie in the range of the vector's type
+ * @param cost The vector
+ * @param index The state
+ * @param value C(index)
+ */
+void cost_vector_set(cost_vector_t *cost, MKL_INT index, int value) {
+    switch (cost->type) {
+        case COST_INT8:
+            ((int8_t *) cost->values)[index] = (int8_t) value;
+            break;
+        case COST_INT16:
+            ((int16_t *) cost->values)[index] = (int16_t) value;
+            break;
+        default:
+            ((int32_t *) cost->values)[index] = value;
+    }
+}
+
+/**
+ * @brief Widens a block of costs to doubles
+ * @param cost The vector
+ * @param start The first state of the block
+ * @param length The number of states in the block
+ * @param output The costs of the block (length values)
+ */
+void cost_vector_block(const cost_vector_t *cost, MKL_INT start, MKL_INT length, double *output) {
+    if (cost->type == COST_INT8) {
+        const int8_t *values = (const int8_t *) cost->values + start;
+#pragma omp simd
+        for (MKL_INT j = 0; j < length; ++j) {
+            output[j] = values[j];
+        }
+    } else if (cost->type == COST_INT16) {
+        const int16_t *values = (const int16_t *) cost->values + start;
+#pragma omp simd
+        for (MKL_INT j = 0; j < length; ++j) {
+            output[j] = values[j];
+        }
+    } else {
+        const int32_t *values = (const int32_t *) cost->values + start;
+#pragma omp simd
+        for (MKL_INT j = 0; j < length; ++j) {
+            output[j] = values[j];
+        }
+    }
+}
+
+/**
+ * @brief Applies the cost Hamiltonian C, or the phase generator -iC, to a state
+ * @param cost The vector
+ * @param state The input state (cost->length amplitudes)
+ * @param output The result (distinct from state)
+ * @param generator Whether to apply -iC rather than C
+ */
+void cost_vector_apply(const cost_vector_t *cost, const MKL_Complex16 *state, MKL_Complex16 *output, bool generator) {
+    MKL_INT num_blocks = (cost->length + COST_BLOCK - 1) / COST_BLOCK;
+#pragma omp parallel for schedule(static)
+    for (MKL_INT b = 0; b < num_blocks; ++b) {
+        double values[COST_BLOCK];
+        MKL_INT start = b * COST_BLOCK;
+        MKL_INT length = cost->length - start < COST_BLOCK ? cost->length - start : COST_BLOCK;
+        cost_vector_block(cost, start, length, values);
+        for (MKL_INT j = 0; j < length; ++j) {
+            MKL_Complex16 value = state[start + j];
+            if (generator) {
+                output[start + j].real = values[j] * value.imag;
+                output[start + j].imag = -values[j] * value.real;
+            } else {
+                output[start + j].real = values[j] * value.real;
+                output[start + j].imag = values[j] * value.imag;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Computes the expectation value of the cost function directly from a state
+ * @param cost The vector
+ * @param state The normalised state (cost->length amplitudes)
+ * @return sum_x |psi_x|^2 C(x)
+ */
+double cost_vector_expectation(const cost_vector_t *cost, const MKL_Complex16 *state) {
+    MKL_INT num_blocks = (cost->length + COST_BLOCK - 1) / COST_BLOCK;
+    double result = 0.0;
+#pragma omp parallel for schedule(static) reduction(+:result)
+    for (MKL_INT b = 0; b < num_blocks; ++b) {
+        double values[COST_BLOCK];
+        MKL_INT start = b * COST_BLOCK;
+        MKL_INT length = cost->length - start < COST_BLOCK ? cost->length - start : COST_BLOCK;
+        cost_vector_block(cost, start, length, values);
+        for (MKL_INT j = 0; j < length; ++j) {
+            result += values[j] * (state[start + j].real * state[start + j].real +
+                                   state[start + j].imag * state[start + j].imag);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Releases a cost vector
+ * @param cost The vector (may be NULL)
+ */
+void cost_vector_free(cost_vector_t *cost) {
+    if (cost == NULL) {
+        return;
+    }
+    if (cost->mapped) {
+        ooc_free(cost->values, (size_t) cost->length * cost_type_size(cost->type));
+    } else {
+        numa_free(cost->values);
+    }
+    mkl_free(cost);
+}
@@ -0,0 +1,40 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief The cost function tabulated over the state-space in the narrowest integer type holding its range
+ * @details Cx() returns integers, and most problems only reach small ones, so the cost of every state is stored as
+ * signed 8, 16 or 32-bit integers rather than as a complex number: a 2-16x saving in the memory and bandwidth of every
+ * pass over UC. Kernels read the vector a block of COST_BLOCK values at a time, widened to doubles in cache by
+ * cost_vector_block(), and then work exactly as they would on a double vector.
+ */
+
+#ifndef QOLAB_COST_VECTOR_H
+#define QOLAB_COST_VECTOR_H
+
+#include "globals.h"
+
+#define COST_BLOCK 1024
+
+cost_type_t cost_vector_type(long long minimum, long long maximum);
+
+size_t cost_type_size(cost_type_t type);
+
+cost_vector_t *cost_vector_allocate(MKL_INT length, cost_type_t type, const char *directory);
+
+cost_vector_t *cost_vector_narrow(cost_vector_t *cost, int minimum, int maximum, const char *directory);
+
+const void *cost_vector_address(const cost_vector_t *cost, MKL_INT index);
+
+double cost_vector_get(const cost_vector_t *cost, MKL_INT index);
+
+void cost_vector_set(cost_vector_t *cost, MKL_INT index, int value);
+
+void cost_vector_block(const cost_vector_t *cost, MKL_INT start, MKL_INT length, double *output);
+
+void cost_vector_apply(const cost_vector_t *cost, const MKL_Complex16 *state, MKL_Complex16 *output, bool generator);
+
+double cost_vector_expectation(const cost_vector_t *cost, const MKL_Complex16 *state);
+
+void cost_vector_free(cost_vector_t *cost);
+
+#endif //QOLAB_COST_VECTOR_H
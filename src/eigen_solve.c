@@ -43,7 +43,7 @@ double max_eigen_find(sparse_matrix_t A) {
     check_alloc(res);
 
     /* Local variables */
-    MKL_INT info;                   // Errors */
+    sparse_status_t info;           // Errors */
     MKL_INT compute_vectors = 0;    // Flag to compute eigenvecors
     MKL_INT tol = 7;                // Tolerance
 
@@ -1,3 +1,4 @@
+#include <mathimf.h>
 #include "globals.h"
 
 /**
@@ -32,6 +33,37 @@ void check_alloc(void *pointer) {
     }
 }
 
+/**
+ * @brief Helper function to check the status of a VSL random stream call and fails gracefully
+ * @param status The status returned by the VSL call
+ */
+void check_stream(int status) {
+    if (status != VSL_STATUS_OK) {
+        fprintf(stderr, "Random stream fail (VSL status %d)\n", status);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Acquires the lock of data which may be shared between threads
+ * @param lock The lock (NULL when the data belongs to the calling thread alone)
+ */
+void shared_lock(omp_lock_t *lock) {
+    if (lock != NULL) {
+        omp_set_lock(lock);
+    }
+}
+
+/**
+ * @brief Releases a lock acquired with shared_lock()
+ * @param lock The lock (NULL when the data belongs to the calling thread alone)
+ */
+void shared_unlock(omp_lock_t *lock) {
+    if (lock != NULL) {
+        omp_unset_lock(lock);
+    }
+}
+
 /**
  * @brief A custom mkl error code parser.
  * @details Checks for a variety of possible errors and exits gracefully:
@@ -105,4 +137,209 @@ void move_params_restricted(int P, double *parameters) {
     }
     parameters[2 * P] = 0.0;
     parameters[P - 1] = 0.0;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Stretches a sequence of n angles to n + 1 angles by linear interpolation
+ * @details v'_i = (i/n) v_{i-1} + ((n-i)/n) v_i with v_{-1} = v_n = 0. Computed from the back so it may be done in place.
+ * @param n The current length of the sequence
+ * @param values The sequence, with room for n + 1 values
+ */
+void interp_sequence(int n, double *values) {
+    for (int i = n; i >= 0; --i) {
+        double previous = i > 0 ? values[i - 1] : 0.0;
+        double current = i < n ? values[i] : 0.0;
+        values[i] = (i * previous + (n - i) * current) / n;
+    }
+}
+
+/**
+ * @brief Moves optimization parameters to a larger array, interpolating the new layer (INTERP strategy)
+ * @param P The new decomposition value
+ * @param parameters The parameter array
+ * @warning Assumes that the increase in P is incremental and P > 1
+ */
+void interp_params(int P, double *parameters) {
+    for (int i = 2 * P - 2; i >= P; --i) {
+        parameters[i] = parameters[i - 1];
+    }
+    interp_sequence(P - 1, parameters);
+    interp_sequence(P - 1, parameters + P);
+}
+
+/**
+ * @brief Moves optimization parameters to a larger array, interpolating the new layer in the restricted case
+ * @details The P - 1 gammas and P betas (including the final beta) are each stretched by one
+ * @param P The new decomposition value
+ * @param parameters The parameter array
+ * @warning Assumes that the increase in P is incremental and P > 1
+ */
+void interp_params_restricted(int P, double *parameters) {
+    for (int i = 2 * P - 1; i >= P; --i) {
+        parameters[i] = parameters[i - 1];
+    }
+    interp_sequence(P - 1, parameters);
+    interp_sequence(P, parameters + P);
+}
+
+/**
+ * @brief Determines the number of parameters handed to the optimiser
+ * @param meta_spec Contains the machine, run and optimisation specification
+ * @return 2*q Fourier amplitudes under the FOURIER strategy, otherwise schedule_length()
+ */
+int parameter_count(qaoa_data_t *meta_spec) {
+    if (meta_spec->opt_spec->strategy == STRATEGY_FOURIER) {
+        return 2 * fourier_amplitudes(meta_spec->machine_spec->P, meta_spec->opt_spec->fourier_q);
+    }
+    return schedule_length(meta_spec);
+}
+
+/**
+ * @brief Determines the number of angles evolve() and evolve_restricted() expect
+ * @param meta_spec Contains the machine and run specification
+ * @return 2*P for the standard QAOA, 2*P + 1 for the restricted QAOA
+ */
+int schedule_length(qaoa_data_t *meta_spec) {
+    return 2 * meta_spec->machine_spec->P + (meta_spec->run_spec->restricted ? 1 : 0);
+}
+
+/**
+ * @brief The number of Fourier amplitudes per angle at a given P
+ * @param P The decomposition value
+ * @param q The requested number of amplitudes (0 to grow with P)
+ * @return min(q, P), or P if q is 0
+ */
+int fourier_amplitudes(int P, int q) {
+    return (q <= 0 || q > P) ? P : q;
+}
+
+/**
+ * @brief The k-th Fourier basis function evaluated at the i-th of n layers
+ * @param k The frequency index
+ * @param i The layer index
+ * @param n The number of layers
+ * @param sine Selects the sine (gamma) or cosine (beta) basis
+ * @return sin or cos of (k + 1/2)(i + 1/2)pi/n
+ */
+double fourier_basis(int k, int i, int n, bool sine) {
+    double phase = (k + 0.5) * (i + 0.5) * PI / n;
+    return sine ? sin(phase) : cos(phase);
+}
+
+/**
+ * @brief Expands Fourier amplitudes into the angles of the schedule (FOURIER strategy)
+ * @details gamma_i = sum_k u_k sin((k+1/2)(i+1/2)pi/P) and beta_i = sum_k v_k cos((k+1/2)(i+1/2)pi/n), where n is P
+ * or P + 1 for the restricted QAOA (whose final beta is the last of the sequence)
+ * @param P The decomposition value
+ * @param q The number of amplitudes per angle
+ * @param restricted Whether the schedule is for the restricted QAOA
+ * @param amplitudes The amplitudes u followed by v (2*q length)
+ * @param parameters The output schedule, laid out as for evolve() or evolve_restricted()
+ */
+void fourier_expand(int P, int q, bool restricted, const double *amplitudes, double *parameters) {
+    int num_betas = P + (restricted ? 1 : 0);
+    for (int i = 0; i < P; ++i) {
+        parameters[i] = 0.0;
+        for (int k = 0; k < q; ++k) {
+            parameters[i] += amplitudes[k] * fourier_basis(k, i, P, true);
+        }
+    }
+    for (int i = 0; i < num_betas; ++i) {
+        parameters[P + i] = 0.0;
+        for (int k = 0; k < q; ++k) {
+            parameters[P + i] += amplitudes[q + k] * fourier_basis(k, i, num_betas, false);
+        }
+    }
+}
+
+/**
+ * @brief Maps a gradient with respect to the angles onto the Fourier amplitudes
+ * @param P The decomposition value
+ * @param q The number of amplitudes per angle
+ * @param restricted Whether the schedule is for the restricted QAOA
+ * @param grad The gradient with respect to the schedule
+ * @param amplitude_grad The output gradient with respect to the amplitudes (2*q length)
+ */
+void fourier_gradient(int P, int q, bool restricted, const double *grad, double *amplitude_grad) {
+    int num_betas = P + (restricted ? 1 : 0);
+    for (int k = 0; k < q; ++k) {
+        amplitude_grad[k] = 0.0;
+        amplitude_grad[q + k] = 0.0;
+        for (int i = 0; i < P; ++i) {
+            amplitude_grad[k] += grad[i] * fourier_basis(k, i, P, true);
+        }
+        for (int i = 0; i < num_betas; ++i) {
+            amplitude_grad[q + k] += grad[P + i] * fourier_basis(k, i, num_betas, false);
+        }
+    }
+}
+
+/**
+ * @brief Finds the Fourier amplitudes closest (least-squares) to a schedule of angles
+ * @details The inverse of fourier_expand() when q is the number of angles. The sine and cosine bases over n layers are
+ * orthogonal with norm n/2, so truncating the full transform gives the least-squares fit for smaller q.
+ * @param P The decomposition value
+ * @param q The number of amplitudes per angle
+ * @param restricted Whether the schedule is for the restricted QAOA
+ * @param parameters The schedule, laid out as for evolve() or evolve_restricted()
+ * @param amplitudes The output amplitudes u followed by v (2*q length)
+ */
+void fourier_project(int P, int q, bool restricted, const double *parameters, double *amplitudes) {
+    int num_betas = P + (restricted ? 1 : 0);
+    for (int k = 0; k < q; ++k) {
+        amplitudes[k] = 0.0;
+        amplitudes[q + k] = 0.0;
+        for (int i = 0; i < P; ++i) {
+            amplitudes[k] += 2.0 / P * parameters[i] * fourier_basis(k, i, P, true);
+        }
+        for (int i = 0; i < num_betas; ++i) {
+            amplitudes[q + k] += 2.0 / num_betas * parameters[P + i] * fourier_basis(k, i, num_betas, false);
+        }
+    }
+}
+
+/**
+ * @brief Turns the optimised parameters at P - 1 into the initial parameters at P according to the strategy
+ * @details Reallocates the parameter array. Under FOURIER the amplitudes are kept and, if q grows with P, a zero
+ * amplitude is appended to each of u and v.
+ * @param P The new decomposition value
+ * @param restricted Whether the parameters are for the restricted QAOA
+ * @param opt_spec Contains the parameters and the strategy
+ * @warning Assumes that the increase in P is incremental and P > 1
+ */
+void grow_params(int P, bool restricted, optimization_spec_t *opt_spec) {
+    int length = 2 * P + (restricted ? 1 : 0);
+    int q = 0;
+    if (P < 2) {
+        fprintf(stderr, "Cannot grow parameters to P < 2.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opt_spec->strategy == STRATEGY_FOURIER) {
+        q = fourier_amplitudes(P, opt_spec->fourier_q);
+        if (q == fourier_amplitudes(P - 1, opt_spec->fourier_q)) {
+            return;
+        }
+        length = 2 * q;
+    }
+    opt_spec->parameters = mkl_realloc(opt_spec->parameters, length * sizeof(double));
+    check_alloc(opt_spec->parameters);
+    switch (opt_spec->strategy) {
+        case STRATEGY_FOURIER:
+            move_params(q, opt_spec->parameters);
+            break;
+        case STRATEGY_INTERP:
+            if (restricted) {
+                interp_params_restricted(P, opt_spec->parameters);
+            } else {
+                interp_params(P, opt_spec->parameters);
+            }
+            break;
+        default:
+            if (restricted) {
+                move_params_restricted(P, opt_spec->parameters);
+            } else {
+                move_params(P, opt_spec->parameters);
+            }
+            break;
+    }
+}
@@ -6,6 +6,7 @@
 #define GRAPHSIMILARITY_GLOBALS_H
 
 #include <stdio.h>
+#include <omp.h>
 #include <mkl.h>
 #include <stdbool.h>
 #include <nlopt.h>
@@ -13,6 +14,11 @@
 
 #define DEF_ALIGNMENT 64
 #define PI 3.1415926535
+#define CHEBY_DEFAULT_TOLERANCE 1e-17
+#define BLOCK_LENGTH_DEFAULT 16384
+#define BLOCK_LENGTH_STREAMED 4194304
+#define SPECTRAL_LIMIT_DEFAULT 2048
+#define QAOA_STREAM_STRIDE ((long long) 1 << 40)
 
 
 //Mathematical
@@ -21,11 +27,18 @@ MKL_INT factorial(int n);
 //Administrative
 void mkl_error_parse(int error, FILE *stream);
 void check_alloc(void *pointer);
+void check_stream(int status);
+void shared_lock(omp_lock_t *lock);
+void shared_unlock(omp_lock_t *lock);
 
 void move_params(int P, double *parameters);
 
 void move_params_restricted(int P, double *parameters);
 
+void interp_params(int P, double *parameters);
+
+void interp_params_restricted(int P, double *parameters);
+
 /*! Contains run-time statistics */
 typedef struct {
     double startTimes[4];       /**< Buffers to hold timing data (total, uc, ub, optimisation) */
@@ -35,11 +48,49 @@ typedef struct {
     double random_exp;          /**< Randomly sampling the entire QAOA domain (may be different to whole state-space) */
     double best_sample;    /**< The best expectation value found */
     double best_expectation;
-    int max_value, max_index;   /**< The maximum value and index in the cost function generated */
+    int max_value;              /**< The maximum value in the cost function generated */
+    MKL_INT max_index;          /**< The (first) state index attaining max_value */
     nlopt_result term_status;   /**< The nlopt termination status */
     int num_evals;              /**< The number of evaluations used by the optimiser */
+    double *trace;              /**< The objective value of each evaluation (NULL if not traced) */
+    int trace_length;           /**< The capacity of the trace buffer */
+    int start;                  /**< The index of the start these statistics belong to (0 for a single start) */
 } qaoa_statistics_t;
 
+/*! Selects the quantity returned to the classical optimiser after each evaluation */
+typedef enum {
+    OBJECTIVE_EXPECTATION,  /**< The expectation value (or sample mean when sampling) */
+    OBJECTIVE_CVAR,         /**< The mean of the best alpha-tail of outcomes (https://arxiv.org/abs/1907.04769) */
+    OBJECTIVE_GIBBS         /**< The Gibbs objective (1/eta)ln<exp(eta C)> (https://arxiv.org/abs/1909.07621) */
+} objective_t;
+
+/*! Selects the engine applying the mixer */
+typedef enum {
+    MIXER_CHEBYSHEV,    /**< Chebyshev expansion of exp(-i beta UB) over the sparse driver (any mask) */
+    MIXER_PRODUCT,      /**< Exact product of single-qubit X rotations (unrestricted only, UB is never built) */
+    MIXER_GROVER,       /**< Exact rank-one reflection about the feasible states of mask() (see grover.h, no UB) */
+    MIXER_XY            /**< Trotterised product of two-qubit XY rotations preserving Hamming weight (see xy_mixer.h) */
+} mixer_engine_t;
+
+/*! Selects the qubit pairs coupled by the XY mixer */
+typedef enum {
+    XY_RING,        /**< Neighbouring qubits j and j + 1 (mod num_qubits) */
+    XY_COMPLETE     /**< Every pair of qubits */
+} xy_topology_t;
+
+/*! Selects how OpenMP threads are bound to cores (one thread per physical core before any hyper-thread siblings) */
+typedef enum {
+    BINDING_NONE,   /**< Leave placement to the OpenMP runtime (OMP_PROC_BIND, OMP_PLACES) */
+    BINDING_CLOSE,  /**< Consecutive threads on consecutive cores, filling one NUMA node before the next */
+    BINDING_SPREAD  /**< Consecutive threads alternate between NUMA nodes */
+} binding_policy_t;
+
+/*! Selects the file format of the evaluation trace */
+typedef enum {
+    TRACE_BINARY,   /**< Fixed-size little-endian records after a header per run (see trace.h) */
+    TRACE_CSV       /**< One line per evaluation after a header line per run */
+} trace_format_t;
+
 /*! Defines run-time parameters on what to report and the type of algorithm simulated */
 typedef struct {
     bool timing;        /**< Do we report timing? */
@@ -49,7 +100,27 @@ typedef struct {
     bool verbose;       /**< Should we print everything? */
     bool restricted;    /**< Are we running the restricted version of the QAOA? (https://arxiv.org/abs/1804.08227) */
     bool restart;       /**< If set, the simulation will retain parameter information between calls to the simulation */
+    unsigned seed;      /**< Seeds the run's random stream (0 to seed from the clock) */
     int num_samples;    /**< The number of samples we use */
+    objective_t objective; /**< The objective function handed to the optimiser */
+    double cvar_alpha;  /**< The tail fraction (0, 1] used by the CVaR objective */
+    double gibbs_eta;   /**< The inverse temperature (> 0) used by the Gibbs objective */
+    double cheby_tolerance; /**< Truncation threshold of the Chebyshev mixer expansion (CHEBY_DEFAULT_TOLERANCE) */
+    MKL_INT spectral_limit; /**< Most feasible states for which the Chebyshev mixer is replaced by the driver's dense
+                             * eigendecomposition (SPECTRAL_LIMIT_DEFAULT, 0 to disable, see spectral_mixer.h) */
+    mixer_engine_t mixer;   /**< The engine applying the mixer */
+    xy_topology_t xy_topology; /**< The pairs coupled by the XY mixer */
+    int xy_steps;           /**< Trotter steps per layer of the XY mixer (at least 1) */
+    int xy_weight;          /**< The Hamming weight of the Dicke state the XY mixer starts from */
+    bool symmetric;         /**< Evolve only the half-space invariant under flipping every bit (needs C(x) = C(~x)) */
+    bool lightcone;         /**< Evaluate the MaxCut expectation edge by edge over light cones (see lightcone.h) */
+    MKL_INT block_length;   /**< Amplitudes per block of the product mixer and streamed kernels (a power of two) */
+    const char *ooc_directory; /**< Local directory backing the state and cost vectors with mapped files (NULL) */
+    size_t state_cache_bytes;  /**< Memory for the states after each layer of recent evaluations (0 to disable) */
+    binding_policy_t binding;  /**< How threads are bound to cores (BINDING_NONE) */
+    const char *trace_path;    /**< File every evaluation is appended to by a background writer (NULL to disable) */
+    trace_format_t trace_format; /**< The format of the evaluation trace */
+    const char *profile_path; /**< File the JSON kernel profile is appended to (NULL for outfile) */
     FILE *outfile;      /**< The stream we actually write to (can be stdout or a file) */
 } run_spec_t;
 
@@ -57,22 +128,63 @@ typedef struct {
 typedef struct {
     int num_qubits;          /**< The number of qubits in our 'machine' */
     int P;                   /**< The amount of trotterisation */
-    MKL_INT space_dimension; /**< The size of the state vector pow(2, qubits) */
+    MKL_INT space_dimension; /**< The size of the state vector pow(2, qubits), 64-bit under ILP64 (the simulation's
+                              * own copy is halved for a symmetric problem, see qaoa_prepare()) */
 } machine_spec_t;
 
+/*! Selects the classical optimiser */
+typedef enum {
+    OPTIMISER_NLOPT,        /**< The nlopt method given by nlopt_method, one point at a time */
+    OPTIMISER_SPSA,         /**< Simultaneous perturbation stochastic approximation, two points per iteration */
+    OPTIMISER_ADAM,         /**< Adam on analytic gradients where available, otherwise on SPSA gradient estimates */
+    OPTIMISER_CMAES         /**< Covariance matrix adaptation evolution strategy, one population per iteration */
+} optimiser_t;
+
+/*! Selects how the schedule is parameterised and carried from one value of P to the next (https://arxiv.org/abs/1812.01041) */
+typedef enum {
+    STRATEGY_ZERO,          /**< Angles are optimised directly, new layers start at zero */
+    STRATEGY_INTERP,        /**< Angles are optimised directly, new layers are linearly interpolated from the last */
+    STRATEGY_FOURIER        /**< q Fourier amplitudes are optimised and expanded into the angles */
+} parameter_strategy_t;
+
 /*! Specifies the classical optimisation scheme */
 typedef struct {
+    optimiser_t optimiser_type; /**< Whether to use nlopt or one of the built-in batched optimisers */
     int nlopt_method;       /**< The optimisation method used */
-    int max_evals;          /**< The maximum number of evaluations permitted */
+    int max_evals;          /**< The maximum number of evaluations permitted (per start) */
+    int num_starts;         /**< The number of independent optimisers run concurrently (1 for a single start) */
     double xtol;            /**< The termination criteria for the parameter values */
     double ftol;            /**< The termination criteria for the function output */
-    double *parameters;     /**< The parameters to be optimised (2*P length) */
+    double step_size;       /**< SPSA gain, Adam learning rate or CMA-ES initial sigma (0 for the default) */
+    double perturbation;    /**< SPSA perturbation size (0 for the default) */
+    int population;         /**< CMA-ES population size (0 for the default) */
+    parameter_strategy_t strategy; /**< How the parameters represent the schedule and grow with P */
+    int fourier_q;          /**< The number of Fourier amplitudes per angle (0 for q = P) */
+    const char *store_path; /**< The parameter-transfer store used to seed and record runs (NULL to disable) */
+    const char *problem_class; /**< The class of the instance, keying the store (no whitespace) */
+    int store_seeds;        /**< The number of nearest stored entries screened for the initial point */
+    double *parameters;     /**< The parameters to be optimised (see parameter_count()) */
     double *lower_bounds;   /**< The lower bounds for the parameters */
     double *upper_bounds;   /**< The upper bounds for the parameters */
     nlopt_opt optimiser;    /**< The actual optimiser object */
     //nlopt_opt local_opt;  //TODO: Support for hybrid multi-optimiser (e.g. MLSL)
 } optimization_spec_t;
 
+/*! The storage type of a cost vector, the narrowest holding every cost value */
+typedef enum {
+    COST_INT8,      /**< Signed 8-bit integers */
+    COST_INT16,     /**< Signed 16-bit integers */
+    COST_INT32      /**< Signed 32-bit integers, the range of Cx() */
+} cost_type_t;
+
+/*! The cost function tabulated over the state-space in its compact type (see cost_vector.h) */
+typedef struct cost_vector {
+    cost_type_t type;       /**< The storage type of values */
+    MKL_INT length;         /**< The number of values */
+    bool mapped;            /**< Whether values are memory-mapped (out-of-core) rather than NUMA allocated */
+    void *values;           /**< The cost of every state */
+} cost_vector_t;
+
 /*! A meta-structure which contains the information about the entire run
  *
  * This means we can pass a single pointer through many functions but retain access to all elements. */
@@ -82,9 +194,33 @@ typedef struct{
     cost_data_t *cost_data;             /**< Contains the problem-dependent information */
     sparse_matrix_t ub;                 /**< The data structure containing the driver hamiltonian */
     double ub_eigenvalue;               /**< The leading eigenvalue of the UB matrix */
-    MKL_Complex16 *uc;                  /**< The data structure containing the cost function */
+    cost_vector_t *uc;                  /**< The data structure containing the cost function */
     qaoa_statistics_t *qaoa_statistics; /**< Contains run-time statistics */
+    qaoa_statistics_t *start_statistics;/**< Per-start statistics of a multi-start run (NULL otherwise) */
     optimization_spec_t *opt_spec;      /**< Specifies the classical optimisation scheme */
+    struct trace_writer *trace;         /**< The evaluation trace writer (NULL when not tracing) */
+    struct lightcone *lightcone;        /**< The light-cone evaluator (NULL unless run_spec->lightcone) */
+    struct grover_mixer *grover;        /**< The feasible set of the Grover mixer (NULL unless MIXER_GROVER) */
+    struct spectral_mixer *spectral;    /**< The eigendecomposition of UB on a small feasible space (NULL if none) */
+    struct state_cache *state_cache;    /**< The states after each layer of recent evaluations (NULL if not cached) */
+    VSLStreamStatePtr stream;           /**< The run's random stream: samples, random starts and optimiser seeds */
+    struct profile *profile;            /**< The run's kernel counters (NULL unless built with QOLAB_PROFILE) */
+    struct numa_pool *workspace;        /**< The state-sized temporaries of the evaluations (NULL to allocate each) */
+    omp_lock_t *batch_lock;             /**< Guards the statistics shared by concurrent batched points (NULL if none) */
 } qaoa_data_t;
 
+int parameter_count(qaoa_data_t *meta_spec);
+
+int schedule_length(qaoa_data_t *meta_spec);
+
+int fourier_amplitudes(int P, int q);
+
+void fourier_expand(int P, int q, bool restricted, const double *amplitudes, double *parameters);
+
+void fourier_gradient(int P, int q, bool restricted, const double *grad, double *amplitude_grad);
+
+void fourier_project(int P, int q, bool restricted, const double *parameters, double *amplitudes);
+
+void grow_params(int P, bool restricted, optimization_spec_t *opt_spec);
+
 #endif
\ No newline at end of file
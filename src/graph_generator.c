@@ -0,0 +1,295 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Reproducible bulk generation of graph instances and their compact adjacency formats
+ * @details Random undirected graphs draw the upper triangle one row at a time, so the scratch space is O(n) rather than
+ * O(n^2). Regular graphs follow Steger and Wormald: unpaired half-edges are matched at random, rejecting only the pairs
+ * which would form a loop or a repeated edge, and the whole pairing restarts in the rare case that it gets stuck.
+ */
+
+#include <string.h>
+#include "graph_generator.h"
+
+#define GRAPH_DRAW_BLOCK 256
+
+/**
+ * @brief Checks the parameters of a graph family, exits with an error message if they are invalid
+ * @param spec The graph family and parameters
+ */
+void graph_check_spec(const graph_spec_t *spec) {
+    int n = spec->num_vertices;
+    if (n < 1) {
+        fprintf(stderr, "A graph needs at least one vertex.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (spec->family != GRAPH_REGULAR && (spec->prob < 0.0 || spec->prob > 1.0)) {
+        fprintf(stderr, "Edge probability %f is not in [0, 1].\n", spec->prob);
+        exit(EXIT_FAILURE);
+    }
+    if (spec->family == GRAPH_REGULAR && (spec->degree < 0 || spec->degree >= n || (n * spec->degree) % 2 != 0)) {
+        fprintf(stderr, "No simple %d-regular graph on %d vertices exists.\n", spec->degree, n);
+        exit(EXIT_FAILURE);
+    }
+    if (spec->family == GRAPH_WEIGHTED && spec->max_weight < 1) {
+        fprintf(stderr, "The largest edge weight must be at least 1.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Checks that a range of instance numbers has stream offsets, exiting with an error message if not
+ * @param first The number of the first instance
+ * @param count The number of instances
+ */
+void graph_check_instances(MKL_INT first, MKL_INT count) {
+    if (first < 0 || count < 0 || (long long) first + count > GRAPH_MAX_INSTANCES) {
+        fprintf(stderr, "Instances %lld to %lld are not all in [0, %lld).\n", (long long) first,
+                (long long) first + count - 1, GRAPH_MAX_INSTANCES);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Draws the upper triangle of an undirected graph and mirrors it
+ * @param stream The instance's random stream
+ * @param spec The graph family and parameters (GRAPH_ERDOS_RENYI or GRAPH_WEIGHTED)
+ * @param graph The zeroed n * n adjacency matrix to fill
+ */
+static void graph_undirected(VSLStreamStatePtr stream, const graph_spec_t *spec, MKL_INT *graph) {
+    int n = spec->num_vertices;
+    int *present = mkl_malloc(n * sizeof(int), DEF_ALIGNMENT);
+    int *weight = mkl_malloc(n * sizeof(int), DEF_ALIGNMENT);
+    check_alloc(present);
+    check_alloc(weight);
+    for (int i = 0; i < n - 1; ++i) {
+        int length = n - 1 - i;
+        viRngBernoulli(VSL_RNG_METHOD_BERNOULLI_ICDF, stream, length, present, spec->prob);
+        if (spec->family == GRAPH_WEIGHTED) {
+            viRngUniform(VSL_RNG_METHOD_UNIFORM_STD, stream, length, weight, 1, spec->max_weight + 1);
+        }
+        for (int k = 0; k < length; ++k) {
+            if (present[k]) {
+                int j = i + 1 + k;
+                MKL_INT value = spec->family == GRAPH_WEIGHTED ? weight[k] : 1;
+                graph[(MKL_INT) i * n + j] = value;
+                graph[(MKL_INT) j * n + i] = value;
+            }
+        }
+    }
+    mkl_free(weight);
+    mkl_free(present);
+}
+
+/**
+ * @brief Determines whether any two unpaired half-edges can still be joined
+ * @param points The vertex of each unpaired half-edge
+ * @param remaining The number of unpaired half-edges
+ * @param n The number of vertices
+ * @param graph The adjacency matrix built so far
+ * @return True if some pair would form neither a loop nor a repeated edge
+ */
+static bool graph_pairable(const int *points, int remaining, int n, const MKL_INT *graph) {
+    for (int a = 0; a < remaining; ++a) {
+        for (int b = a + 1; b < remaining; ++b) {
+            if (points[a] != points[b] && graph[(MKL_INT) points[a] * n + points[b]] == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Attempts one random pairing of the half-edges of a regular graph
+ * @param stream The instance's random stream
+ * @param n The number of vertices
+ * @param degree The degree of every vertex
+ * @param points Scratch space for n * degree half-edges
+ * @param graph The n * n adjacency matrix to fill, zeroed by this function
+ * @return False if the pairing got stuck and must be restarted
+ */
+static bool graph_pair_regular(VSLStreamStatePtr stream, int n, int degree, int *points, MKL_INT *graph) {
+    double draws[GRAPH_DRAW_BLOCK];
+    int next = GRAPH_DRAW_BLOCK;
+    int remaining = n * degree;
+    memset(graph, 0, (size_t) n * n * sizeof(MKL_INT));
+    for (int p = 0; p < remaining; ++p) {
+        points[p] = p / degree;
+    }
+    while (remaining > 0) {
+        long long failures = 0;
+        int a, b;
+        for (;;) {
+            if (next + 2 > GRAPH_DRAW_BLOCK) {
+                vdRngUniform(VSL_RNG_METHOD_UNIFORM_STD, stream, GRAPH_DRAW_BLOCK, draws, 0.0, 1.0);
+                next = 0;
+            }
+            a = (int) (draws[next++] * remaining);
+            b = (int) (draws[next++] * remaining);
+            if (a != b && points[a] != points[b] && graph[(MKL_INT) points[a] * n + points[b]] == 0) {
+                break;
+            }
+            if (++failures > (long long) remaining * remaining) {
+                if (!graph_pairable(points, remaining, n, graph)) {
+                    return false;
+                }
+                failures = 0;
+            }
+        }
+        graph[(MKL_INT) points[a] * n + points[b]] = 1;
+        graph[(MKL_INT) points[b] * n + points[a]] = 1;
+        //Remove the larger position first so the smaller is not moved by the first removal
+        if (a < b) {
+            int swap = a;
+            a = b;
+            b = swap;
+        }
+        points[a] = points[--remaining];
+        points[b] = points[--remaining];
+    }
+    return true;
+}
+
+/**
+ * @brief Generates one instance of a graph sweep
+ * @details The instance is fully determined by the family, seed and instance number, independent of any other
+ * instance or of the thread generating it.
+ * @param spec The graph family and parameters
+ * @param seed The seed of the sweep
+ * @param instance The number of the instance within the sweep, in [0, GRAPH_MAX_INSTANCES)
+ * @param graph The num_vertices * num_vertices adjacency matrix to fill (overwritten entirely)
+ */
+void graph_generate(const graph_spec_t *spec, unsigned seed, MKL_INT instance, MKL_INT *graph) {
+    int n = spec->num_vertices;
+    VSLStreamStatePtr stream;
+    graph_check_spec(spec);
+    graph_check_instances(instance, 1);
+    vslNewStream(&stream, VSL_BRNG_PHILOX4X32X10, (MKL_UINT) seed);
+    vslSkipAheadStream(stream, (long long) instance * GRAPH_STREAM_STRIDE);
+    memset(graph, 0, (size_t) n * n * sizeof(MKL_INT));
+
+    switch (spec->family) {
+        case GRAPH_DIRECTED: {
+            int *present = mkl_malloc(n * sizeof(int), DEF_ALIGNMENT);
+            check_alloc(present);
+            for (int i = 0; i < n; ++i) {
+                viRngBernoulli(VSL_RNG_METHOD_BERNOULLI_ICDF, stream, n, present, spec->prob);
+                for (int j = 0; j < n; ++j) {
+                    graph[(MKL_INT) i * n + j] = present[j];
+                }
+            }
+            mkl_free(present);
+            break;
+        }
+        case GRAPH_REGULAR: {
+            int *points = mkl_malloc((n * spec->degree + 1) * sizeof(int), DEF_ALIGNMENT);
+            int attempt = 0;
+            check_alloc(points);
+            while (!graph_pair_regular(stream, n, spec->degree, points, graph)) {
+                if (++attempt == GRAPH_REGULAR_ATTEMPTS) {
+                    fprintf(stderr, "Could not pair a %d-regular graph on %d vertices.\n", spec->degree, n);
+                    exit(EXIT_FAILURE);
+                }
+            }
+            mkl_free(points);
+            break;
+        }
+        default:
+            graph_undirected(stream, spec, graph);
+            break;
+    }
+    vslDeleteStream(&stream);
+}
+
+/**
+ * @brief Generates consecutive instances of a graph sweep in parallel
+ * @param spec The graph family and parameters
+ * @param seed The seed of the sweep
+ * @param first The number of the first instance
+ * @param count The number of instances, all below GRAPH_MAX_INSTANCES
+ * @param graphs count adjacency matrices of num_vertices * num_vertices, one after another
+ */
+void graph_generate_batch(const graph_spec_t *spec, unsigned seed, MKL_INT first, MKL_INT count, MKL_INT *graphs) {
+    MKL_INT size = (MKL_INT) spec->num_vertices * spec->num_vertices;
+    graph_check_spec(spec);
+    graph_check_instances(first, count);
+#pragma omp parallel for schedule(dynamic)
+    for (MKL_INT k = 0; k < count; ++k) {
+        graph_generate(spec, seed, first + k, graphs + k * size);
+    }
+}
+
+/**
+ * @brief The number of 64-bit words holding one row of a bitset adjacency matrix
+ * @param num_vertices The number of vertices
+ * @return The row stride of graph_to_bitset()
+ */
+MKL_INT graph_bitset_words(int num_vertices) {
+    return (num_vertices + 63) / 64;
+}
+
+/**
+ * @brief Packs an adjacency matrix into a bitset
+ * @details Bit j % 64 of word i * graph_bitset_words(n) + j / 64 is set when graph[i][j] is non-zero.
+ * @param graph The n * n adjacency matrix
+ * @param num_vertices The number of vertices
+ * @param bits num_vertices * graph_bitset_words(num_vertices) words to fill
+ */
+void graph_to_bitset(const MKL_INT *graph, int num_vertices, uint64_t *bits) {
+    MKL_INT words = graph_bitset_words(num_vertices);
+    memset(bits, 0, (size_t) num_vertices * words * sizeof(uint64_t));
+    for (int i = 0; i < num_vertices; ++i) {
+        for (int j = 0; j < num_vertices; ++j) {
+            if (graph[(MKL_INT) i * num_vertices + j] != 0) {
+                bits[i * words + j / 64] |= (uint64_t) 1 << (j % 64);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Converts an adjacency matrix to CSR
+ * @param graph The n * n adjacency matrix
+ * @param num_vertices The number of vertices
+ * @param csr The CSR form, whose arrays are allocated here and released with graph_csr_free()
+ */
+void graph_to_csr(const MKL_INT *graph, int num_vertices, graph_csr_t *csr) {
+    MKL_INT entries = 0;
+    csr->num_vertices = num_vertices;
+    csr->row_start = mkl_malloc((num_vertices + 1) * sizeof(MKL_INT), DEF_ALIGNMENT);
+    check_alloc(csr->row_start);
+    for (int i = 0; i < num_vertices; ++i) {
+        csr->row_start[i] = entries;
+        for (int j = 0; j < num_vertices; ++j) {
+            entries += graph[(MKL_INT) i * num_vertices + j] != 0;
+        }
+    }
+    csr->row_start[num_vertices] = entries;
+    csr->num_entries = entries;
+    //Allocate at least one entry so an edgeless graph still has valid arrays
+    csr->columns = mkl_malloc((entries + 1) * sizeof(MKL_INT), DEF_ALIGNMENT);
+    csr->weights = mkl_malloc((entries + 1) * sizeof(MKL_INT), DEF_ALIGNMENT);
+    check_alloc(csr->columns);
+    check_alloc(csr->weights);
+    entries = 0;
+    for (int i = 0; i < num_vertices; ++i) {
+        for (int j = 0; j < num_vertices; ++j) {
+            MKL_INT value = graph[(MKL_INT) i * num_vertices + j];
+            if (value != 0) {
+                csr->columns[entries] = j;
+                csr->weights[entries] = value;
+                entries++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Releases the arrays of a CSR graph
+ * @param csr The CSR graph
+ */
+void graph_csr_free(graph_csr_t *csr) {
+    mkl_free(csr->weights);
+    mkl_free(csr->columns);
+    mkl_free(csr->row_start);
+}
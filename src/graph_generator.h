@@ -0,0 +1,65 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Reproducible bulk generation of graph instances and their compact adjacency formats
+ * @details Instance k of a sweep seeded with s is drawn from a Philox4x32-10 stream seeded with s and skipped ahead by
+ * k * GRAPH_STREAM_STRIDE, so any instance can be regenerated on its own, in any order or on any thread, and gets the
+ * same graph. Instance numbers run from 0 to GRAPH_MAX_INSTANCES - 1, the range whose skip-ahead fits a long long.
+ * Graphs are produced in the dense n x n adjacency form used by cost_data_t and can be converted to a row-major bitset
+ * or to CSR.
+ */
+
+#ifndef QOLAB_GRAPH_GENERATOR_H
+#define QOLAB_GRAPH_GENERATOR_H
+
+#include <stdint.h>
+#include <mkl.h>
+#include "globals.h"
+
+#define GRAPH_STREAM_STRIDE ((long long) 1 << 40)
+#define GRAPH_MAX_INSTANCES ((long long) 1 << 23)
+#define GRAPH_REGULAR_ATTEMPTS 1000
+
+/*! The random graph families */
+typedef enum {
+    GRAPH_ERDOS_RENYI,      /**< G(n, p): each undirected edge present with probability prob */
+    GRAPH_DIRECTED,         /**< Each of the n * n entries (self-loops included) set with probability prob */
+    GRAPH_REGULAR,          /**< A random simple graph with every vertex of the same degree */
+    GRAPH_WEIGHTED          /**< G(n, p) with integer weights uniform in [1, max_weight] */
+} graph_family_t;
+
+/*! The family and parameters of a graph sweep */
+typedef struct {
+    graph_family_t family;  /**< The family drawn from */
+    int num_vertices;       /**< The number of vertices */
+    double prob;            /**< The edge probability (GRAPH_ERDOS_RENYI, GRAPH_DIRECTED, GRAPH_WEIGHTED) */
+    int degree;             /**< The degree of every vertex (GRAPH_REGULAR), num_vertices * degree must be even */
+    int max_weight;         /**< The largest edge weight (GRAPH_WEIGHTED) */
+} graph_spec_t;
+
+/*! A graph in compressed sparse row form */
+typedef struct {
+    int num_vertices;       /**< The number of vertices */
+    MKL_INT num_entries;    /**< The number of non-zero adjacency entries (twice the edges if undirected) */
+    MKL_INT *row_start;     /**< num_vertices + 1 offsets into columns and weights */
+    MKL_INT *columns;       /**< The neighbours of each vertex, ascending */
+    MKL_INT *weights;       /**< The adjacency entry of each neighbour */
+} graph_csr_t;
+
+void graph_check_spec(const graph_spec_t *spec);
+
+void graph_check_instances(MKL_INT first, MKL_INT count);
+
+void graph_generate(const graph_spec_t *spec, unsigned seed, MKL_INT instance, MKL_INT *graph);
+
+void graph_generate_batch(const graph_spec_t *spec, unsigned seed, MKL_INT first, MKL_INT count, MKL_INT *graphs);
+
+MKL_INT graph_bitset_words(int num_vertices);
+
+void graph_to_bitset(const MKL_INT *graph, int num_vertices, uint64_t *bits);
+
+void graph_to_csr(const MKL_INT *graph, int num_vertices, graph_csr_t *csr);
+
+void graph_csr_free(graph_csr_t *csr);
+
+#endif //QOLAB_GRAPH_GENERATOR_H
@@ -4,20 +4,16 @@
  * @brief A number of utility functions for generating and manipulating graphs
  */
 
-#include <time.h>
 #include "graph_utils.h"
 
 /**
  * @brief Generates an array of random doubles
  * @param num_request The number of random doubles to be generated
  * @param buffer The buffer (assumed to be at least size num_request) to be filled with numbers
- * @warning Uses srand, should move to a new generator soon
+ * @param stream The random stream drawn from, which the caller seeds
  */
-void random_doubles(int num_request, double *buffer) {
-    srand((unsigned) time(0)); //TODO: Change random engine to something reasonable
-    for (int i = 0; i < num_request; ++i) {
-        buffer[i] = rand() / (double) RAND_MAX;
-    }
+void random_doubles(int num_request, double *buffer, VSLStreamStatePtr stream) {
+    check_stream(vdRngUniform(VSL_RNG_METHOD_UNIFORM_STD, stream, num_request, buffer, 0.0, 1.0));
 }
 
 /**
@@ -30,28 +26,25 @@ void print_graph(cost_data_t *cost_data, FILE *out){
     int graph_size = cost_data->num_vertices;
     for (int i = 0; i < graph_size; ++i) {
         for (int j = 0; j < graph_size; ++j) {
-            fprintf(out, "%d ", cost_data->graph[graph_size * i + j]);
+            fprintf(out, "%lld ", (long long) cost_data->graph[graph_size * i + j]);
         }
         fprintf(out, "\n");
     }fprintf(out, "\n");
 }
 
 /**
- * @brief Generates two random graphs. Generates two ErdosRenyi graphs using system random. Should be avoided due to well
- * known limitations of system rand.
+ * @brief Generates a random graph, setting each entry of the adjacency matrix with probability prob
  * @param graph1  Assumed to be of graph_size * graph_size in length
- * @param graph2  Assumed to be of graph_size * graph_size in length
  * @param graph_size The number of vertices required
  * @param prob  Defaults to 0.5
+ * @param stream The random stream drawn from
  */
-void generate_graph(MKL_INT *graph1, int graph_size, float prob) {
-    double *randomNums = mkl_calloc((size_t) 2 * graph_size * graph_size, sizeof(double), DEF_ALIGNMENT);
+void generate_graph(MKL_INT *graph1, int graph_size, float prob, VSLStreamStatePtr stream) {
+    double *randomNums = mkl_calloc((size_t) graph_size * graph_size, sizeof(double), DEF_ALIGNMENT);
     check_alloc(randomNums);
-    random_doubles(graph_size * graph_size * 2, randomNums);
+    random_doubles(graph_size * graph_size, randomNums, stream);
     for (int i = 0; i < graph_size * graph_size; ++i) {
-        if (randomNums[i] < prob) {
-            graph1[i] = 1;
-        }
+        graph1[i] = randomNums[i] < prob;
     }
     mkl_free(randomNums);
 }
@@ -63,15 +56,14 @@ void generate_graph(MKL_INT *graph1, int graph_size, float prob) {
  * @param graph The adjacency matrix to hold the graph
  * @param graph_size The number of vertices in the graph
  * @param prob The population probability of each edge
+ * @param stream The random stream drawn from
  */
-void generate_random(MKL_INT *graph, int graph_size, float prob) {
+void generate_random(MKL_INT *graph, int graph_size, float prob, VSLStreamStatePtr stream) {
     double *randomNums = mkl_calloc((size_t) graph_size * graph_size, sizeof(double), DEF_ALIGNMENT);
     check_alloc(randomNums);
-    random_doubles(graph_size * graph_size, randomNums);
+    random_doubles(graph_size * graph_size, randomNums, stream);
     for (int i = 0; i < graph_size * graph_size; ++i) {
-        if (randomNums[i] < prob) {
-            graph[i] = 1;
-        }
+        graph[i] = randomNums[i] < prob;
     }
     mkl_free(randomNums);
 }
@@ -84,17 +76,17 @@ void generate_random(MKL_INT *graph, int graph_size, float prob) {
  * @param graph1 The graph to be populated
  * @param graph_size The number of vertices in the graph
  * @param prob The probability of each edge begin populated
+ * @param stream The random stream drawn from
  */
-void generate_undirected(MKL_INT *graph1, int graph_size, float prob) {
-    double *randomNums = mkl_calloc((size_t) factorial(graph_size), sizeof(double), DEF_ALIGNMENT);
+void generate_undirected(MKL_INT *graph1, int graph_size, float prob, VSLStreamStatePtr stream) {
+    double *randomNums = mkl_calloc((size_t) graph_size * graph_size, sizeof(double), DEF_ALIGNMENT);
     check_alloc(randomNums);
-    random_doubles(factorial(graph_size), randomNums);
+    random_doubles(graph_size * graph_size, randomNums, stream);
     for (int i = 0; i < graph_size; ++i) {
+        graph1[graph_size * i + i] = 0;
         for (int j = i + 1; j < graph_size; ++j) {
-            if (randomNums[i * graph_size + j] < prob) {
-                graph1[graph_size * i + j] = 1;
-                graph1[graph_size * j + i] = 1;
-            }
+            graph1[graph_size * i + j] = randomNums[i * graph_size + j] < prob;
+            graph1[graph_size * j + i] = graph1[graph_size * i + j];
         }
     }
     mkl_free(randomNums);
@@ -153,10 +145,11 @@ int count_1(const MKL_INT *src, int graph_size) {
  * @param dest The graph to be edited
  * @param graph_size The number of vertices in both graphs
  * @param count The number of edges to be added
+ * @param stream The random stream the edge is chosen with
  */
-void add_edge_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int count) {
+void add_edge_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int count, VSLStreamStatePtr stream) {
     int choice, count_z = 0;
-    choice = rand() % count;
+    check_stream(viRngUniform(VSL_RNG_METHOD_UNIFORM_STD, stream, 1, &choice, 0, count));
     for (int i = 0; i < graph_size * graph_size; ++i) {
         if (src[i] == 0) {
             if (choice == count_z) {
@@ -175,10 +168,11 @@ void add_edge_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int coun
  * @param dest The graph to be edited
  * @param graph_size The number of vertices in both graphs
  * @param count The number of edges to add
+ * @param stream The random stream the edge is chosen with
  */
-void add_edge_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int count) {
+void add_edge_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int count, VSLStreamStatePtr stream) {
     int choice, count_z = 0;
-    choice = rand() % count;
+    check_stream(viRngUniform(VSL_RNG_METHOD_UNIFORM_STD, stream, 1, &choice, 0, count));
     for (int i = 0; i < graph_size; ++i) {
         for (int j = 0; j < graph_size; ++j) {
             if (src[i * graph_size + j] == 0) {
@@ -200,10 +194,11 @@ void add_edge_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int co
  * @param dest The graph to be edited
  * @param graph_size The number of vertices in both graphs
  * @param count The number of edges to remove
+ * @param stream The random stream the edge is chosen with
  */
-void rem_edge_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int count) {
+void rem_edge_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int count, VSLStreamStatePtr stream) {
     int choice, count_o = 0;
-    choice = rand() % count;
+    check_stream(viRngUniform(VSL_RNG_METHOD_UNIFORM_STD, stream, 1, &choice, 0, count));
     for (int i = 0; i < graph_size * graph_size; ++i) {
         if (src[i] == 1) {
             if (choice == count_o) {
@@ -222,10 +217,11 @@ void rem_edge_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int coun
  * @param dest The graph to be edited
  * @param graph_size The number of vertices in both graphs
  * @param count The number of edges to remove
+ * @param stream The random stream the edge is chosen with
  */
-void rem_edge_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int count) {
+void rem_edge_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int count, VSLStreamStatePtr stream) {
     int choice, count_0 = 0;
-    choice = rand() % count;
+    check_stream(viRngUniform(VSL_RNG_METHOD_UNIFORM_STD, stream, 1, &choice, 0, count));
     for (int i = 0; i < graph_size; ++i) {
         for (int j = 0; j < graph_size; ++j) {
             if (src[i * graph_size + j] == 1) {
@@ -264,12 +260,13 @@ void deform_flipped(const MKL_INT *src, MKL_INT *dest, int graph_size) {
  * @param dest The graph to be edited
  * @param graph_size The number of vertices in both graphs
  * @param n The number of edges to add
+ * @param stream The random stream the edges are chosen with
  */
-void deform_add_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int n) {
+void deform_add_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int n, VSLStreamStatePtr stream) {
     int count;
     for (int i = 0; i < n; ++i) {
         count = count_0(src, graph_size);
-        add_edge_direct(src, dest, graph_size, count);
+        add_edge_direct(src, dest, graph_size, count, stream);
     }
 }
 
@@ -279,12 +276,13 @@ void deform_add_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int n)
  * @param dest The graph to be edited
  * @param graph_size The number of vertices in both graphs
  * @param n The number of edges to add
+ * @param stream The random stream the edges are chosen with
  */
-void deform_add_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int n) {
+void deform_add_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int n, VSLStreamStatePtr stream) {
     int count;
     for (int i = 0; i < n; ++i) {
         count = count_0(src, graph_size) / 2;
-        add_edge_undirect(src, dest, graph_size, count);
+        add_edge_undirect(src, dest, graph_size, count, stream);
     }
 }
 
@@ -294,12 +292,13 @@ void deform_add_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int
  * @param dest The graph to be edited
  * @param graph_size The number of vertices in both graphs
  * @param n The number of edges to remove
+ * @param stream The random stream the edges are chosen with
  */
-void deform_rem_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int n) {
+void deform_rem_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int n, VSLStreamStatePtr stream) {
     int count;
     for (int i = 0; i < n; ++i) {
         count = count_1(src, graph_size);
-        rem_edge_direct(src, dest, graph_size, count);
+        rem_edge_direct(src, dest, graph_size, count, stream);
     }
 }
 
@@ -310,12 +309,13 @@ void deform_rem_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int n)
  * @param dest The graph to be edited
  * @param graph_size The number of vertices in both graphs
  * @param n The number of edges to remove
+ * @param stream The random stream the edges are chosen with
  */
-void deform_rem_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int n) {
+void deform_rem_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int n, VSLStreamStatePtr stream) {
     int count;
     for (int i = 0; i < n; ++i) {
         count = count_1(src, graph_size) / 2;
-        rem_edge_undirect(src, dest, graph_size, count);
+        rem_edge_undirect(src, dest, graph_size, count, stream);
     }
 }
 
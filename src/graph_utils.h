@@ -12,17 +12,17 @@
 
 void print_graph(cost_data_t *cost_data, FILE *out);
 
-void generate_graph(MKL_INT *graph1, int graph_size, float prob);
+void generate_graph(MKL_INT *graph1, int graph_size, float prob, VSLStreamStatePtr stream);
 
 void copy_graph(const MKL_INT *src, MKL_INT *dest, int graph_size);
 
-void generate_random(MKL_INT *graph, int graph_size, float prob);
-void generate_undirected(MKL_INT *graph1, int graph_size, float prob);
+void generate_random(MKL_INT *graph, int graph_size, float prob, VSLStreamStatePtr stream);
+void generate_undirected(MKL_INT *graph1, int graph_size, float prob, VSLStreamStatePtr stream);
 
 void deform_flipped(const MKL_INT *src, MKL_INT *dest, int graph_size);
-void deform_add_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int n);
-void deform_add_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int n);
-void deform_rem_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int n);
-void deform_rem_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int n);
+void deform_add_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int n, VSLStreamStatePtr stream);
+void deform_add_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int n, VSLStreamStatePtr stream);
+void deform_rem_direct(const MKL_INT *src, MKL_INT *dest, int graph_size, int n, VSLStreamStatePtr stream);
+void deform_rem_undirect(const MKL_INT *src, MKL_INT *dest, int graph_size, int n, VSLStreamStatePtr stream);
 
 #endif //GRAPHSIMILARITY_GRAPHUTILS_H
\ No newline at end of file
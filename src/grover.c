@@ -0,0 +1,156 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief The Grover mixer over the feasible states of mask()
+ * @details Both passes walk the state one bitset word (64 states) at a time, the words statically divided between
+ * threads as in the other kernels. Feasibility enters as a 0/1 weight rather than a branch so the inner loops
+ * vectorise.
+ */
+
+#include <mathimf.h>
+#include "grover.h"
+#include "profiling.h"
+
+#define GROVER_WORD 64
+
+/**
+ * @brief Sums the feasible amplitudes of a state
+ * @param grover The mixer
+ * @param state The state
+ * @return sum over feasible x of state[x]
+ */
+static MKL_Complex16 feasible_sum(const grover_t *grover, const MKL_Complex16 *state) {
+    MKL_INT num_words = (grover->length + GROVER_WORD - 1) / GROVER_WORD;
+    double real = 0.0, imag = 0.0;
+#pragma omp parallel for schedule(static) reduction(+:real, imag)
+    for (MKL_INT w = 0; w < num_words; ++w) {
+        uint64_t bits = grover->feasible == NULL ? ~(uint64_t) 0 : grover->feasible[w];
+        MKL_INT start = w * GROVER_WORD;
+        int count = grover->length - start < GROVER_WORD ? (int) (grover->length - start) : GROVER_WORD;
+#pragma omp simd reduction(+:real, imag)
+        for (int j = 0; j < count; ++j) {
+            double weight = (double) ((bits >> j) & 1);
+            real += weight * state[start + j].real;
+            imag += weight * state[start + j].imag;
+        }
+    }
+    return (MKL_Complex16) {real, imag};
+}
+
+/**
+ * @brief Writes, or adds, a value to every feasible amplitude
+ * @param grover The mixer
+ * @param value The value
+ * @param state The state, set to value on the feasible states and zero elsewhere or, when accumulating, incremented
+ * by value on the feasible states only
+ * @param accumulate Whether to add to the state rather than overwrite it
+ */
+static void feasible_fill(const grover_t *grover, MKL_Complex16 value, MKL_Complex16 *state, bool accumulate) {
+    MKL_INT num_words = (grover->length + GROVER_WORD - 1) / GROVER_WORD;
+#pragma omp parallel for schedule(static)
+    for (MKL_INT w = 0; w < num_words; ++w) {
+        uint64_t bits = grover->feasible == NULL ? ~(uint64_t) 0 : grover->feasible[w];
+        MKL_INT start = w * GROVER_WORD;
+        int count = grover->length - start < GROVER_WORD ? (int) (grover->length - start) : GROVER_WORD;
+#pragma omp simd
+        for (int j = 0; j < count; ++j) {
+            double weight = (double) ((bits >> j) & 1);
+            state[start + j].real = (accumulate ? state[start + j].real : 0.0) + weight * value.real;
+            state[start + j].imag = (accumulate ? state[start + j].imag : 0.0) + weight * value.imag;
+        }
+    }
+}
+
+/**
+ * @brief Finds the feasible states of a problem
+ * @details Evaluates mask() once per state, a word of the bitset per iteration so no two threads share a word. Exits
+ * with an error message if no state is feasible.
+ * @param meta_spec Contains the state-space (the symmetric half-space when run_spec->symmetric) and the cost data
+ * @param mask Returns true for a feasible state
+ * @return The mixer, to be released with grover_destroy()
+ */
+grover_t *grover_create(qaoa_data_t *meta_spec, bool (*mask)(MKL_INT, cost_data_t *cost_data)) {
+    MKL_INT length = meta_spec->machine_spec->space_dimension;
+    MKL_INT num_words = (length + GROVER_WORD - 1) / GROVER_WORD;
+    MKL_INT num_feasible = 0;
+    grover_t *grover = mkl_malloc(sizeof(grover_t), DEF_ALIGNMENT);
+    check_alloc(grover);
+    grover->length = length;
+    grover->feasible = mkl_malloc(num_words * sizeof(uint64_t), DEF_ALIGNMENT);
+    check_alloc(grover->feasible);
+
+#pragma omp parallel for schedule(static) reduction(+:num_feasible)
+    for (MKL_INT w = 0; w < num_words; ++w) {
+        uint64_t bits = 0;
+        MKL_INT start = w * GROVER_WORD;
+        int count = length - start < GROVER_WORD ? (int) (length - start) : GROVER_WORD;
+        for (int j = 0; j < count; ++j) {
+            if (mask(start + j, meta_spec->cost_data)) {
+                bits |= (uint64_t) 1 << j;
+                num_feasible++;
+            }
+        }
+        grover->feasible[w] = bits;
+    }
+
+    if (num_feasible == 0) {
+        fprintf(stderr, "The Grover mixer needs at least one feasible state.\n");
+        exit(EXIT_FAILURE);
+    }
+    grover->num_feasible = num_feasible;
+    if (num_feasible == length) {
+        mkl_free(grover->feasible);
+        grover->feasible = NULL;
+    }
+    return grover;
+}
+
+/**
+ * @brief Initialises a state to the uniform superposition of the feasible states, |F>
+ * @param grover The mixer
+ * @param state The state, overwritten
+ */
+void grover_initialise(const grover_t *grover, MKL_Complex16 *state) {
+    feasible_fill(grover, (MKL_Complex16) {1.0 / sqrt((double) grover->num_feasible), 0.0}, state, false);
+}
+
+/**
+ * @brief Applies exp(-i beta |F><F|) = I + (exp(-i beta) - 1)|F><F| to a state
+ * @param grover The mixer
+ * @param beta The mixing angle (negative to invert)
+ * @param state The state, updated in place
+ */
+void grover_expm(const grover_t *grover, double beta, MKL_Complex16 *state) {
+    PROFILE_BEGIN(profile_mark);
+    MKL_Complex16 sum = feasible_sum(grover, state);
+    double c = (cos(beta) - 1.0) / (double) grover->num_feasible;
+    double s = sin(beta) / (double) grover->num_feasible;
+    feasible_fill(grover, (MKL_Complex16) {c * sum.real + s * sum.imag, c * sum.imag - s * sum.real}, state, true);
+    PROFILE_END(PROFILE_MIXER, profile_mark, 3LL * grover->length * (long long) sizeof(MKL_Complex16), 0);
+}
+
+/**
+ * @brief Computes -i |F><F| state, the generator of the Grover mixer, matching spmatrix_product_x_mv()
+ * @param grover The mixer
+ * @param state The input vector
+ * @param output The output vector (distinct from state)
+ */
+void grover_mv(const grover_t *grover, const MKL_Complex16 *state, MKL_Complex16 *output) {
+    PROFILE_BEGIN(profile_mark);
+    MKL_Complex16 sum = feasible_sum(grover, state);
+    double scale = 1.0 / (double) grover->num_feasible;
+    feasible_fill(grover, (MKL_Complex16) {scale * sum.imag, -scale * sum.real}, output, false);
+    PROFILE_END(PROFILE_SPMV, profile_mark, 2LL * grover->length * (long long) sizeof(MKL_Complex16), 0);
+}
+
+/**
+ * @brief Releases a Grover mixer
+ * @param grover The mixer (may be NULL)
+ */
+void grover_destroy(grover_t *grover) {
+    if (grover == NULL) {
+        return;
+    }
+    mkl_free(grover->feasible);
+    mkl_free(grover);
+}
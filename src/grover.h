@@ -0,0 +1,37 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief The Grover mixer, exp(-i beta |F><F|) for the uniform superposition |F> of the feasible states
+ * @details The driver |F><F| is rank one, so exp(-i beta |F><F|) = I + (exp(-i beta) - 1)|F><F| for any beta: one
+ * reduction over the feasible amplitudes and one update of them, two passes over the state whatever the constraints.
+ * The feasible states are those accepted by mask(), held as a bitset of one bit per state (omitted when every state
+ * is feasible). The evolution starts from |F>, the mixer's eigenstate, rather than the uniform superposition over
+ * every state.
+ *
+ * Selected by run_spec->mixer = MIXER_GROVER in the standard and restricted QAOA.
+ */
+
+#ifndef QOLAB_GROVER_H
+#define QOLAB_GROVER_H
+
+#include <stdint.h>
+#include "globals.h"
+
+/*! The feasible set of a Grover mixer */
+typedef struct grover_mixer {
+    MKL_INT length;         /**< The number of states */
+    MKL_INT num_feasible;   /**< The number of feasible states |F| */
+    uint64_t *feasible;     /**< Bit x % 64 of word x / 64 is set for feasible x (NULL when every state is) */
+} grover_t;
+
+grover_t *grover_create(qaoa_data_t *meta_spec, bool (*mask)(MKL_INT, cost_data_t *cost_data));
+
+void grover_initialise(const grover_t *grover, MKL_Complex16 *state);
+
+void grover_expm(const grover_t *grover, double beta, MKL_Complex16 *state);
+
+void grover_mv(const grover_t *grover, const MKL_Complex16 *state, MKL_Complex16 *output);
+
+void grover_destroy(grover_t *grover);
+
+#endif //QOLAB_GROVER_H
@@ -0,0 +1,431 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Optimises many small same-size instances together, one SIMD lane per evaluation
+ * @details Lane k * points_per_instance + p of a group evaluates the p-th point asked for by the instance in the
+ * group's k-th slot. The lane count is padded to a whole number of vectors; padding lanes are simulated but never
+ * read.
+ */
+
+#include <string.h>
+#include <limits.h>
+#include <mathimf.h>
+#include <omp.h>
+#include "instance_batch.h"
+#include "optimisers.h"
+#include "qaoa.h"
+
+/*! The interleaved working set of one group of instances */
+typedef struct {
+    int stride;         /**< The number of lanes allocated per amplitude */
+    int lanes;          /**< The number of lanes in use, padded to whole vectors (at most stride) */
+    MKL_INT dimension;  /**< The number of amplitudes of each lane */
+    double *cost;       /**< The cost of each amplitude in each lane (dimension * lanes) */
+    double *real;       /**< The real part of the state (dimension * lanes) */
+    double *imag;       /**< The imaginary part of the state (dimension * lanes) */
+    double *gamma;      /**< The phase angle of every layer in each lane (P * lanes) */
+    double *beta;       /**< The mixing angle of every layer in each lane (P * lanes) */
+    double *cosine;     /**< cos(beta) of the current layer in each lane */
+    double *sine;       /**< sin(beta) of the current layer in each lane */
+    double *values;     /**< The expectation value of each lane */
+} lane_group_t;
+
+/**
+ * @brief Applies exp(-i gamma C) to every lane
+ * @param group The group's working set
+ * @param gamma The angle of each lane
+ */
+static void lanes_phase(lane_group_t *group, const double *gamma) {
+    int lanes = group->lanes;
+    for (MKL_INT i = 0; i < group->dimension; ++i) {
+        double *re = group->real + i * group->stride;
+        double *im = group->imag + i * group->stride;
+        const double *cost = group->cost + i * group->stride;
+#pragma omp simd
+        for (int l = 0; l < lanes; ++l) {
+            double theta = gamma[l] * cost[l];
+            double c = cos(theta);
+            double s = sin(theta);
+            double x = re[l];
+            double y = im[l];
+            re[l] = c * x + s * y;
+            im[l] = c * y - s * x;
+        }
+    }
+}
+
+/**
+ * @brief Rotates two rows of amplitudes, paired lane by lane, by exp(-i beta X)
+ * @param group The group's working set, holding cos(beta) and sin(beta) of each lane
+ * @param a The row with the qubit clear
+ * @param b The row with the qubit set
+ */
+static void lanes_rotate(lane_group_t *group, MKL_INT a, MKL_INT b) {
+    int lanes = group->lanes;
+    double *re_a = group->real + a * group->stride, *im_a = group->imag + a * group->stride;
+    double *re_b = group->real + b * group->stride, *im_b = group->imag + b * group->stride;
+    const double *c = group->cosine, *s = group->sine;
+#pragma omp simd
+    for (int l = 0; l < lanes; ++l) {
+        double xr = re_a[l], xi = im_a[l];
+        double yr = re_b[l], yi = im_b[l];
+        re_a[l] = c[l] * xr + s[l] * yi;
+        im_a[l] = c[l] * xi - s[l] * yr;
+        re_b[l] = c[l] * yr + s[l] * xi;
+        im_b[l] = c[l] * yi - s[l] * xr;
+    }
+}
+
+/**
+ * @brief Applies exp(-i beta B) for the transverse-field driver to every lane
+ * @details As spmatrix_expm_product_x(): qubits whose pairs fall within a block of INSTANCE_BATCH_BLOCK rows are
+ * applied while the block is resident, the remaining qubits take a pass each.
+ * @param group The group's working set
+ * @param beta The angle of each lane
+ * @param num_qubits The number of qubits
+ */
+static void lanes_mixer(lane_group_t *group, const double *beta, int num_qubits) {
+    MKL_INT block = INSTANCE_BATCH_BLOCK < group->dimension ? INSTANCE_BATCH_BLOCK : group->dimension;
+    int resident = 0;
+    while (((MKL_INT) 1 << resident) < block) {
+        resident++;
+    }
+    for (int l = 0; l < group->lanes; ++l) {
+        group->cosine[l] = cos(beta[l]);
+        group->sine[l] = sin(beta[l]);
+    }
+    for (MKL_INT start = 0; start < group->dimension; start += block) {
+        for (int j = 0; j < resident; ++j) {
+            MKL_INT stride = (MKL_INT) 1 << j;
+            for (MKL_INT base = start; base < start + block; base += 2 * stride) {
+                for (MKL_INT r = base; r < base + stride; ++r) {
+                    lanes_rotate(group, r, r + stride);
+                }
+            }
+        }
+    }
+    for (int j = resident; j < num_qubits; ++j) {
+        MKL_INT stride = (MKL_INT) 1 << j;
+        for (MKL_INT base = 0; base < group->dimension; base += 2 * stride) {
+            for (MKL_INT r = base; r < base + stride; ++r) {
+                lanes_rotate(group, r, r + stride);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Evaluates the expectation value of every lane's schedule
+ * @param group The group's working set, with the angles of every layer filled in
+ * @param P The number of layers
+ * @param num_qubits The number of qubits
+ */
+static void lanes_evaluate(lane_group_t *group, int P, int num_qubits) {
+    int lanes = group->lanes;
+    MKL_INT size = group->dimension * group->stride;
+    double amplitude = 1.0 / sqrt((double) group->dimension);
+    for (MKL_INT i = 0; i < size; ++i) {
+        group->real[i] = amplitude;
+        group->imag[i] = 0.0;
+    }
+    for (int layer = 0; layer < P; ++layer) {
+        lanes_phase(group, group->gamma + layer * group->stride);
+        lanes_mixer(group, group->beta + layer * group->stride, num_qubits);
+    }
+    memset(group->values, 0, lanes * sizeof(double));
+    for (MKL_INT i = 0; i < group->dimension; ++i) {
+        MKL_INT row = i * group->stride;
+        const double *re = group->real + row, *im = group->imag + row, *cost = group->cost + row;
+        double *values = group->values;
+#pragma omp simd
+        for (int l = 0; l < lanes; ++l) {
+            values[l] += cost[l] * (re[l] * re[l] + im[l] * im[l]);
+        }
+    }
+}
+
+/**
+ * @brief Checks the specification against what the engine supports and builds the shared optimisation state
+ * @details The initial point (the opt_spec parameters if retained, otherwise the usual default) and
+ * the bounds are set up by optimiser_Initialize() and shared by every instance.
+ * @param batch The batch to be created
+ * @param mach_spec The machine specification shared by all instances
+ * @param instances The instances, each over mach_spec->num_qubits vertices (read concurrently by Cx() and mask())
+ * @param num_instances The number of instances
+ * @param opt_spec The optimisation specification, which must select a built-in optimiser and no parameter store
+ * @param run_spec The run specification, which must select the exact unrestricted expectation value
+ * @param retain If set, the parameters in opt_spec are the initial point
+ */
+void instance_batch_create(instance_batch_t *batch, machine_spec_t *mach_spec, cost_data_t *instances,
+                           int num_instances, optimization_spec_t *opt_spec, run_spec_t *run_spec, bool retain) {
+    if (num_instances <= 0) {
+        fprintf(stderr, "An instance batch needs at least one instance.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->restricted || run_spec->sampling || run_spec->objective != OBJECTIVE_EXPECTATION ||
+        run_spec->symmetric || run_spec->lightcone ||
+        (run_spec->mixer != MIXER_CHEBYSHEV && run_spec->mixer != MIXER_PRODUCT)) {
+        fprintf(stderr, "Instance batches support the exact expectation of the unrestricted, full-state QAOA with the "
+                        "transverse-field mixer only.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opt_spec->optimiser_type == OPTIMISER_NLOPT) {
+        fprintf(stderr, "Instance batches need a built-in optimiser (spsa, adam or cmaes).\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opt_spec->store_path != NULL) {
+        //Seeding from the store evaluates the objective, which needs a single instance's UC
+        fprintf(stderr, "Instance batches cannot seed from or record to a parameter store.\n");
+        exit(EXIT_FAILURE);
+    }
+    batch->meta_spec.machine_spec = mach_spec;
+    batch->meta_spec.run_spec = run_spec;
+    batch->meta_spec.opt_spec = opt_spec;
+    batch->meta_spec.cost_data = instances;
+    batch->meta_spec.qaoa_statistics = NULL;
+    batch->meta_spec.start_statistics = NULL;
+    batch->meta_spec.trace = NULL;
+    batch->meta_spec.lightcone = NULL;
+    batch->meta_spec.grover = NULL;
+    batch->meta_spec.spectral = NULL;
+    batch->meta_spec.state_cache = NULL;
+    batch->meta_spec.stream = NULL;
+    batch->meta_spec.profile = NULL;
+    batch->meta_spec.workspace = NULL;
+    batch->meta_spec.batch_lock = NULL;
+    batch->meta_spec.uc = NULL;
+    batch->meta_spec.ub = NULL;
+    optimiser_Initialize(&batch->meta_spec, retain);
+
+    batch->instances = instances;
+    batch->num_instances = num_instances;
+    batch->group_size = INSTANCE_BATCH_GROUP;
+    batch->seed = (MKL_UINT) (run_spec->seed != 0 ? run_spec->seed : (unsigned) time(0));
+    batch->num_params = parameter_count(&batch->meta_spec);
+    batch->value = mkl_malloc(num_instances * sizeof(double), DEF_ALIGNMENT);
+    batch->parameters = mkl_malloc((size_t) num_instances * batch->num_params * sizeof(double), DEF_ALIGNMENT);
+    batch->max_value = mkl_malloc(num_instances * sizeof(int), DEF_ALIGNMENT);
+    batch->num_evals = mkl_calloc((size_t) num_instances, sizeof(int), DEF_ALIGNMENT);
+    batch->status = mkl_malloc(num_instances * sizeof(nlopt_result), DEF_ALIGNMENT);
+    check_alloc(batch->value);
+    check_alloc(batch->parameters);
+    check_alloc(batch->max_value);
+    check_alloc(batch->num_evals);
+    check_alloc(batch->status);
+    //The batch size of the optimiser type, which is fixed at creation
+    native_optimiser_t probe;
+    native_optimiser_create(&probe, opt_spec, batch->num_params, false, 0);
+    batch->points_per_instance = probe.batch_size;
+    native_optimiser_destroy(&probe);
+    batch->seconds = 0.0;
+}
+
+/**
+ * @brief Moves the lanes of one slot of a group into another
+ * @param group The group's working set
+ * @param points The number of lanes per slot
+ * @param from The slot moved
+ * @param to The slot overwritten
+ */
+static void lanes_move(lane_group_t *group, int points, int from, int to) {
+    for (MKL_INT i = 0; i < group->dimension; ++i) {
+        memcpy(group->cost + i * group->stride + to * points, group->cost + i * group->stride + from * points,
+               points * sizeof(double));
+    }
+}
+
+/**
+ * @brief Optimises one group of instances to completion
+ * @details Instance slot k owns lanes k * points to (k + 1) * points - 1. When an instance converges the last active
+ * slot moves into its place, so only the active lanes are simulated.
+ * @param batch The batch
+ * @param first The first instance of the group
+ * @param count The number of instances in the group
+ */
+static void instance_batch_group(instance_batch_t *batch, int first, int count) {
+    machine_spec_t *mach_spec = batch->meta_spec.machine_spec;
+    optimization_spec_t *opt_spec = batch->meta_spec.opt_spec;
+    int P = mach_spec->P;
+    int n = batch->num_params;
+    int points = batch->points_per_instance;
+    int active = count;
+    lane_group_t group;
+    group.stride = (count * points + INSTANCE_BATCH_LANES - 1) / INSTANCE_BATCH_LANES * INSTANCE_BATCH_LANES;
+    group.lanes = group.stride;
+    group.dimension = mach_spec->space_dimension;
+    size_t size = (size_t) group.dimension * group.stride;
+    group.cost = mkl_calloc(size, sizeof(double), DEF_ALIGNMENT);
+    group.real = mkl_malloc(size * sizeof(double), DEF_ALIGNMENT);
+    group.imag = mkl_malloc(size * sizeof(double), DEF_ALIGNMENT);
+    group.gamma = mkl_calloc((size_t) P * group.stride, sizeof(double), DEF_ALIGNMENT);
+    group.beta = mkl_calloc((size_t) P * group.stride, sizeof(double), DEF_ALIGNMENT);
+    group.cosine = mkl_malloc(group.stride * sizeof(double), DEF_ALIGNMENT);
+    group.sine = mkl_malloc(group.stride * sizeof(double), DEF_ALIGNMENT);
+    group.values = mkl_malloc(group.stride * sizeof(double), DEF_ALIGNMENT);
+    double *angles = mkl_malloc(2 * P * sizeof(double), DEF_ALIGNMENT);
+    native_optimiser_t *optimisers = mkl_malloc(count * sizeof(native_optimiser_t), DEF_ALIGNMENT);
+    int *slot = mkl_malloc(count * sizeof(int), DEF_ALIGNMENT);
+    check_alloc(group.cost);
+    check_alloc(group.real);
+    check_alloc(group.imag);
+    check_alloc(group.gamma);
+    check_alloc(group.beta);
+    check_alloc(group.cosine);
+    check_alloc(group.sine);
+    check_alloc(group.values);
+    check_alloc(angles);
+    check_alloc(optimisers);
+    check_alloc(slot);
+
+    for (int k = 0; k < count; ++k) {
+        cost_data_t *instance = &batch->instances[first + k];
+        int max_value = INT_MIN;
+        for (MKL_INT i = 0; i < group.dimension; ++i) {
+            int current = Cx(i, mach_spec->num_qubits, instance);
+            if (current > max_value && mask(i, instance)) {
+                max_value = current;
+            }
+            for (int p = 0; p < points; ++p) {
+                group.cost[i * group.stride + k * points + p] = current;
+            }
+        }
+        batch->max_value[first + k] = max_value;
+        batch->value[first + k] = -INFINITY;
+        batch->status[first + k] = NLOPT_MAXEVAL_REACHED;
+        native_optimiser_create(&optimisers[k], opt_spec, n, false, batch->seed + (MKL_UINT) (first + k));
+        cblas_dcopy(n, opt_spec->parameters, 1, optimisers[k].mean, 1);
+        cblas_dcopy(n, opt_spec->parameters, 1, batch->parameters + (size_t) (first + k) * n, 1);
+        slot[k] = k;
+    }
+
+    for (int evals = 0; active > 0 && evals + points <= opt_spec->max_evals; evals += points) {
+        group.lanes = (active * points + INSTANCE_BATCH_LANES - 1) / INSTANCE_BATCH_LANES * INSTANCE_BATCH_LANES;
+        for (int k = 0; k < active; ++k) {
+            native_optimiser_t *optimiser = &optimisers[slot[k]];
+            native_optimiser_ask(optimiser);
+            for (int p = 0; p < points; ++p) {
+                const double *x = optimiser->points + p * n;
+                int lane = k * points + p;
+                if (opt_spec->strategy == STRATEGY_FOURIER) {
+                    fourier_expand(P, n / 2, false, x, angles);
+                    x = angles;
+                }
+                for (int layer = 0; layer < P; ++layer) {
+                    group.gamma[layer * group.stride + lane] = x[layer];
+                    group.beta[layer * group.stride + lane] = x[layer + P];
+                }
+            }
+        }
+        lanes_evaluate(&group, P, mach_spec->num_qubits);
+        for (int k = 0; k < active; ++k) {
+            int instance = first + slot[k];
+            native_optimiser_t *optimiser = &optimisers[slot[k]];
+            for (int p = 0; p < points; ++p) {
+                double value = group.values[k * points + p];
+                optimiser->values[p] = value;
+                if (value > batch->value[instance]) {
+                    batch->value[instance] = value;
+                    cblas_dcopy(n, optimiser->points + p * n, 1, batch->parameters + (size_t) instance * n, 1);
+                }
+            }
+            batch->num_evals[instance] += points;
+            native_optimiser_tell(optimiser);
+            if (optimiser->step_norm < opt_spec->xtol) {
+                batch->status[instance] = NLOPT_XTOL_REACHED;
+                group.values[k * points] = NAN;
+            }
+        }
+        //Compact the active slots, keeping their relative order
+        int kept = 0;
+        for (int k = 0; k < active; ++k) {
+            if (isnan(group.values[k * points])) {
+                continue;
+            }
+            if (kept != k) {
+                lanes_move(&group, points, k, kept);
+                slot[kept] = slot[k];
+            }
+            kept++;
+        }
+        active = kept;
+    }
+
+    for (int k = 0; k < count; ++k) {
+        native_optimiser_destroy(&optimisers[k]);
+    }
+    mkl_free(slot);
+    mkl_free(optimisers);
+    mkl_free(angles);
+    mkl_free(group.values);
+    mkl_free(group.sine);
+    mkl_free(group.cosine);
+    mkl_free(group.beta);
+    mkl_free(group.gamma);
+    mkl_free(group.imag);
+    mkl_free(group.real);
+    mkl_free(group.cost);
+}
+
+/**
+ * @brief Optimises every instance of the batch
+ * @details Groups of group_size instances are handed out dynamically to the threads; each group is simulated and
+ * optimised by one thread (with MKL single-threaded inside it).
+ * @param batch The batch, whose per-instance results are filled in
+ */
+void instance_batch_optimise(instance_batch_t *batch) {
+    int num_groups = (batch->num_instances + batch->group_size - 1) / batch->group_size;
+    double start = dsecnd();
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int g = 0; g < num_groups; ++g) {
+        int first = g * batch->group_size;
+        int count = batch->num_instances - first < batch->group_size ? batch->num_instances - first
+                                                                      : batch->group_size;
+        int previous = mkl_set_num_threads_local(1);
+        instance_batch_group(batch, first, count);
+        mkl_set_num_threads_local(previous);
+    }
+    batch->seconds = dsecnd() - start;
+}
+
+/**
+ * @brief Reports the throughput of the batch and the mean quality of its results
+ * @param batch The optimised batch
+ * @param out The stream to report to
+ */
+void instance_batch_report(instance_batch_t *batch, FILE *out) {
+    long long evals = 0;
+    double ratio = 0.0, value = 0.0;
+    int rated = 0;
+    for (int k = 0; k < batch->num_instances; ++k) {
+        evals += batch->num_evals[k];
+        value += batch->value[k];
+        if (batch->max_value[k] > 0) {
+            ratio += batch->value[k] / batch->max_value[k];
+            rated++;
+        }
+    }
+    fprintf(out, "%d Instances\n", batch->num_instances);
+    fprintf(out, "%d Instances per group\n", batch->group_size);
+    fprintf(out, "%d Lanes per group\n", batch->group_size * batch->points_per_instance);
+    fprintf(out, "%lld Evaluations\n", evals);
+    fprintf(out, "%f Batch time\n", batch->seconds);
+    fprintf(out, "%f Instances per second\n", batch->num_instances / batch->seconds);
+    fprintf(out, "%f Evaluations per second\n", evals / batch->seconds);
+    fprintf(out, "%f Mean best expectation\n", value / batch->num_instances);
+    if (rated > 0) {
+        fprintf(out, "%f Mean approximation ratio\n", ratio / rated);
+    }
+}
+
+/**
+ * @brief De-allocates the results and shared optimisation state of a batch
+ * @param batch The batch
+ */
+void instance_batch_destroy(instance_batch_t *batch) {
+    qaoa_teardown(&batch->meta_spec);
+    mkl_free(batch->status);
+    mkl_free(batch->num_evals);
+    mkl_free(batch->max_value);
+    mkl_free(batch->parameters);
+    mkl_free(batch->value);
+}
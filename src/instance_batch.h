@@ -0,0 +1,51 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Optimises many small same-size instances together, one SIMD lane per evaluation
+ * @details Instances are simulated in groups. The amplitudes of every evaluation in a group are interleaved (amplitude
+ * i of lane l at i * lanes + l, real and imaginary parts in separate arrays) so the phase, mixer and measurement
+ * kernels run one vector instruction across the whole group. Each instance keeps its own built-in optimiser, which
+ * fills points_per_instance lanes every iteration. Groups are independent and spread over the threads, each thread
+ * running single-threaded kernels. This removes the per-instance UB construction, eigen-solve and allocation of
+ * qaoa().
+ *
+ * Only the exact expectation value of the unrestricted QAOA is supported, with the exact product mixer (the same
+ * operator the Chebyshev engine approximates) and the SPSA, Adam (on SPSA estimates) and CMA-ES optimisers.
+ */
+
+#ifndef QOLAB_INSTANCE_BATCH_H
+#define QOLAB_INSTANCE_BATCH_H
+
+#include "globals.h"
+
+#define INSTANCE_BATCH_LANES 8
+#define INSTANCE_BATCH_GROUP 8
+#define INSTANCE_BATCH_BLOCK 256
+
+/*! A set of instances optimised together, and the result of each */
+typedef struct {
+    qaoa_data_t meta_spec;      /**< The shared specification (its cost data is the first instance) */
+    cost_data_t *instances;     /**< The instances, all on machine_spec->num_qubits vertices */
+    int num_instances;          /**< The number of instances */
+    int group_size;             /**< The number of instances simulated together */
+    int num_params;             /**< The number of parameters of every instance */
+    int points_per_instance;    /**< The number of points each optimiser asks for per iteration */
+    MKL_UINT seed;              /**< Instance k's optimiser is seeded with seed + k (run_spec->seed, or the clock) */
+    double *value;              /**< The best value found for each instance */
+    double *parameters;         /**< The best parameters of each instance (num_instances * num_params) */
+    int *max_value;             /**< The maximum of each instance's cost function */
+    int *num_evals;             /**< The evaluations spent on each instance */
+    nlopt_result *status;       /**< Why each instance's optimiser stopped */
+    double seconds;             /**< The wall time of instance_batch_optimise() */
+} instance_batch_t;
+
+void instance_batch_create(instance_batch_t *batch, machine_spec_t *mach_spec, cost_data_t *instances,
+                           int num_instances, optimization_spec_t *opt_spec, run_spec_t *run_spec, bool retain);
+
+void instance_batch_optimise(instance_batch_t *batch);
+
+void instance_batch_report(instance_batch_t *batch, FILE *out);
+
+void instance_batch_destroy(instance_batch_t *batch);
+
+#endif //QOLAB_INSTANCE_BATCH_H
@@ -0,0 +1,310 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Cost functions given as a weighted sum of Pauli-Z strings, applied without a stored cost vector
+ * @details Every kernel splits the state-space into blocks of ISING_BLOCK states shared statically between the
+ * threads, as the other kernels do, and evaluates the block's costs term by term into a buffer on the thread's stack.
+ * The parity of x & mask is folded with shifts and exclusive ors so the inner loop vectorises.
+ */
+
+#include <string.h>
+#include <mathimf.h>
+#include "ising.h"
+#include "profiling.h"
+
+#define ISING_LINE_LENGTH 4096
+
+/**
+ * @brief Creates an empty Hamiltonian (C(x) = 0)
+ * @return The Hamiltonian, to be released with ising_destroy()
+ */
+ising_t *ising_create(void) {
+    ising_t *hamiltonian = mkl_malloc(sizeof(ising_t), DEF_ALIGNMENT);
+    check_alloc(hamiltonian);
+    hamiltonian->offset = 0.0;
+    hamiltonian->num_terms = 0;
+    hamiltonian->capacity = 16;
+    hamiltonian->terms = mkl_malloc(hamiltonian->capacity * sizeof(ising_term_t), DEF_ALIGNMENT);
+    check_alloc(hamiltonian->terms);
+    return hamiltonian;
+}
+
+/**
+ * @brief Adds a weighted Z string to a Hamiltonian
+ * @details A string already present has its weight increased; the empty string (mask 0) adds to the offset.
+ * @param hamiltonian The Hamiltonian
+ * @param weight The coefficient
+ * @param mask The qubits the string acts on
+ */
+void ising_add(ising_t *hamiltonian, double weight, uint64_t mask) {
+    if (mask == 0) {
+        hamiltonian->offset += weight;
+        return;
+    }
+    for (int k = 0; k < hamiltonian->num_terms; ++k) {
+        if (hamiltonian->terms[k].mask == mask) {
+            hamiltonian->terms[k].weight += weight;
+            return;
+        }
+    }
+    if (hamiltonian->num_terms == hamiltonian->capacity) {
+        hamiltonian->capacity *= 2;
+        hamiltonian->terms = mkl_realloc(hamiltonian->terms, hamiltonian->capacity * sizeof(ising_term_t));
+        check_alloc(hamiltonian->terms);
+    }
+    hamiltonian->terms[hamiltonian->num_terms].mask = mask;
+    hamiltonian->terms[hamiltonian->num_terms].weight = weight;
+    hamiltonian->num_terms++;
+}
+
+/**
+ * @brief Builds the weighted MaxCut cost of a graph, sum over edges of w_ab (1 - Z_a Z_b) / 2
+ * @param graph The num_vertices * num_vertices adjacency matrix (only the upper triangle is read)
+ * @param num_vertices The number of vertices, at most 64
+ * @return The Hamiltonian, to be released with ising_destroy()
+ */
+ising_t *ising_maxcut(const MKL_INT *graph, int num_vertices) {
+    ising_t *hamiltonian = ising_create();
+    for (int a = 0; a < num_vertices; ++a) {
+        for (int b = a + 1; b < num_vertices; ++b) {
+            MKL_INT weight = graph[(MKL_INT) a * num_vertices + b];
+            if (weight != 0) {
+                ising_add(hamiltonian, 0.5 * (double) weight, 0);
+                ising_add(hamiltonian, -0.5 * (double) weight, ((uint64_t) 1 << a) | ((uint64_t) 1 << b));
+            }
+        }
+    }
+    return hamiltonian;
+}
+
+/**
+ * @brief Reads a Hamiltonian from a text file
+ * @details Each line holds a weight followed by the qubits of its Z string, e.g. "-0.5 0 3" for -0.5 Z_0 Z_3; a
+ * weight alone is a constant. Blank lines and anything after a '#' are ignored. A qubit listed twice cancels (Z Z = I).
+ * Exits with an error message if the file cannot be read.
+ * @param path The file
+ * @return The Hamiltonian, to be released with ising_destroy()
+ */
+ising_t *ising_read(const char *path) {
+    char line[ISING_LINE_LENGTH];
+    int line_number = 0;
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror("Attempting to open Hamiltonian file");
+        exit(EXIT_FAILURE);
+    }
+    ising_t *hamiltonian = ising_create();
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char *comment = strchr(line, '#');
+        char *token, *end;
+        double weight;
+        uint64_t mask = 0;
+        line_number++;
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+        token = strtok(line, " \t\r\n");
+        if (token == NULL) {
+            continue;
+        }
+        weight = strtod(token, &end);
+        if (*end != '\0') {
+            fprintf(stderr, "%s:%d: invalid weight '%s'.\n", path, line_number, token);
+            exit(EXIT_FAILURE);
+        }
+        while ((token = strtok(NULL, " \t\r\n")) != NULL) {
+            long qubit = strtol(token, &end, 10);
+            if (*end != '\0' || qubit < 0 || qubit > 63) {
+                fprintf(stderr, "%s:%d: invalid qubit '%s'.\n", path, line_number, token);
+                exit(EXIT_FAILURE);
+            }
+            mask ^= (uint64_t) 1 << qubit;
+        }
+        ising_add(hamiltonian, weight, mask);
+    }
+    fclose(file);
+    return hamiltonian;
+}
+
+/**
+ * @brief Checks that every string of a Hamiltonian acts within the machine, exits with an error message otherwise
+ * @param hamiltonian The Hamiltonian
+ * @param num_qubits The number of qubits
+ */
+void ising_check(const ising_t *hamiltonian, int num_qubits) {
+    uint64_t outside = num_qubits >= 64 ? 0 : ~(((uint64_t) 1 << num_qubits) - 1);
+    for (int k = 0; k < hamiltonian->num_terms; ++k) {
+        if (hamiltonian->terms[k].mask & outside) {
+            fprintf(stderr, "A Hamiltonian term acts beyond qubit %d.\n", num_qubits - 1);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ * @brief Evaluates the cost of a block of consecutive states
+ * @param hamiltonian The Hamiltonian
+ * @param start The first state
+ * @param length The number of states (at most ISING_BLOCK)
+ * @param cost The buffer receiving C(start + j)
+ */
+static void ising_block(const ising_t *hamiltonian, MKL_INT start, MKL_INT length, double *cost) {
+    for (MKL_INT j = 0; j < length; ++j) {
+        cost[j] = hamiltonian->offset;
+    }
+    for (int k = 0; k < hamiltonian->num_terms; ++k) {
+        uint64_t mask = hamiltonian->terms[k].mask;
+        double weight = hamiltonian->terms[k].weight;
+#pragma omp simd
+        for (MKL_INT j = 0; j < length; ++j) {
+            uint64_t bits = (uint64_t) (start + j) & mask;
+            bits ^= bits >> 32;
+            bits ^= bits >> 16;
+            bits ^= bits >> 8;
+            bits ^= bits >> 4;
+            bits ^= bits >> 2;
+            bits ^= bits >> 1;
+            cost[j] += weight - 2.0 * weight * (double) (bits & 1);
+        }
+    }
+}
+
+/**
+ * @brief Applies the phase separator exp(-i gamma C) to a state
+ * @param hamiltonian The Hamiltonian
+ * @param gamma The phase angle
+ * @param state The state, updated in place
+ * @param dimension The number of amplitudes
+ */
+void ising_phase(const ising_t *hamiltonian, double gamma, MKL_Complex16 *state, MKL_INT dimension) {
+    PROFILE_BEGIN(profile_mark);
+    MKL_INT num_blocks = (dimension + ISING_BLOCK - 1) / ISING_BLOCK;
+#pragma omp parallel for schedule(static)
+    for (MKL_INT b = 0; b < num_blocks; ++b) {
+        double cost[ISING_BLOCK];
+        MKL_INT start = b * ISING_BLOCK;
+        MKL_INT length = dimension - start < ISING_BLOCK ? dimension - start : ISING_BLOCK;
+        MKL_Complex16 *current = state + start;
+        ising_block(hamiltonian, start, length, cost);
+#pragma omp simd
+        for (MKL_INT j = 0; j < length; ++j) {
+            double c = cos(gamma * cost[j]);
+            double s = sin(gamma * cost[j]);
+            double real = current[j].real;
+            current[j].real = c * real + s * current[j].imag;
+            current[j].imag = c * current[j].imag - s * real;
+        }
+    }
+    PROFILE_END(PROFILE_PHASE, profile_mark, 2LL * dimension * (long long) sizeof(MKL_Complex16), 0);
+}
+
+/**
+ * @brief Applies the cost Hamiltonian C, or the phase generator -iC, to a state
+ * @param hamiltonian The Hamiltonian
+ * @param state The input state
+ * @param output The result (distinct from state)
+ * @param dimension The number of amplitudes
+ * @param generator Whether to apply -iC rather than C
+ */
+void ising_apply(const ising_t *hamiltonian, const MKL_Complex16 *state, MKL_Complex16 *output, MKL_INT dimension,
+                 bool generator) {
+    MKL_INT num_blocks = (dimension + ISING_BLOCK - 1) / ISING_BLOCK;
+#pragma omp parallel for schedule(static)
+    for (MKL_INT b = 0; b < num_blocks; ++b) {
+        double cost[ISING_BLOCK];
+        MKL_INT start = b * ISING_BLOCK;
+        MKL_INT length = dimension - start < ISING_BLOCK ? dimension - start : ISING_BLOCK;
+        ising_block(hamiltonian, start, length, cost);
+        for (MKL_INT j = 0; j < length; ++j) {
+            MKL_Complex16 value = state[start + j];
+            if (generator) {
+                output[start + j].real = cost[j] * value.imag;
+                output[start + j].imag = -cost[j] * value.real;
+            } else {
+                output[start + j].real = cost[j] * value.real;
+                output[start + j].imag = cost[j] * value.imag;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Computes the expectation value of the cost Hamiltonian directly from a state
+ * @param hamiltonian The Hamiltonian
+ * @param state The normalised state
+ * @param dimension The number of amplitudes
+ * @return The expectation value
+ */
+double ising_expectation(const ising_t *hamiltonian, const MKL_Complex16 *state, MKL_INT dimension) {
+    PROFILE_BEGIN(profile_mark);
+    MKL_INT num_blocks = (dimension + ISING_BLOCK - 1) / ISING_BLOCK;
+    double result = 0.0;
+#pragma omp parallel for schedule(static) reduction(+:result)
+    for (MKL_INT b = 0; b < num_blocks; ++b) {
+        double cost[ISING_BLOCK];
+        MKL_INT start = b * ISING_BLOCK;
+        MKL_INT length = dimension - start < ISING_BLOCK ? dimension - start : ISING_BLOCK;
+        ising_block(hamiltonian, start, length, cost);
+        for (MKL_INT j = 0; j < length; ++j) {
+            result += cost[j] * (state[start + j].real * state[start + j].real +
+                                 state[start + j].imag * state[start + j].imag);
+        }
+    }
+    PROFILE_END(PROFILE_MEASURE, profile_mark, dimension * (long long) sizeof(MKL_Complex16), 0);
+    return result;
+}
+
+/**
+ * @brief Finds the maximum of the cost function over the feasible states by evaluating every state (without storing
+ * the costs)
+ * @details As in generate_uc(), states rejected by mask() are skipped so the maximum, and the approximation ratios built
+ * on it, are those of the feasible solutions.
+ * @param hamiltonian The Hamiltonian
+ * @param dimension The number of states
+ * @param mask The bit-string mask of valid candidate solutions
+ * @param cost_data The problem data handed to mask()
+ * @param index Receives the first feasible state attaining the maximum (0 if there is none)
+ * @return The maximum, -INFINITY if no state is feasible
+ */
+double ising_maximum(const ising_t *hamiltonian, MKL_INT dimension, bool (*mask)(MKL_INT, cost_data_t *),
+                     cost_data_t *cost_data, MKL_INT *index) {
+    MKL_INT num_blocks = (dimension + ISING_BLOCK - 1) / ISING_BLOCK;
+    double maximum = -INFINITY;
+    *index = 0;
+#pragma omp parallel
+    {
+        double local_max = -INFINITY;
+        MKL_INT local_index = 0;
+#pragma omp for schedule(static)
+        for (MKL_INT b = 0; b < num_blocks; ++b) {
+            double cost[ISING_BLOCK];
+            MKL_INT start = b * ISING_BLOCK;
+            MKL_INT length = dimension - start < ISING_BLOCK ? dimension - start : ISING_BLOCK;
+            ising_block(hamiltonian, start, length, cost);
+            for (MKL_INT j = 0; j < length; ++j) {
+                if (cost[j] > local_max && mask(start + j, cost_data)) {
+                    local_max = cost[j];
+                    local_index = start + j;
+                }
+            }
+        }
+#pragma omp critical
+        if (local_max > maximum || (local_max == maximum && local_index < *index)) {
+            maximum = local_max;
+            *index = local_index;
+        }
+    }
+    return maximum;
+}
+
+/**
+ * @brief Releases a Hamiltonian
+ * @param hamiltonian The Hamiltonian (may be NULL)
+ */
+void ising_destroy(ising_t *hamiltonian) {
+    if (hamiltonian == NULL) {
+        return;
+    }
+    mkl_free(hamiltonian->terms);
+    mkl_free(hamiltonian);
+}
@@ -0,0 +1,59 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Cost functions given as a weighted sum of Pauli-Z strings, applied without a stored cost vector
+ * @details An alternative to Cx() for problems with few terms: C(x) = offset + sum_k w_k Z_k(x), where the Z string Z_k
+ * acts on the qubits set in its mask and Z_k(x) = +1 if x has an even number of those bits set, -1 otherwise. Z and
+ * ZZ terms describe Ising models and MaxCut; higher orders are allowed. The kernels evaluate C(x) block by block with
+ * bitwise parity arithmetic, so the phase separator, the expectation value and the adjoint gradient never hold the
+ * 2^n cost vector and the phase is a compute-bound pass rather than a memory-bound one.
+ *
+ * Selected by setting cost_data->hamiltonian, which supports the exact expectation value. As with a stored UC, the
+ * maximum the approximation ratios use is that of the states accepted by mask() (see ising_maximum()).
+ */
+
+#ifndef QOLAB_ISING_H
+#define QOLAB_ISING_H
+
+#include <stdint.h>
+#include "globals.h"
+
+#define ISING_BLOCK 1024
+
+/*! One weighted Pauli-Z string */
+typedef struct {
+    uint64_t mask;      /**< The qubits the string acts on (non-zero) */
+    double weight;      /**< The coefficient of the string */
+} ising_term_t;
+
+/*! A cost function as a weighted sum of Pauli-Z strings */
+typedef struct ising_hamiltonian {
+    double offset;          /**< The constant term */
+    int num_terms;          /**< The number of strings */
+    int capacity;           /**< The number of strings allocated */
+    ising_term_t *terms;    /**< The strings, each mask appearing once */
+} ising_t;
+
+ising_t *ising_create(void);
+
+void ising_add(ising_t *hamiltonian, double weight, uint64_t mask);
+
+ising_t *ising_maxcut(const MKL_INT *graph, int num_vertices);
+
+ising_t *ising_read(const char *path);
+
+void ising_check(const ising_t *hamiltonian, int num_qubits);
+
+void ising_phase(const ising_t *hamiltonian, double gamma, MKL_Complex16 *state, MKL_INT dimension);
+
+void ising_apply(const ising_t *hamiltonian, const MKL_Complex16 *state, MKL_Complex16 *output, MKL_INT dimension,
+                 bool generator);
+
+double ising_expectation(const ising_t *hamiltonian, const MKL_Complex16 *state, MKL_INT dimension);
+
+double ising_maximum(const ising_t *hamiltonian, MKL_INT dimension, bool (*mask)(MKL_INT, cost_data_t *),
+                     cost_data_t *cost_data, MKL_INT *index);
+
+void ising_destroy(ising_t *hamiltonian);
+
+#endif //QOLAB_ISING_H
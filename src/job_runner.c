@@ -0,0 +1,78 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Runs independent simulations concurrently on disjoint groups of cores
+ */
+
+#include <omp.h>
+#include "job_runner.h"
+#include "placement.h"
+
+/**
+ * @brief Runs jobs concurrently, one per group of cores at a time
+ * @details Up to num_groups groups (no more than there are jobs or cores) of mkl_get_max_threads() / num_groups
+ * threads each. The jobs are taken in order as groups become free, and the caller's thread binding is restored once
+ * all of them have finished.
+ * @param jobs The jobs, an array in the manner of qsort()
+ * @param num_jobs The number of jobs
+ * @param job_size The size of each job in bytes
+ * @param num_groups The number of groups the cores are divided into (at least 1)
+ * @param binding How each group's threads are bound to its cores
+ * @param function Runs one job
+ */
+void run_jobs(void *jobs, int num_jobs, size_t job_size, int num_groups, binding_policy_t binding,
+              job_function_t function) {
+    int num_cores = mkl_get_max_threads();
+    int max_levels = omp_get_max_active_levels();
+    if (num_groups < 1) {
+        fprintf(stderr, "Jobs need at least one group of cores.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (num_jobs <= 0) {
+        return;
+    }
+    int concurrent = num_groups < num_jobs ? num_groups : num_jobs;
+    concurrent = concurrent < num_cores ? concurrent : num_cores;
+    int threads_per_group = num_cores / concurrent;
+
+    //The groups, the starts or batched points within a job and the kernels within those
+    mkl_set_dynamic(0);
+    omp_set_max_active_levels(3);
+#pragma omp parallel num_threads(concurrent)
+    {
+        omp_set_num_threads(threads_per_group);
+        int previous = mkl_set_num_threads_local(threads_per_group);
+        bind_group(binding, omp_get_thread_num(), threads_per_group);
+#pragma omp for schedule(dynamic, 1)
+        for (int j = 0; j < num_jobs; ++j) {
+            function((char *) jobs + (size_t) j * job_size);
+        }
+        mkl_set_num_threads_local(previous);
+    }
+    omp_set_max_active_levels(max_levels);
+    bind_threads(binding);
+}
+
+/**
+ * @brief Prepares, solves and releases one simulation
+ * @param job The qaoa_job_t
+ */
+static void qaoa_job(void *job) {
+    qaoa_job_t *simulation = job;
+    qaoa_problem_t problem;
+    qaoa_prepare(&problem, simulation->mach_spec, simulation->cost_data, simulation->run_spec);
+    qaoa_solve(&problem, simulation->mach_spec, simulation->cost_data, simulation->opt_spec, simulation->run_spec,
+               simulation->retain, &simulation->result);
+    qaoa_release(&problem);
+}
+
+/**
+ * @brief Runs complete simulations concurrently on groups of cores (see run_jobs())
+ * @param jobs The simulations, whose results are filled in
+ * @param num_jobs The number of simulations
+ * @param num_groups The number of groups the cores are divided into (at least 1)
+ * @param binding How each group's threads are bound to its cores
+ */
+void run_qaoa_jobs(qaoa_job_t *jobs, int num_jobs, int num_groups, binding_policy_t binding) {
+    run_jobs(jobs, num_jobs, sizeof(qaoa_job_t), num_groups, binding, qaoa_job);
+}
@@ -0,0 +1,40 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Runs independent simulations concurrently on disjoint groups of cores
+ * @details Small and medium simulations cannot use a whole node on their own. run_jobs() splits the cores available
+ * (mkl_get_max_threads()) into groups of equal size and hands the jobs out dynamically to one outer thread per group.
+ * Each group's OpenMP team and MKL (through mkl_set_num_threads_local()) are limited to the group and, under a binding
+ * policy, bound to the group's own cores by bind_group(). Within a group the usual nested parallelism of multi-start
+ * and batched optimisers divides the group's cores further.
+ *
+ * A job is typically a complete simulation (qaoa(), or qaoa_prepare(), qaoa_solve() and qaoa_release()), which is
+ * reentrant as long as jobs share no specification other than read-only cost data: each run owns its random stream
+ * (run_spec->seed), statistics, kernel profile (see profiling.h) and report stream (run_spec->outfile). The problem's
+ * Cx() and mask() are called concurrently.
+ */
+
+#ifndef QOLAB_JOB_RUNNER_H
+#define QOLAB_JOB_RUNNER_H
+
+#include "qaoa.h"
+
+/*! Runs one job, given a pointer to it */
+typedef void (*job_function_t)(void *job);
+
+/*! A complete simulation, run by run_qaoa_jobs() */
+typedef struct {
+    machine_spec_t *mach_spec;      /**< The machine (may be shared, it is only read) */
+    cost_data_t *cost_data;         /**< The instance (may be shared, it is only read) */
+    optimization_spec_t *opt_spec;  /**< The optimisation, whose parameters receive the optimum (not shared) */
+    run_spec_t *run_spec;           /**< The run, with the job's own seed and outfile (not shared) */
+    bool retain;                    /**< If set, the optimiser starts from opt_spec->parameters */
+    qaoa_statistics_t result;       /**< Receives the final statistics of the job (without the convergence trace) */
+} qaoa_job_t;
+
+void run_jobs(void *jobs, int num_jobs, size_t job_size, int num_groups, binding_policy_t binding,
+              job_function_t function);
+
+void run_qaoa_jobs(qaoa_job_t *jobs, int num_jobs, int num_groups, binding_policy_t binding);
+
+#endif //QOLAB_JOB_RUNNER_H
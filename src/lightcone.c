@@ -0,0 +1,364 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Evaluates the MaxCut expectation of low-depth QAOA edge by edge over light-cone subgraphs
+ * @details The distinct light cones are found once per depth by lightcone_set_depth(). Each evaluation simulates every
+ * distinct light cone once: small light cones are spread over the threads, one per thread with single-threaded kernels,
+ * while large ones run one after another with every thread in the kernels. The terms are summed in a fixed order, so
+ * the result does not depend on the number of threads.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "lightcone.h"
+#include "matrix_expm.h"
+#include "placement.h"
+#include "cost_vector.h"
+
+#define LIGHTCONE_MAX_EDGES (LIGHTCONE_MAX_QUBITS * (LIGHTCONE_MAX_QUBITS - 1) / 2)
+#define LIGHTCONE_KEY_LENGTH (2 + 3 * LIGHTCONE_MAX_EDGES)
+
+/**
+ * @brief Creates the light-cone evaluator of a MaxCut instance
+ * @param cost_data Contains the num_vertices * num_vertices weighted adjacency matrix of an undirected graph
+ * @param num_vertices The number of vertices (qubits)
+ * @return The evaluator, whose light cones are built by lightcone_set_depth()
+ */
+lightcone_t *lightcone_create(cost_data_t *cost_data, int num_vertices) {
+    lightcone_t *lightcone = mkl_malloc(sizeof(lightcone_t), DEF_ALIGNMENT);
+    check_alloc(lightcone);
+    for (int i = 0; i < num_vertices; ++i) {
+        for (int j = i + 1; j < num_vertices; ++j) {
+            if (cost_data->graph[(MKL_INT) i * num_vertices + j] != cost_data->graph[(MKL_INT) j * num_vertices + i]) {
+                fprintf(stderr, "Light-cone evaluation needs an undirected graph (%d, %d).\n", i, j);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    graph_to_csr(cost_data->graph, num_vertices, &lightcone->graph);
+    lightcone->num_edges = 0;
+    lightcone->total_weight = 0.0;
+    for (int u = 0; u < num_vertices; ++u) {
+        for (MKL_INT e = lightcone->graph.row_start[u]; e < lightcone->graph.row_start[u + 1]; ++e) {
+            if (lightcone->graph.columns[e] > u) {
+                lightcone->num_edges++;
+                lightcone->total_weight += (double) lightcone->graph.weights[e];
+            }
+        }
+    }
+    lightcone->depth = 0;
+    lightcone->num_shapes = 0;
+    lightcone->shapes = NULL;
+    lightcone->max_qubits = 0;
+    return lightcone;
+}
+
+/**
+ * @brief Orders the edges of a key by their endpoints
+ */
+static int lightcone_edge_order(const void *a, const void *b) {
+    const int *x = a;
+    const int *y = b;
+    if (x[0] != y[0]) {
+        return x[0] < y[0] ? -1 : 1;
+    }
+    return (x[1] > y[1]) - (x[1] < y[1]);
+}
+
+/**
+ * @brief Builds the key of the light cone of an edge, seen from one of its ends
+ * @details Vertices are labelled in breadth-first order from u (0) and v (1), neighbours in ascending vertex order.
+ * The edges kept are those with an endpoint within distance depth - 1, whose phases reach the observed edge.
+ * @param lightcone The evaluator
+ * @param u The end of the edge labelled 0
+ * @param v The end of the edge labelled 1
+ * @param depth The depth P
+ * @param label Scratch, -1 for every vertex on entry and on return
+ * @param distance Scratch for the distance of every vertex from the edge
+ * @param order Scratch for LIGHTCONE_MAX_QUBITS vertices
+ * @param key LIGHTCONE_KEY_LENGTH integers to fill
+ * @return The number of integers of the key
+ */
+static int lightcone_key(lightcone_t *lightcone, int u, int v, int depth, int *label, int *distance, int *order,
+                         int *key) {
+    const graph_csr_t *graph = &lightcone->graph;
+    int count = 2;
+    int num_edges = 0;
+    order[0] = u;
+    order[1] = v;
+    label[u] = 0;
+    label[v] = 1;
+    distance[u] = 0;
+    distance[v] = 0;
+    for (int q = 0; q < count; ++q) {
+        int w = order[q];
+        if (distance[w] == depth) {
+            continue;
+        }
+        for (MKL_INT e = graph->row_start[w]; e < graph->row_start[w + 1]; ++e) {
+            int c = (int) graph->columns[e];
+            if (label[c] < 0) {
+                if (count == LIGHTCONE_MAX_QUBITS) {
+                    fprintf(stderr, "The light cone of edge (%d, %d) at P = %d holds more than %d vertices.\n", u, v,
+                            depth, LIGHTCONE_MAX_QUBITS);
+                    exit(EXIT_FAILURE);
+                }
+                label[c] = count;
+                distance[c] = distance[w] + 1;
+                order[count++] = c;
+            }
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        int w = order[i];
+        for (MKL_INT e = graph->row_start[w]; e < graph->row_start[w + 1]; ++e) {
+            int c = (int) graph->columns[e];
+            if (label[c] > i && (distance[w] < depth || distance[c] < depth)) {
+                key[2 + 3 * num_edges] = i;
+                key[3 + 3 * num_edges] = label[c];
+                key[4 + 3 * num_edges] = (int) graph->weights[e];
+                num_edges++;
+            }
+        }
+    }
+    qsort(key + 2, num_edges, 3 * sizeof(int), lightcone_edge_order);
+    for (int i = 0; i < count; ++i) {
+        label[order[i]] = -1;
+    }
+    key[0] = count;
+    key[1] = num_edges;
+    return 2 + 3 * num_edges;
+}
+
+/**
+ * @brief Hashes a key (FNV-1a)
+ */
+static uint64_t lightcone_hash(const int *key, int length) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < length; ++i) {
+        hash = (hash ^ (uint32_t) key[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Orders light cones by decreasing size, so the largest are scheduled first
+ */
+static int lightcone_shape_order(const void *a, const void *b) {
+    const lightcone_shape_t *x = a;
+    const lightcone_shape_t *y = b;
+    return (y->num_vertices > x->num_vertices) - (y->num_vertices < x->num_vertices);
+}
+
+/**
+ * @brief Checks whether a light cone has the given key
+ * @details The lengths are compared first so a shorter stored key is never read past its end.
+ * @param shape The light cone
+ * @param key The key
+ * @param length The length of the key
+ * @return Whether the keys are equal
+ */
+static bool lightcone_shape_matches(const lightcone_shape_t *shape, const int *key, int length) {
+    return 2 + 3 * shape->num_edges == length && memcmp(shape->key, key, length * sizeof(int)) == 0;
+}
+
+/**
+ * @brief Releases the light cones of the current depth
+ * @param lightcone The evaluator
+ */
+static void lightcone_clear(lightcone_t *lightcone) {
+    for (int s = 0; s < lightcone->num_shapes; ++s) {
+        mkl_free(lightcone->shapes[s].key);
+    }
+    if (lightcone->shapes != NULL) {
+        mkl_free(lightcone->shapes);
+    }
+    lightcone->shapes = NULL;
+    lightcone->num_shapes = 0;
+    lightcone->max_qubits = 0;
+    lightcone->depth = 0;
+}
+
+/**
+ * @brief Finds the distinct light cones of every edge at a given depth
+ * @details Does nothing if they were already built for this depth. Each edge takes the smaller of its keys from either
+ * end, so the orientation of an edge does not split its light cone from an otherwise equal one.
+ * @param lightcone The evaluator
+ * @param depth The depth P
+ */
+void lightcone_set_depth(lightcone_t *lightcone, int depth) {
+    int n = lightcone->graph.num_vertices;
+    int capacity = 16;
+    if (lightcone->depth == depth) {
+        return;
+    }
+    lightcone_clear(lightcone);
+    while (capacity < 2 * lightcone->num_edges) {
+        capacity *= 2;
+    }
+    int *slots = mkl_malloc(capacity * sizeof(int), DEF_ALIGNMENT);
+    int *label = mkl_malloc(n * sizeof(int), DEF_ALIGNMENT);
+    int *distance = mkl_malloc(n * sizeof(int), DEF_ALIGNMENT);
+    int *order = mkl_malloc(LIGHTCONE_MAX_QUBITS * sizeof(int), DEF_ALIGNMENT);
+    int *forward = mkl_malloc(LIGHTCONE_KEY_LENGTH * sizeof(int), DEF_ALIGNMENT);
+    int *backward = mkl_malloc(LIGHTCONE_KEY_LENGTH * sizeof(int), DEF_ALIGNMENT);
+    lightcone->shapes = mkl_malloc((lightcone->num_edges + 1) * sizeof(lightcone_shape_t), DEF_ALIGNMENT);
+    check_alloc(slots);
+    check_alloc(label);
+    check_alloc(distance);
+    check_alloc(order);
+    check_alloc(forward);
+    check_alloc(backward);
+    check_alloc(lightcone->shapes);
+    for (int i = 0; i < capacity; ++i) {
+        slots[i] = -1;
+    }
+    for (int i = 0; i < n; ++i) {
+        label[i] = -1;
+    }
+
+    for (int u = 0; u < n; ++u) {
+        for (MKL_INT e = lightcone->graph.row_start[u]; e < lightcone->graph.row_start[u + 1]; ++e) {
+            int v = (int) lightcone->graph.columns[e];
+            if (v <= u) {
+                continue;
+            }
+            int length = lightcone_key(lightcone, u, v, depth, label, distance, order, forward);
+            int backward_length = lightcone_key(lightcone, v, u, depth, label, distance, order, backward);
+            const int *key = backward_length == length && memcmp(backward, forward, length * sizeof(int)) < 0
+                             ? backward : forward;
+            int slot = (int) (lightcone_hash(key, length) & (capacity - 1));
+            while (slots[slot] >= 0 && !lightcone_shape_matches(&lightcone->shapes[slots[slot]], key, length)) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            if (slots[slot] < 0) {
+                lightcone_shape_t *shape = &lightcone->shapes[lightcone->num_shapes];
+                shape->num_vertices = key[0];
+                shape->num_edges = key[1];
+                shape->key = mkl_malloc(length * sizeof(int), DEF_ALIGNMENT);
+                check_alloc(shape->key);
+                memcpy(shape->key, key, length * sizeof(int));
+                shape->multiplicity = 0.0;
+                slots[slot] = lightcone->num_shapes++;
+            }
+            lightcone->shapes[slots[slot]].multiplicity += (double) lightcone->graph.weights[e];
+        }
+    }
+    qsort(lightcone->shapes, lightcone->num_shapes, sizeof(lightcone_shape_t), lightcone_shape_order);
+    lightcone->max_qubits = lightcone->num_shapes > 0 ? lightcone->shapes[0].num_vertices : 0;
+    lightcone->depth = depth;
+
+    mkl_free(backward);
+    mkl_free(forward);
+    mkl_free(order);
+    mkl_free(distance);
+    mkl_free(label);
+    mkl_free(slots);
+}
+
+/**
+ * @brief Simulates one light cone and measures its observed edge
+ * @param shape The light cone
+ * @param depth The depth P
+ * @param x The 2 * P angles, gammas then betas
+ * @param block_length The block length of the product mixer
+ * @return The multiplicity of the light cone times the probability that vertices 0 and 1 are cut
+ */
+static double lightcone_term(const lightcone_shape_t *shape, int depth, const double *x, MKL_INT block_length) {
+    MKL_INT dimension = (MKL_INT) 1 << shape->num_vertices;
+    const int *edges = shape->key + 2;
+    double amplitude = 1.0 / sqrt((double) dimension);
+    double cut = 0.0;
+    int total = 0;
+    for (int k = 0; k < shape->num_edges; ++k) {
+        total += abs(edges[3 * k + 2]);
+    }
+    cost_vector_t *uc = cost_vector_allocate(dimension, cost_vector_type(-total, total), NULL);
+    MKL_Complex16 *state = numa_allocate((size_t) dimension, sizeof(MKL_Complex16));
+
+#pragma omp parallel for schedule(static)
+    for (MKL_INT i = 0; i < dimension; ++i) {
+        int value = 0;
+        for (int k = 0; k < shape->num_edges; ++k) {
+            value += edges[3 * k + 2] * (int) (((i >> edges[3 * k]) ^ (i >> edges[3 * k + 1])) & 1);
+        }
+        cost_vector_set(uc, i, value);
+        state[i].real = amplitude;
+        state[i].imag = 0.0;
+    }
+    for (int p = 0; p < depth; ++p) {
+        spmatrix_expm_z_diag(uc, x[p], state);
+        spmatrix_expm_product_x(state, x[p + depth], shape->num_vertices, block_length, false);
+    }
+#pragma omp parallel for schedule(static) reduction(+:cut)
+    for (MKL_INT i = 0; i < dimension; ++i) {
+        if ((i ^ (i >> 1)) & 1) {
+            cut += state[i].real * state[i].real + state[i].imag * state[i].imag;
+        }
+    }
+
+    numa_free(state);
+    cost_vector_free(uc);
+    return shape->multiplicity * cut;
+}
+
+/**
+ * @brief Computes the expected weighted cut at the depth set by lightcone_set_depth()
+ * @param lightcone The evaluator
+ * @param x The 2 * P angles, gammas then betas
+ * @param block_length The block length of the product mixer
+ * @return The expectation value of the cost function
+ */
+double lightcone_expectation(lightcone_t *lightcone, const double *x, MKL_INT block_length) {
+    double result = 0.0;
+    double *terms = mkl_malloc((lightcone->num_shapes + 1) * sizeof(double), DEF_ALIGNMENT);
+    bool shared = lightcone->num_shapes >= omp_get_max_threads() &&
+                  lightcone->max_qubits <= LIGHTCONE_SHARED_QUBITS;
+    check_alloc(terms);
+#pragma omp parallel for schedule(dynamic, 1) if (shared)
+    for (int s = 0; s < lightcone->num_shapes; ++s) {
+        //A shared term runs its kernels, MKL's and the OpenMP loops nested within it, on its own thread
+        int previous = shared ? mkl_set_num_threads_local(1) : 0;
+        int previous_omp = omp_get_max_threads();
+        if (shared) {
+            omp_set_num_threads(1);
+        }
+        terms[s] = lightcone_term(&lightcone->shapes[s], lightcone->depth, x, block_length);
+        if (shared) {
+            omp_set_num_threads(previous_omp);
+            mkl_set_num_threads_local(previous);
+        }
+    }
+    for (int s = 0; s < lightcone->num_shapes; ++s) {
+        result += terms[s];
+    }
+    mkl_free(terms);
+    return result;
+}
+
+/**
+ * @brief Reports on the light cones of the current depth
+ * @param lightcone The evaluator
+ * @param outfile The file stream to print to
+ */
+void lightcone_report(lightcone_t *lightcone, FILE *outfile) {
+    if (outfile == NULL) {
+        outfile = stdout;
+    }
+    fprintf(outfile, "Light-cone report:\n"
+                     "%d Edges\n"
+                     "%d Distinct light cones\n"
+                     "%d Largest light cone\n",
+            lightcone->num_edges, lightcone->num_shapes, lightcone->max_qubits);
+}
+
+/**
+ * @brief Releases a light-cone evaluator
+ * @param lightcone The evaluator
+ */
+void lightcone_destroy(lightcone_t *lightcone) {
+    lightcone_clear(lightcone);
+    graph_csr_free(&lightcone->graph);
+    mkl_free(lightcone);
+}
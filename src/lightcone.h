@@ -0,0 +1,56 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Evaluates the MaxCut expectation of low-depth QAOA edge by edge over light-cone subgraphs
+ * @details The expectation of the weighted cut is a sum over edges of w_uv <(1 - Z_u Z_v) / 2>. At depth P the term of
+ * edge (u, v) only involves the vertices within distance P of u or v, and the edges with an endpoint within distance
+ * P - 1, so it is found by simulating that subgraph alone with the usual phase and exact product mixer kernels. The
+ * memory needed depends on the size of the largest light cone rather than on the size of the graph, so sparse graphs
+ * with hundreds of vertices can be optimised at small P.
+ *
+ * Light cones are relabelled in breadth-first order from the edge and keyed by the relabelled subgraph; edges with
+ * equal keys share one simulation per evaluation. Equal keys imply equal terms, but the key is not a canonical form:
+ * isomorphic light cones may still be simulated separately (tree-like light cones of regular graphs always match).
+ *
+ * The mode assumes the cost function is the weighted cut of cost_data->graph, which must be symmetric.
+ */
+
+#ifndef QOLAB_LIGHTCONE_H
+#define QOLAB_LIGHTCONE_H
+
+#include "globals.h"
+#include "graph_generator.h"
+
+#define LIGHTCONE_MAX_QUBITS 30
+#define LIGHTCONE_SHARED_QUBITS 16
+
+/*! One distinct light-cone subgraph, the observed edge joining vertices 0 and 1 */
+typedef struct {
+    int num_vertices;       /**< The number of vertices (qubits) of the subgraph */
+    int num_edges;          /**< The number of edges applied by the phase separator */
+    int *key;               /**< num_vertices, num_edges and then (a, b, weight) of every edge with a < b, ascending */
+    double multiplicity;    /**< The summed weight of the graph's edges with this light cone */
+} lightcone_shape_t;
+
+/*! The light cones of every edge of a graph at one depth */
+typedef struct lightcone {
+    graph_csr_t graph;          /**< The adjacency of the graph */
+    int num_edges;              /**< The number of edges of the graph */
+    double total_weight;        /**< The summed weight of every edge */
+    int depth;                  /**< The depth the shapes were built for (0 before lightcone_set_depth()) */
+    int num_shapes;             /**< The number of distinct light cones */
+    lightcone_shape_t *shapes;  /**< The distinct light cones, largest first */
+    int max_qubits;             /**< The number of vertices of the largest light cone */
+} lightcone_t;
+
+lightcone_t *lightcone_create(cost_data_t *cost_data, int num_vertices);
+
+void lightcone_set_depth(lightcone_t *lightcone, int depth);
+
+double lightcone_expectation(lightcone_t *lightcone, const double *x, MKL_INT block_length);
+
+void lightcone_report(lightcone_t *lightcone, FILE *outfile);
+
+void lightcone_destroy(lightcone_t *lightcone);
+
+#endif //QOLAB_LIGHTCONE_H
@@ -6,6 +6,7 @@
 #include "qaoa.h"
 #include "graph_utils.h"
 #include <mathimf.h>
+#include <time.h>
 
 /*
  * An example main file which runs our example solution
@@ -20,7 +21,26 @@ int main(int argc, char *argv[]){
     run_spec.verbose = false;
     run_spec.restricted = true;
     run_spec.restart = true;
+    run_spec.seed = 0;                              //e.g. 1 for a reproducible run
     run_spec.num_samples = 100;
+    run_spec.objective = OBJECTIVE_EXPECTATION;
+    run_spec.cvar_alpha = 0.1;
+    run_spec.gibbs_eta = 1.0;
+    run_spec.cheby_tolerance = CHEBY_DEFAULT_TOLERANCE;
+    run_spec.spectral_limit = SPECTRAL_LIMIT_DEFAULT;
+    run_spec.mixer = MIXER_CHEBYSHEV;
+    run_spec.xy_topology = XY_RING;
+    run_spec.xy_steps = 1;
+    run_spec.xy_weight = 2;                         //Dicke state weight for MIXER_XY, e.g. num_qubits / 2
+    run_spec.symmetric = false;
+    run_spec.lightcone = false;
+    run_spec.block_length = BLOCK_LENGTH_DEFAULT;   //BLOCK_LENGTH_STREAMED when out-of-core
+    run_spec.ooc_directory = NULL;                  //e.g. "/tmp" on a local NVMe to run out-of-core
+    run_spec.state_cache_bytes = 0;                 //e.g. (size_t) 1 << 30 to resume from cached layer prefixes
+    run_spec.binding = BINDING_NONE;                //BINDING_CLOSE or BINDING_SPREAD to pin one thread per core
+    run_spec.trace_path = NULL;                     //e.g. "trace.bin" to record every evaluation
+    run_spec.trace_format = TRACE_BINARY;
+    run_spec.profile_path = NULL;
     run_spec.outfile = stdout;
 
     machine_spec_t mach_spec;
@@ -32,26 +52,36 @@ int main(int argc, char *argv[]){
     opt_spec.ftol = 1e-16;
     opt_spec.xtol = 1e-16;
     opt_spec.max_evals = 200 * mach_spec.P;
+    opt_spec.num_starts = 1;
+    opt_spec.optimiser_type = OPTIMISER_NLOPT;
     opt_spec.nlopt_method = NLOPT_LN_NELDERMEAD;
+    opt_spec.step_size = 0.0;
+    opt_spec.perturbation = 0.0;
+    opt_spec.population = 0;
+    opt_spec.strategy = STRATEGY_ZERO;              //e.g. STRATEGY_INTERP to start P = 2 from the interpolated P = 1
+    opt_spec.fourier_q = 0;
+    opt_spec.store_path = NULL;
+    opt_spec.problem_class = "gnp_0.5";
+    opt_spec.store_seeds = 1;
 
     cost_data_t cost_data;
     cost_data.cx_range = mach_spec.space_dimension;
     cost_data.x_range = mach_spec.space_dimension;
     cost_data.num_vertices = mach_spec.num_qubits;
+    cost_data.hamiltonian = NULL;
     cost_data.graph = mkl_malloc(sizeof(MKL_INT) * mach_spec.num_qubits * mach_spec.num_qubits, DEF_ALIGNMENT);
 
-    generate_graph(cost_data.graph, mach_spec.num_qubits, 0.5);
+    VSLStreamStatePtr graph_stream;
+    check_stream(vslNewStream(&graph_stream, VSL_BRNG_PHILOX4X32X10,
+                              (MKL_UINT) (run_spec.seed != 0 ? run_spec.seed : (unsigned) time(0))));
+    generate_graph(cost_data.graph, mach_spec.num_qubits, 0.5, graph_stream);
+    vslDeleteStream(&graph_stream);
     print_graph(&cost_data, stdout);
 
     qaoa(&mach_spec, &cost_data, &opt_spec, &run_spec, false);
     mach_spec.P = 2;
-    //Reallocate parameters
-    mkl_realloc(opt_spec.parameters, (run_spec.restricted ? mach_spec.P * 2 + 1 : mach_spec.P) * sizeof(double));
-    if (run_spec.restricted) {
-        move_params_restricted(mach_spec.P, opt_spec.parameters);
-    } else {
-        move_params(mach_spec.P, opt_spec.parameters);
-    }
+    //Reallocate and extend parameters
+    grow_params(mach_spec.P, run_spec.restricted, &opt_spec);
     qaoa(&mach_spec, &cost_data, &opt_spec, &run_spec, true);
     mkl_free(cost_data.graph);
     return 0;
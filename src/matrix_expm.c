@@ -1,31 +1,220 @@
 #include "matrix_expm.h"
 #include "globals.h"
+#include "profiling.h"
+#include "out_of_core.h"
+#include "placement.h"
+#include "cost_vector.h"
 
 /**
- * @brief Computes action of the matrix exponential of a diagonal matrix applied to a vector.
- * @details This requires the matrix is represented as a vector of complex numbers.
- * @param diag The 'matrix' to be exponentiated
+ * @brief Rotates a range of amplitudes by exp(-i alpha C(x)), widening their costs COST_BLOCK at a time
+ * @param diag The cost function C
+ * @param alpha The phase angle
+ * @param start The first state of the range
+ * @param end The state after the range
+ * @param state The state, updated in place
+ */
+static void phase_range(const cost_vector_t *diag, double alpha, MKL_INT start, MKL_INT end, MKL_Complex16 *state) {
+    double cost[COST_BLOCK];
+    for (MKL_INT first = start; first < end; first += COST_BLOCK) {
+        MKL_INT length = end - first < COST_BLOCK ? end - first : COST_BLOCK;
+        MKL_Complex16 *current = state + first;
+        cost_vector_block(diag, first, length, cost);
+#pragma omp simd
+        for (MKL_INT j = 0; j < length; ++j) {
+            double c = cos(alpha * cost[j]);
+            double s = sin(alpha * cost[j]);
+            double real = current[j].real;
+            current[j].real = c * real + s * current[j].imag;
+            current[j].imag = c * current[j].imag - s * real;
+        }
+    }
+}
+
+/**
+ * @brief Computes the action of the phase separator exp(-i alpha C) on a vector
+ * @details The cost function is diagonal, so this is a single in-place pass over the state and the compact cost
+ * vector with the blocks statically divided between threads.
+ * @param diag The cost function C, one value per amplitude
  * @param alpha A scaling factor
- * @param nnz The size of the matrix
- * @param state The output state, should be nnz in length
+ * @param state The output state, should be diag->length in length
  */
-void spmatrix_expm_z_diag(const MKL_Complex16 *diag, double alpha, MKL_INT nnz, MKL_Complex16 *state) {
+void spmatrix_expm_z_diag(const cost_vector_t *diag, double alpha, MKL_Complex16 *state) {
+    PROFILE_BEGIN(profile_mark);
     check_alloc(state);
+    MKL_INT nnz = diag->length;
+    MKL_INT num_blocks = (nnz + COST_BLOCK - 1) / COST_BLOCK;
+#pragma omp parallel for schedule(static)
+    for (MKL_INT b = 0; b < num_blocks; ++b) {
+        MKL_INT start = b * COST_BLOCK;
+        phase_range(diag, alpha, start, start + COST_BLOCK < nnz ? start + COST_BLOCK : nnz, state);
+    }
+    PROFILE_END(PROFILE_PHASE, profile_mark, nnz * (long long) (2 * sizeof(MKL_Complex16) +
+                                                                cost_type_size(diag->type)), 0);
+}
+
+/**
+ * @brief Computes the action of the phase separator on a memory-mapped vector, block by block
+ * @details Equivalent to spmatrix_expm_z_diag(). Blocks are statically divided between threads so each walks its own
+ * contiguous range of both files, prefetching its next block and writing back the last.
+ * @param diag The cost function C, one value per amplitude
+ * @param alpha A scaling factor
+ * @param state The output state, should be diag->length in length
+ * @param block_length The number of elements per block
+ */
+void spmatrix_expm_z_diag_streamed(const cost_vector_t *diag, double alpha, MKL_Complex16 *state,
+                                   MKL_INT block_length) {
+    PROFILE_BEGIN(profile_mark);
+    MKL_INT nnz = diag->length;
+    MKL_INT num_blocks = (nnz + block_length - 1) / block_length;
+#pragma omp parallel for schedule(static)
+    for (MKL_INT b = 0; b < num_blocks; ++b) {
+        MKL_INT start = b * block_length;
+        MKL_INT end = start + block_length < nnz ? start + block_length : nnz;
+        MKL_INT ahead = end + block_length < nnz ? block_length : nnz - end;
+        ooc_prefetch(cost_vector_address(diag, end), ahead * cost_type_size(diag->type));
+        ooc_prefetch(state + end, ahead * sizeof(MKL_Complex16));
+        phase_range(diag, alpha, start, end, state);
+        ooc_writeback(state + start, (end - start) * sizeof(MKL_Complex16));
+    }
+    PROFILE_END(PROFILE_PHASE, profile_mark, nnz * (long long) (2 * sizeof(MKL_Complex16) +
+                                                                cost_type_size(diag->type)), 0);
+}
+
+/**
+ * @brief Rotates pairs of amplitudes by exp(-i beta X)
+ * @param a The amplitudes with the qubit clear
+ * @param b The amplitudes with the qubit set, paired element-wise with a
+ * @param count The number of pairs
+ * @param c cos(beta)
+ * @param s sin(beta)
+ */
+static void rotate_pairs(MKL_Complex16 *a, MKL_Complex16 *b, MKL_INT count, double c, double s) {
+    for (MKL_INT k = 0; k < count; ++k) {
+        MKL_Complex16 x = a[k];
+        MKL_Complex16 y = b[k];
+        a[k].real = c * x.real + s * y.imag;
+        a[k].imag = c * x.imag - s * y.real;
+        b[k].real = c * y.real + s * x.imag;
+        b[k].imag = c * y.imag - s * x.real;
+    }
+}
 
-    MKL_Complex16 *tempValues = mkl_calloc((size_t) nnz, sizeof(MKL_Complex16), DEF_ALIGNMENT);
-    check_alloc(tempValues);
+/**
+ * @brief Computes the action of exp(-i beta B) for the transverse-field driver B = sum_j X_j exactly
+ * @details The driver's terms commute, so the exponential is the product of single-qubit rotations
+ * cos(beta) I - i sin(beta) X_j. Qubits whose pairs lie within a block are applied together while the block is
+ * resident (one pass over the vector); each remaining qubit takes one more pass, streaming the two halves of every
+ * pair. No matrix is built and no tolerance applies. With streamed set each block is prefetched before and written
+ * back after use, for memory-mapped vectors.
+ * @param state The vector to which the action is applied
+ * @param beta The mixing angle
+ * @param num_qubits The number of qubits (the state has pow(2, num_qubits) amplitudes)
+ * @param block_length The number of amplitudes per block (a power of two)
+ * @param streamed Whether the state is memory-mapped
+ */
+void spmatrix_expm_product_x(MKL_Complex16 *state, double beta, int num_qubits, MKL_INT block_length, bool streamed) {
+    PROFILE_BEGIN(profile_mark);
+    MKL_INT dimension = (MKL_INT) 1 << num_qubits;
+    MKL_INT block = block_length < dimension ? block_length : dimension;
+    MKL_INT num_blocks = dimension / block;
+    int resident = 0;
+    double c = cos(beta);
+    double s = sin(beta);
+    while (((MKL_INT) 1 << resident) < block) {
+        resident++;
+    }
 
-    MKL_Complex16 *resultValues = mkl_malloc(nnz * sizeof(MKL_Complex16), DEF_ALIGNMENT);
-    check_alloc(resultValues);
+#pragma omp parallel for schedule(static)
+    for (MKL_INT b = 0; b < num_blocks; ++b) {
+        MKL_Complex16 *current = state + b * block;
+        if (streamed && b + 1 < num_blocks) {
+            ooc_prefetch(current + block, block * sizeof(MKL_Complex16));
+        }
+        for (int j = 0; j < resident; ++j) {
+            MKL_INT stride = (MKL_INT) 1 << j;
+            for (MKL_INT base = 0; base < block; base += 2 * stride) {
+                rotate_pairs(current + base, current + base + stride, stride, c, s);
+            }
+        }
+        if (streamed) {
+            ooc_writeback(current, block * sizeof(MKL_Complex16));
+        }
+    }
 
-    cblas_zcopy(nnz, diag, 1, tempValues, 1);
-    cblas_zdscal(nnz, alpha, tempValues, 1);
-    vzExp(nnz, tempValues, resultValues);
-    cblas_zcopy(nnz, state, 1, tempValues, 1);
-    vzMul(nnz, resultValues, tempValues, state);
+    for (int j = resident; j < num_qubits; ++j) {
+        MKL_INT stride = (MKL_INT) 1 << j;
+#pragma omp parallel for schedule(static)
+        for (MKL_INT b = 0; b < num_blocks / 2; ++b) {
+            //The b-th block with qubit j clear, and its partner with it set
+            MKL_INT offset = (b * block / stride) * 2 * stride + (b * block) % stride;
+            if (streamed && b + 1 < num_blocks / 2) {
+                MKL_INT next = ((b + 1) * block / stride) * 2 * stride + ((b + 1) * block) % stride;
+                ooc_prefetch(state + next, block * sizeof(MKL_Complex16));
+                ooc_prefetch(state + next + stride, block * sizeof(MKL_Complex16));
+            }
+            rotate_pairs(state + offset, state + offset + stride, block, c, s);
+            if (streamed) {
+                ooc_writeback(state + offset, block * sizeof(MKL_Complex16));
+                ooc_writeback(state + offset + stride, block * sizeof(MKL_Complex16));
+            }
+        }
+    }
+    PROFILE_END(PROFILE_MIXER, profile_mark, product_bytes(num_qubits, block_length), 0);
+}
 
-    mkl_free(tempValues);
-    mkl_free(resultValues);
+/**
+ * @brief Computes the action of exp(-i beta X) for the top qubit of a state symmetric under flipping every bit
+ * @details The symmetric half-space holds the amplitudes with the top qubit clear. The partner of state i under the top
+ * qubit's X has the amplitude of its complement, dimension - 1 - i, so the rotation pairs the two ends of the vector.
+ * @param state The lower half of a symmetric state, updated in place
+ * @param beta The mixing angle
+ * @param dimension The number of amplitudes held (half the full state-space)
+ */
+void spmatrix_expm_flip_x(MKL_Complex16 *state, double beta, MKL_INT dimension) {
+    PROFILE_BEGIN(profile_mark);
+    double c = cos(beta);
+    double s = sin(beta);
+#pragma omp parallel for schedule(static)
+    for (MKL_INT i = 0; i < dimension / 2; ++i) {
+        MKL_Complex16 x = state[i];
+        MKL_Complex16 y = state[dimension - 1 - i];
+        state[i].real = c * x.real + s * y.imag;
+        state[i].imag = c * x.imag - s * y.real;
+        state[dimension - 1 - i].real = c * y.real + s * x.imag;
+        state[dimension - 1 - i].imag = c * y.imag - s * x.real;
+    }
+    PROFILE_END(PROFILE_MIXER, profile_mark, 2LL * dimension * (long long) sizeof(MKL_Complex16), 0);
+}
+
+/**
+ * @brief Computes -i B state for the transverse-field driver B = sum_j X_j, matching the action of the UB matrix
+ * @details In symmetric mode the vectors hold the lower half of a state symmetric under flipping every bit, and the top
+ * qubit's term connects each amplitude to its complement (see spmatrix_expm_flip_x()).
+ * @param state The input vector
+ * @param output The output vector (distinct from state)
+ * @param num_qubits The number of qubits (vectors have pow(2, num_qubits) amplitudes, half that when symmetric)
+ * @param symmetric Whether the vectors hold only the symmetric half-space
+ */
+void spmatrix_product_x_mv(const MKL_Complex16 *state, MKL_Complex16 *output, int num_qubits, bool symmetric) {
+    PROFILE_BEGIN(profile_mark);
+    int free_qubits = symmetric ? num_qubits - 1 : num_qubits;
+    MKL_INT dimension = (MKL_INT) 1 << free_qubits;
+#pragma omp parallel for schedule(static)
+    for (MKL_INT i = 0; i < dimension; ++i) {
+        double real = 0.0;
+        double imag = 0.0;
+        for (int j = 0; j < free_qubits; ++j) {
+            real += state[i ^ ((MKL_INT) 1 << j)].real;
+            imag += state[i ^ ((MKL_INT) 1 << j)].imag;
+        }
+        if (symmetric) {
+            real += state[dimension - 1 - i].real;
+            imag += state[dimension - 1 - i].imag;
+        }
+        output[i].real = imag;
+        output[i].imag = -real;
+    }
+    PROFILE_END(PROFILE_SPMV, profile_mark, (num_qubits + 1LL) * dimension * (long long) sizeof(MKL_Complex16), 0);
 }
 
 /**
@@ -38,10 +227,12 @@ void spmatrix_expm_z_diag(const MKL_Complex16 *diag, double alpha, MKL_INT nnz,
  * @param minE The minimal Eigenvalue
  * @param maxE The maximal Eigenvalue
  * @param side_len
+ * @param tolerance The expansion is truncated at the first coefficient smaller than this (see cheby_terms())
+ * @param workspace The pool the four work vectors of side_len amplitudes are taken from (NULL to allocate them)
  */
 void spmatrix_expm_cheby(sparse_matrix_t *matrix, MKL_Complex16 *state, MKL_Complex16 dt,
                          MKL_Complex16 minE, MKL_Complex16 maxE,
-                         MKL_INT side_len) {
+                         MKL_INT side_len, double tolerance, numa_pool_t *workspace) {
     int i, terms;
     double alpha;
     complex double emin, emax, t, EmEm, d2EmEm, imagM, neg1, bessj0, bessj1, bessjn, ztemp;
@@ -49,12 +240,13 @@ void spmatrix_expm_cheby(sparse_matrix_t *matrix, MKL_Complex16 *state, MKL_Comp
     MKL_Complex16 mkl_ztemp1, mkl_ztemp2;
     struct matrix_descr descr;
     descr.type = SPARSE_MATRIX_TYPE_GENERAL;
+    PROFILE_BEGIN(profile_mark);
 
     MKL_Complex16 **work = mkl_malloc(4 * sizeof(MKL_Complex16 *), DEF_ALIGNMENT);
     check_alloc(work);
     for (i = 0; i < 4; ++i) {
-        work[i] = mkl_calloc((size_t) side_len, sizeof(MKL_Complex16), DEF_ALIGNMENT);
-        check_alloc(work[i]);
+        work[i] = workspace != NULL ? numa_pool_take(workspace) : numa_allocate((size_t) side_len,
+                                                                               sizeof(MKL_Complex16));
     }
 
     emin = minE.real + I * minE.imag;
@@ -67,8 +259,10 @@ void spmatrix_expm_cheby(sparse_matrix_t *matrix, MKL_Complex16 *state, MKL_Comp
 
     cblas_zcopy(side_len, state, 1, work[0], 1);
 
+    PROFILE_BEGIN(spmv_mark);
     status = mkl_sparse_z_mv(SPARSE_OPERATION_NON_TRANSPOSE, (MKL_Complex16) {1.0, 0.0}, *matrix, descr, work[0],
                              (MKL_Complex16) {0.0, 0.0}, work[1]);
+    PROFILE_END(PROFILE_SPMV, spmv_mark, spmv_bytes(*matrix), 0);
     mkl_error_parse(status, stderr);
 
     mkl_ztemp1.real = creal(EmEm);
@@ -93,10 +287,7 @@ void spmatrix_expm_cheby(sparse_matrix_t *matrix, MKL_Complex16 *state, MKL_Comp
 
     cblas_zaxpby(side_len, &mkl_ztemp1, work[1], 1, &mkl_ztemp2, work[3], 1);
 
-    terms = 0;
-    while (fabs(2.0 * jn(terms, alpha)) > 1e-17) {
-        terms++;
-    }
+    terms = cheby_terms(alpha, tolerance);
 
     EmEm *= 2.0;
     d2EmEm *= 2.0;
@@ -105,8 +296,10 @@ void spmatrix_expm_cheby(sparse_matrix_t *matrix, MKL_Complex16 *state, MKL_Comp
 
 
     for (i = 2; i <= terms; ++i) {
+        PROFILE_BEGIN(term_mark);
         status = mkl_sparse_z_mv(SPARSE_OPERATION_NON_TRANSPOSE, (MKL_Complex16) {1.0, 0.0}, *matrix, descr, work[1],
                                  (MKL_Complex16) {0.0, 0.0}, work[2]);
+        PROFILE_END(PROFILE_SPMV, term_mark, spmv_bytes(*matrix), 0);
         mkl_error_parse(status, stderr);
 
         mkl_ztemp1.real = creal(EmEm);
@@ -145,9 +338,68 @@ void spmatrix_expm_cheby(sparse_matrix_t *matrix, MKL_Complex16 *state, MKL_Comp
     cblas_zcopy(side_len, work[3], 1, state, 1);
 
 
-    mkl_free(work[3]);
-    mkl_free(work[2]);
-    mkl_free(work[1]);
-    mkl_free(work[0]);
+    for (i = 3; i >= 0; --i) {
+        if (workspace != NULL) {
+            numa_pool_give(workspace, work[i]);
+        } else {
+            numa_free(work[i]);
+        }
+    }
     mkl_free(work);
+    PROFILE_END(PROFILE_MIXER, profile_mark, cheby_bytes(*matrix, side_len, terms), terms);
+}
+
+/**
+ * @brief Determines the number of terms of the Chebyshev expansion for a given argument
+ * @param alpha The (real) argument of the Bessel functions, half the spectral width times the time step
+ * @param tolerance The truncation threshold on the magnitude of a coefficient
+ * @return The index of the first term whose coefficient falls below the tolerance
+ */
+int cheby_terms(double alpha, double tolerance) {
+    int terms = 0;
+    while (fabs(2.0 * jn(terms, alpha)) > tolerance) {
+        terms++;
+    }
+    return terms;
+}
+
+/**
+ * @brief Computes the algorithmic memory traffic of one spmatrix_expm_cheby() call
+ * @param matrix The MKL sparse matrix (CSR)
+ * @param side_len The length of the state vector
+ * @param terms The number of terms used (see cheby_terms())
+ * @return The bytes of 14 vector passes outside the recurrence, 13 per term within it and one SpMV per term
+ */
+long long cheby_bytes(sparse_matrix_t matrix, MKL_INT side_len, int terms) {
+    return (14LL + 13LL * (terms > 1 ? terms - 1 : 0)) * side_len * (long long) sizeof(MKL_Complex16) +
+           (terms > 1 ? terms : 1) * spmv_bytes(matrix);
+}
+
+/**
+ * @brief Computes the algorithmic memory traffic of a CSR sparse matrix-vector product
+ * @param matrix The MKL sparse matrix (CSR)
+ * @return The bytes of values, column indices and row pointers read plus the input and output vectors
+ */
+long long spmv_bytes(sparse_matrix_t matrix) {
+    sparse_index_base_t indexing;
+    MKL_INT rows, cols, *rows_start, *rows_end, *col_indx;
+    MKL_Complex16 *values;
+    mkl_sparse_z_export_csr(matrix, &indexing, &rows, &cols, &rows_start, &rows_end, &col_indx, &values);
+    long long nnz = rows_end[rows - 1] - rows_start[0];
+    return nnz * (long long) (sizeof(MKL_Complex16) + sizeof(MKL_INT)) + (rows + 1LL) * sizeof(MKL_INT) +
+           (rows + (long long) cols) * sizeof(MKL_Complex16);
+}
+
+/**
+ * @brief Computes the algorithmic memory traffic of one spmatrix_expm_product_x() call
+ * @param num_qubits The number of qubits
+ * @param block_length The number of amplitudes per block
+ * @return The bytes of one read and write of the state for the resident pass and for every remaining qubit
+ */
+long long product_bytes(int num_qubits, MKL_INT block_length) {
+    int passes = num_qubits + 1;
+    for (MKL_INT block = 1; block < block_length && passes > 1; block *= 2) {
+        passes--;
+    }
+    return 2LL * passes * ((long long) 1 << num_qubits) * (long long) sizeof(MKL_Complex16);
 }
@@ -9,10 +9,30 @@
 #include <mkl.h>
 #include <mathimf.h>
 #include <complex.h>
+#include <stdbool.h>
+#include "globals.h"
 
-void spmatrix_expm_z_diag(const MKL_Complex16 *diag, double alpha, MKL_INT nnz, MKL_Complex16 *state);
+void spmatrix_expm_z_diag(const cost_vector_t *diag, double alpha, MKL_Complex16 *state);
+
+void spmatrix_expm_z_diag_streamed(const cost_vector_t *diag, double alpha, MKL_Complex16 *state,
+                                   MKL_INT block_length);
+
+void spmatrix_expm_product_x(MKL_Complex16 *state, double beta, int num_qubits, MKL_INT block_length, bool streamed);
+
+void spmatrix_expm_flip_x(MKL_Complex16 *state, double beta, MKL_INT dimension);
+
+void spmatrix_product_x_mv(const MKL_Complex16 *state, MKL_Complex16 *output, int num_qubits, bool symmetric);
 
 void spmatrix_expm_cheby(sparse_matrix_t *matrix, MKL_Complex16 *state, MKL_Complex16 dt,
-                         MKL_Complex16 minE, MKL_Complex16 maxE, MKL_INT side_len);
+                         MKL_Complex16 minE, MKL_Complex16 maxE, MKL_INT side_len, double tolerance,
+                         struct numa_pool *workspace);
+
+int cheby_terms(double alpha, double tolerance);
+
+long long cheby_bytes(sparse_matrix_t matrix, MKL_INT side_len, int terms);
+
+long long product_bytes(int num_qubits, MKL_INT block_length);
+
+long long spmv_bytes(sparse_matrix_t matrix);
 
 #endif //GRAPHSIMILARITY_MATRIX_EXPM_H
@@ -3,7 +3,12 @@
  * @date 20/03/2019
  */
 
+#include <mathimf.h>
+#include <omp.h>
 #include "measurement.h"
+#include "out_of_core.h"
+#include "placement.h"
+#include "cost_vector.h"
 
 /**
  * @brief Performs a binary search on a provided array for a particular target
@@ -35,56 +40,68 @@ MKL_INT binary_search(const double *array, const double target, MKL_INT size) {
     }
 }
 
-/**
- * @brief Returns the original problem hamiltonian as double values
- * @param uc The representation of the problem hamiltonian
- * @param hamiltonian The buffer to hold the final values
- * @param space_dimension The number of candidate solutions considered
- */
-void extract_hamiltonian_double(MKL_Complex16 *uc, double *hamiltonian, MKL_INT space_dimension) {
-    for (int i = 0; i < space_dimension; ++i) {
-        hamiltonian[i] = -uc[i].imag;
-    }
-}
-
 /**
  * @brief Takes a set of probabilites and values where values can hold multiple entries in both arrays and compacts
  * this into two smaller arrays representing the outright probability of each discrete value
+ * @details Each thread accumulates a private histogram over a static partition of the state-space which are then
+ * reduced together, keeping this a single O(N) pass over the state-space. The thread count is capped so that the private
+ * histograms never outgrow the state-vector itself. The values are read from the compact cost vector a block at a time.
  * @param probabilities The probabilities to be compacted
- * @param hamiltonian The values the probabilities correspond to
- * @param values The buffer to hold the resuting compacted values
+ * @param cost The values the probabilities correspond to
+ * @param values The buffer to hold the resuting compacted values (ascending)
  * @param prob_compact The buffer to hold the resulting compacted probabilities
  * @param meta_spec Contains extra simulation data like the largest expected value to encounter
- * @warning The length of values and prob_compact are not checked and need to be large enough to hold all discrete
- * values present
+ * @warning The length of values and prob_compact are not checked and need to be at least cx_range + 1. Values are
+ * assumed to lie in [0, cx_range]
  * @return The number of distinct values present
  */
-MKL_INT compact_probabilities(const double *probabilities, const double *hamiltonian, MKL_INT *values,
+MKL_INT compact_probabilities(const double *probabilities, const cost_vector_t *cost, MKL_INT *values,
                               double *prob_compact, qaoa_data_t *meta_spec) {
     double *sum_vals;
-    bool *set_flag;
     MKL_INT nnz = 0;
+    MKL_INT num_vals = meta_spec->cost_data->cx_range + 1;
+    MKL_INT space_dimension = meta_spec->machine_spec->space_dimension;
+    MKL_INT num_blocks = (space_dimension + COST_BLOCK - 1) / COST_BLOCK;
+    int num_threads = omp_get_max_threads();
 
-    size_t num_vals = (size_t) meta_spec->cost_data->cx_range;
+    if ((double) num_vals * num_threads > (double) space_dimension) {
+        num_threads = (int) (space_dimension / num_vals);
+        num_threads = num_threads < 1 ? 1 : num_threads;
+    }
 
-    sum_vals = mkl_calloc(num_vals, sizeof(double), DEF_ALIGNMENT);
-    set_flag = mkl_calloc(num_vals, sizeof(bool), DEF_ALIGNMENT);
+    sum_vals = mkl_calloc((size_t) num_vals * num_threads, sizeof(double), DEF_ALIGNMENT);
     check_alloc(sum_vals);
-    check_alloc(set_flag);
 
-    for (MKL_INT i = 0; i < meta_spec->machine_spec->space_dimension; ++i) {
-        if (!set_flag[(int) hamiltonian[i] - 1]) {
-            values[nnz] = (MKL_INT) hamiltonian[i];
-            set_flag[(MKL_INT) hamiltonian[i] - 1] = true;
-            nnz++;
+#pragma omp parallel num_threads(num_threads)
+    {
+        double *local_vals = sum_vals + (size_t) omp_get_thread_num() * num_vals;
+        double hamiltonian[COST_BLOCK];
+#pragma omp for schedule(static)
+        for (MKL_INT b = 0; b < num_blocks; ++b) {
+            MKL_INT start = b * COST_BLOCK;
+            MKL_INT length = space_dimension - start < COST_BLOCK ? space_dimension - start : COST_BLOCK;
+            cost_vector_block(cost, start, length, hamiltonian);
+            for (MKL_INT j = 0; j < length; ++j) {
+                local_vals[(MKL_INT) hamiltonian[j]] += probabilities[start + j];
+            }
+        }
+#pragma omp for schedule(static)
+        for (MKL_INT j = 0; j < num_vals; ++j) {
+            for (int t = 1; t < num_threads; ++t) {
+                sum_vals[j] += sum_vals[(size_t) t * num_vals + j];
+            }
         }
-        sum_vals[(MKL_INT) hamiltonian[i] - 1] += probabilities[i];
     }
 
-    vdPackV(nnz, sum_vals, values, prob_compact);
+    for (MKL_INT j = 0; j < num_vals; ++j) {
+        if (sum_vals[j] > 0.0) {
+            values[nnz] = j;
+            prob_compact[nnz] = sum_vals[j];
+            nnz++;
+        }
+    }
 
     mkl_free(sum_vals);
-    mkl_free(set_flag);
     return nnz;
 }
 
@@ -96,27 +113,138 @@ MKL_INT compact_probabilities(const double *probabilities, const double *hamilto
  */
 void cumulate_probabilities(const double *probabilities, double *cumul_probs, MKL_INT nnz) {
     cumul_probs[0] = probabilities[0];
-    for (MKL_INT i = 0; i < nnz; ++i) {
+    for (MKL_INT i = 1; i < nnz; ++i) {
         cumul_probs[i] = cumul_probs[i - 1] + probabilities[i];
     }
 }
 
+/**
+ * @brief Computes the mean of the upper alpha-tail of a weighted set of values
+ * @details Rather than sorting, repeatedly three-way partitions the values around a pivot (quickselect) and only
+ * descends into the side containing the tail threshold, giving an expected cost linear in the number of values.
+ * Values equal to the threshold contribute only the weight required to fill the tail.
+ * @param values The values to be considered, reordered in place
+ * @param weights The normalised weight of each value, reordered alongside values
+ * @param nnz The number of values present
+ * @param alpha The tail fraction in (0, 1]
+ * @return The CVaR-alpha of the weighted values
+ */
+double cvar_select(double *values, double *weights, MKL_INT nnz, double alpha) {
+    MKL_INT first = 0;
+    MKL_INT last = nnz - 1;
+    MKL_INT upper, lower, i;
+    double remaining = alpha;
+    double tail_sum = 0.0;
+    double pivot, temp, upper_weight, upper_sum, equal_weight;
+    while (first <= last) {
+        pivot = values[first + (last - first) / 2];
+        upper_weight = 0.0;
+        upper_sum = 0.0;
+        equal_weight = 0.0;
+        //Partition into [first, upper) > pivot, [upper, lower] == pivot, (lower, last] < pivot
+        upper = first;
+        i = first;
+        lower = last;
+        while (i <= lower) {
+            if (values[i] > pivot) {
+                temp = values[i], values[i] = values[upper], values[upper] = temp;
+                temp = weights[i], weights[i] = weights[upper], weights[upper] = temp;
+                upper_weight += weights[upper];
+                upper_sum += weights[upper] * values[upper];
+                upper++;
+                i++;
+            } else if (values[i] < pivot) {
+                temp = values[i], values[i] = values[lower], values[lower] = temp;
+                temp = weights[i], weights[i] = weights[lower], weights[lower] = temp;
+                lower--;
+            } else {
+                equal_weight += weights[i];
+                i++;
+            }
+        }
+        if (upper_weight >= remaining) {
+            last = upper - 1;
+        } else if (upper_weight + equal_weight >= remaining) {
+            return (tail_sum + upper_sum + (remaining - upper_weight) * pivot) / alpha;
+        } else {
+            tail_sum += upper_sum + equal_weight * pivot;
+            remaining -= upper_weight + equal_weight;
+            first = lower + 1;
+        }
+    }
+    //Only reached when rounding leaves the total weight marginally below alpha
+    return tail_sum / (alpha - remaining);
+}
+
+/**
+ * @brief Computes the Gibbs objective (1/eta)ln(sum w exp(eta v)) of a weighted set of values
+ * @details Shifts by the largest value present before exponentiating so large eta cannot overflow
+ * @param values The values to be considered
+ * @param weights The normalised weight of each value
+ * @param nnz The number of values present
+ * @param eta The inverse temperature, must be positive
+ * @return The Gibbs objective of the weighted values
+ */
+double gibbs_value(const double *values, const double *weights, MKL_INT nnz, double eta) {
+    double shift = -INFINITY;
+    double sum = 0.0;
+    for (MKL_INT i = 0; i < nnz; ++i) {
+        if (weights[i] > 0.0 && values[i] > shift) {
+            shift = values[i];
+        }
+    }
+    for (MKL_INT i = 0; i < nnz; ++i) {
+        sum += weights[i] * exp(eta * (values[i] - shift));
+    }
+    return shift + log(sum) / eta;
+}
+
+/**
+ * @brief Applies the requested objective to a set of sampled values
+ * @param samples The sampled values, reordered in place for the CVaR objective
+ * @param num_samples The number of samples taken
+ * @param sample_sum The sum of all samples taken
+ * @param run_spec Specifies the objective and its parameters
+ * @return The sample mean, CVaR or Gibbs estimate
+ */
+double sample_objective(double *samples, int num_samples, MKL_LONG sample_sum, run_spec_t *run_spec) {
+    double result;
+    double *weights;
+    if (run_spec->objective == OBJECTIVE_EXPECTATION) {
+        return (double) sample_sum / (double) num_samples;
+    }
+    weights = mkl_malloc(num_samples * sizeof(double), DEF_ALIGNMENT);
+    check_alloc(weights);
+    for (int i = 0; i < num_samples; ++i) {
+        weights[i] = 1.0 / num_samples;
+    }
+    if (run_spec->objective == OBJECTIVE_CVAR) {
+        result = cvar_select(samples, weights, num_samples, run_spec->cvar_alpha);
+    } else {
+        result = gibbs_value(samples, weights, num_samples, run_spec->gibbs_eta);
+    }
+    mkl_free(weights);
+    return result;
+}
+
 /**
  * @brief Performs a set of weighted random choices from the vals array according to the probabilities in weights
+ * @details The uniform targets are drawn in one call from a stream owned by the evaluation (see evaluate_batch()).
  * @param vals The values to be sampled
  * @param weights The weightings of these values
  * @param nnz The number of values present
  * @param num_samples The number of samples to take
+ * @param stream The random stream drawn from
  * @param result The buffer to hold the choices
  * @return The sum of the choices made
  */
-MKL_LONG weighted_choices(const MKL_INT *vals, const double *weights, MKL_INT nnz, int num_samples, double *result) {
-    double target;
+MKL_LONG weighted_choices(const MKL_INT *vals, const double *weights, MKL_INT nnz, int num_samples,
+                          VSLStreamStatePtr stream, double *result) {
     MKL_INT temp;
     MKL_LONG sum = 0;
+    check_stream(vdRngUniform(VSL_RNG_METHOD_UNIFORM_STD, stream, num_samples, result, 0.0, 1.0));
     for (int i = 0; i < num_samples; ++i) {
-        target = rand() / (double) RAND_MAX;
-        temp = binary_search(weights, target, nnz);
+        temp = binary_search(weights, result[i], nnz);
         result[i] = vals[temp];
         sum += (MKL_INT) result[i];
     }
@@ -124,54 +252,38 @@ MKL_LONG weighted_choices(const MKL_INT *vals, const double *weights, MKL_INT nn
 }
 
 /**
- * @brief Samples the provided probability distribution returning an estimate of the expectation value
+ * @brief Samples a compacted probability distribution returning an estimate of the expectation value
  * @details Performs a weighted sum by first building a cumulative sum probability array.
- * Then selects meta_spec->run_spec->num_samples. Expectation is the average of these samples, also tracks best
- * individual measurement
- * @param probabilities The probability array to be sampled.
- * @param meta_spec Contains all simulation data including the problem hamiltonian and number of samples.
- * @return
+ * Then selects meta_spec->run_spec->num_samples. The result is the average of these samples (or their CVaR/Gibbs value
+ * if requested), also tracks best individual measurement
+ * @param vals The distinct cost values present (ascending)
+ * @param prob_compact The probability of each value
+ * @param nnz The number of values present
+ * @param meta_spec Contains the number of samples, the objective and the statistics to update
+ * @return The sampled objective
  */
-double sample(double *probabilities, qaoa_data_t *meta_spec) {
+double sample_compact(const MKL_INT *vals, const double *prob_compact, MKL_INT nnz, qaoa_data_t *meta_spec) {
     double expectation;
-    double *hamiltonian = NULL;
-    double *prob_compact = NULL;
     double *cumul_probs = NULL;
     double *samples = NULL;
-    MKL_INT nnz;
     MKL_INT best_sample;
     MKL_INT curr_best;
-    MKL_INT space_dimension = meta_spec->machine_spec->space_dimension;
-    MKL_INT *vals = NULL;
     MKL_LONG sample_sum;
 
-    vals = mkl_malloc(meta_spec->cost_data->cx_range * sizeof(MKL_INT), DEF_ALIGNMENT);
-    prob_compact = mkl_calloc((size_t) meta_spec->cost_data->cx_range, sizeof(double), DEF_ALIGNMENT);
-    hamiltonian = mkl_malloc(space_dimension * sizeof(double), DEF_ALIGNMENT);
-    check_alloc(vals);
-    check_alloc(prob_compact);
-    check_alloc(hamiltonian);
-
-    extract_hamiltonian_double(meta_spec->uc, hamiltonian, space_dimension);
-
-    nnz = compact_probabilities(probabilities, hamiltonian, vals, prob_compact, meta_spec);
-    mkl_free(hamiltonian);
-
     cumul_probs = mkl_calloc((size_t) nnz, sizeof(double), DEF_ALIGNMENT);
     check_alloc(cumul_probs);
 
     cumulate_probabilities(prob_compact, cumul_probs, nnz);
-    mkl_free(prob_compact);
 
     //Allocate samples
     samples = mkl_malloc(meta_spec->run_spec->num_samples * sizeof(double), DEF_ALIGNMENT);
     check_alloc(samples);
 
     //Perform weighted samples
-    sample_sum = weighted_choices(vals, cumul_probs, nnz, meta_spec->run_spec->num_samples, samples);
+    sample_sum = weighted_choices(vals, cumul_probs, nnz, meta_spec->run_spec->num_samples, meta_spec->stream, samples);
 
     //Extract useful data
-    expectation = (double) sample_sum / (double) meta_spec->run_spec->num_samples; // Estimating expectation value
+    expectation = sample_objective(samples, meta_spec->run_spec->num_samples, sample_sum, meta_spec->run_spec);
 
     curr_best = (MKL_INT) samples[cblas_idamax(meta_spec->run_spec->num_samples, samples, 1)];
 
@@ -182,12 +294,41 @@ double sample(double *probabilities, qaoa_data_t *meta_spec) {
 
     best_sample = curr_best;
 
+    shared_lock(meta_spec->batch_lock);
     if (best_sample > meta_spec->qaoa_statistics->best_sample) {
         meta_spec->qaoa_statistics->best_sample = best_sample;
     }
+    shared_unlock(meta_spec->batch_lock);
 
-    mkl_free(vals);
     mkl_free(cumul_probs);
+    mkl_free(samples);
+    return expectation;
+}
+
+/**
+ * @brief Samples the provided probability distribution returning an estimate of the expectation value
+ * @details Compacts the distribution over the distinct cost values and samples it (see sample_compact())
+ * @param probabilities The probability array to be sampled.
+ * @param meta_spec Contains all simulation data including the problem hamiltonian and number of samples.
+ * @return
+ */
+double sample(double *probabilities, qaoa_data_t *meta_spec) {
+    double expectation;
+    double *prob_compact = NULL;
+    MKL_INT nnz;
+    MKL_INT *vals = NULL;
+
+    vals = mkl_malloc((meta_spec->cost_data->cx_range + 1) * sizeof(MKL_INT), DEF_ALIGNMENT);
+    prob_compact = mkl_calloc((size_t) meta_spec->cost_data->cx_range + 1, sizeof(double), DEF_ALIGNMENT);
+    check_alloc(vals);
+    check_alloc(prob_compact);
+
+    nnz = compact_probabilities(probabilities, meta_spec->uc, vals, prob_compact, meta_spec);
+
+    expectation = sample_compact(vals, prob_compact, nnz, meta_spec);
+
+    mkl_free(vals);
+    mkl_free(prob_compact);
     return expectation;
 }
 
@@ -198,14 +339,162 @@ double sample(double *probabilities, qaoa_data_t *meta_spec) {
  * @return Double value which is the expectation value of measurement
  */
 double expectation_value(double *probabilities, qaoa_data_t *meta_spec) {
-    double expectation;
-    double *hamiltonian = NULL;
+    double expectation = 0.0;
     MKL_INT space_dimension = meta_spec->machine_spec->space_dimension;
+    MKL_INT num_blocks = (space_dimension + COST_BLOCK - 1) / COST_BLOCK;
 
-    hamiltonian = mkl_malloc(space_dimension * sizeof(double), DEF_ALIGNMENT);
-    extract_hamiltonian_double(meta_spec->uc, hamiltonian, space_dimension);
-    expectation = cblas_ddot(space_dimension, probabilities, 1, hamiltonian, 1);
-
-    mkl_free(hamiltonian);
+#pragma omp parallel for schedule(static) reduction(+:expectation)
+    for (MKL_INT b = 0; b < num_blocks; ++b) {
+        double hamiltonian[COST_BLOCK];
+        MKL_INT start = b * COST_BLOCK;
+        MKL_INT length = space_dimension - start < COST_BLOCK ? space_dimension - start : COST_BLOCK;
+        cost_vector_block(meta_spec->uc, start, length, hamiltonian);
+        for (MKL_INT j = 0; j < length; ++j) {
+            expectation += probabilities[start + j] * hamiltonian[j];
+        }
+    }
     return expectation;
-}
\ No newline at end of file
+}
+/**
+ * @brief Applies the CVaR or Gibbs objective to a compacted probability distribution
+ * @param vals The distinct cost values present
+ * @param prob_compact The probability of each value, reordered in place for the CVaR objective
+ * @param nnz The number of values present
+ * @param run_spec Specifies the objective and its parameters
+ * @return The CVaR or Gibbs value of the distribution
+ */
+double compact_objective(const MKL_INT *vals, double *prob_compact, MKL_INT nnz, run_spec_t *run_spec) {
+    double result;
+    double *class_values = mkl_malloc(nnz * sizeof(double), DEF_ALIGNMENT);
+    check_alloc(class_values);
+    for (MKL_INT i = 0; i < nnz; ++i) {
+        class_values[i] = (double) vals[i];
+    }
+
+    if (run_spec->objective == OBJECTIVE_CVAR) {
+        result = cvar_select(class_values, prob_compact, nnz, run_spec->cvar_alpha);
+    } else {
+        result = gibbs_value(class_values, prob_compact, nnz, run_spec->gibbs_eta);
+    }
+
+    mkl_free(class_values);
+    return result;
+}
+
+/**
+ * @brief Determines the exact value of the requested objective with respect to the problem Hamiltonian
+ * @details The CVaR and Gibbs objectives are computed over the distinct cost classes present rather than over the
+ * full state-space, using a linear-time selection for the CVaR threshold
+ * @param probabilities The measurement probabilities of the state-vector
+ * @param meta_spec The data-structure containing relevant information
+ * @return The expectation, CVaR or Gibbs value of measurement
+ */
+double objective_value(double *probabilities, qaoa_data_t *meta_spec) {
+    double result;
+    double *prob_compact = NULL;
+    MKL_INT *vals = NULL;
+    MKL_INT nnz;
+
+    if (meta_spec->run_spec->objective == OBJECTIVE_EXPECTATION) {
+        return expectation_value(probabilities, meta_spec);
+    }
+
+    vals = mkl_malloc((meta_spec->cost_data->cx_range + 1) * sizeof(MKL_INT), DEF_ALIGNMENT);
+    prob_compact = mkl_calloc((size_t) meta_spec->cost_data->cx_range + 1, sizeof(double), DEF_ALIGNMENT);
+    check_alloc(vals);
+    check_alloc(prob_compact);
+
+    nnz = compact_probabilities(probabilities, meta_spec->uc, vals, prob_compact, meta_spec);
+
+    result = compact_objective(vals, prob_compact, nnz, meta_spec->run_spec);
+
+    mkl_free(prob_compact);
+    mkl_free(vals);
+    return result;
+}
+
+/**
+ * @brief Determines the requested (exact or sampled) objective directly from the state-vector, one block at a time
+ * @details Used when the state and cost vectors are memory-mapped (out-of-core) so that neither the probabilities nor
+ * the hamiltonian are ever materialised in full. The expectation value is a single streamed reduction; otherwise the
+ * probabilities are accumulated into a histogram over the cost values (which must fit in memory) and compacted.
+ * @param state The complex state-vector
+ * @param meta_spec The data-structure containing relevant information
+ * @return The expectation, CVaR or Gibbs value of measurement (exact or sampled)
+ * @warning Cost values are assumed to lie in [0, cx_range] unless computing the exact expectation value
+ */
+double streamed_objective(const MKL_Complex16 *state, qaoa_data_t *meta_spec) {
+    double result = 0.0;
+    double *histogram;
+    double *prob_compact;
+    MKL_INT *vals;
+    MKL_INT nnz = 0;
+    MKL_INT num_vals = meta_spec->cost_data->cx_range + 1;
+    MKL_INT space_dimension = meta_spec->machine_spec->space_dimension;
+    MKL_INT block_length = meta_spec->run_spec->block_length;
+    const cost_vector_t *uc = meta_spec->uc;
+    size_t cost_size = cost_type_size(uc->type);
+
+    if (meta_spec->run_spec->objective == OBJECTIVE_EXPECTATION && !meta_spec->run_spec->sampling) {
+        for (MKL_INT start = 0; start < space_dimension; start += block_length) {
+            MKL_INT end = start + block_length < space_dimension ? start + block_length : space_dimension;
+            MKL_INT ahead = end + block_length < space_dimension ? block_length : space_dimension - end;
+            MKL_INT num_blocks = (end - start + COST_BLOCK - 1) / COST_BLOCK;
+            ooc_prefetch(state + end, ahead * sizeof(MKL_Complex16));
+            ooc_prefetch(cost_vector_address(uc, end), ahead * cost_size);
+#pragma omp parallel for schedule(static) reduction(+:result)
+            for (MKL_INT b = 0; b < num_blocks; ++b) {
+                double hamiltonian[COST_BLOCK];
+                MKL_INT first = start + b * COST_BLOCK;
+                MKL_INT length = end - first < COST_BLOCK ? end - first : COST_BLOCK;
+                cost_vector_block(uc, first, length, hamiltonian);
+                for (MKL_INT j = 0; j < length; ++j) {
+                    MKL_INT i = first + j;
+                    result += (state[i].real * state[i].real + state[i].imag * state[i].imag) * hamiltonian[j];
+                }
+            }
+        }
+        return result;
+    }
+
+    histogram = mkl_calloc((size_t) num_vals, sizeof(double), DEF_ALIGNMENT);
+    check_alloc(histogram);
+    for (MKL_INT start = 0; start < space_dimension; start += block_length) {
+        MKL_INT end = start + block_length < space_dimension ? start + block_length : space_dimension;
+        MKL_INT ahead = end + block_length < space_dimension ? block_length : space_dimension - end;
+        ooc_prefetch(state + end, ahead * sizeof(MKL_Complex16));
+        ooc_prefetch(cost_vector_address(uc, end), ahead * cost_size);
+        for (MKL_INT first = start; first < end; first += COST_BLOCK) {
+            double hamiltonian[COST_BLOCK];
+            MKL_INT length = end - first < COST_BLOCK ? end - first : COST_BLOCK;
+            cost_vector_block(uc, first, length, hamiltonian);
+            for (MKL_INT j = 0; j < length; ++j) {
+                MKL_INT i = first + j;
+                histogram[(MKL_INT) hamiltonian[j]] += state[i].real * state[i].real + state[i].imag * state[i].imag;
+            }
+        }
+    }
+
+    vals = mkl_malloc(num_vals * sizeof(MKL_INT), DEF_ALIGNMENT);
+    prob_compact = mkl_malloc(num_vals * sizeof(double), DEF_ALIGNMENT);
+    check_alloc(vals);
+    check_alloc(prob_compact);
+    for (MKL_INT j = 0; j < num_vals; ++j) {
+        if (histogram[j] > 0.0) {
+            vals[nnz] = j;
+            prob_compact[nnz] = histogram[j];
+            nnz++;
+        }
+    }
+    mkl_free(histogram);
+
+    if (meta_spec->run_spec->sampling) {
+        result = sample_compact(vals, prob_compact, nnz, meta_spec);
+    } else {
+        result = compact_objective(vals, prob_compact, nnz, meta_spec->run_spec);
+    }
+
+    mkl_free(vals);
+    mkl_free(prob_compact);
+    return result;
+}
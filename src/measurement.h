@@ -13,4 +13,12 @@ double sample(double *probabilities, qaoa_data_t *meta_spec);
 
 double expectation_value(double *probabilities, qaoa_data_t *meta_spec);
 
+double objective_value(double *probabilities, qaoa_data_t *meta_spec);
+
+double streamed_objective(const MKL_Complex16 *state, qaoa_data_t *meta_spec);
+
+double cvar_select(double *values, double *weights, MKL_INT nnz, double alpha);
+
+double gibbs_value(const double *values, const double *weights, MKL_INT nnz, double eta);
+
 #endif //QOLAB_SAMPLING_H
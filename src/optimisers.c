@@ -0,0 +1,513 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Built-in optimisers whose iterations produce batches of points, evaluated together
+ */
+
+#include <limits.h>
+#include <mathimf.h>
+#include <omp.h>
+#include "optimisers.h"
+#include "state_evolve.h"
+#include "placement.h"
+#include "profiling.h"
+
+/**
+ * @brief Clamps a point to the bounds of the optimiser
+ * @param optimiser Contains the bounds
+ * @param point The point to be clamped in place
+ */
+void clip_point(native_optimiser_t *optimiser, double *point) {
+    for (int j = 0; j < optimiser->num_params; ++j) {
+        if (point[j] < optimiser->lower_bounds[j]) {
+            point[j] = optimiser->lower_bounds[j];
+        } else if (point[j] > optimiser->upper_bounds[j]) {
+            point[j] = optimiser->upper_bounds[j];
+        }
+    }
+}
+
+/**
+ * @brief Asks for a symmetric pair of points about the mean along a random +-1 direction
+ * @details Used by SPSA and by Adam when no analytic gradient is available
+ * @param optimiser The optimiser asking for points
+ */
+void perturbation_ask(native_optimiser_t *optimiser) {
+    int n = optimiser->num_params;
+    double c_k = optimiser->perturbation / pow(optimiser->iteration + 1, 0.101);
+    vdRngUniform(VSL_RNG_METHOD_UNIFORM_STD, optimiser->stream, n, optimiser->direction, 0.0, 1.0);
+    for (int j = 0; j < n; ++j) {
+        optimiser->direction[j] = optimiser->direction[j] < 0.5 ? -1.0 : 1.0;
+        optimiser->points[j] = optimiser->mean[j] + c_k * optimiser->direction[j];
+        optimiser->points[j + n] = optimiser->mean[j] - c_k * optimiser->direction[j];
+    }
+    clip_point(optimiser, optimiser->points);
+    clip_point(optimiser, optimiser->points + n);
+}
+
+/**
+ * @brief Estimates the gradient from the values of a symmetric pair of points
+ * @details Divides by the realised (post-clipping) distance, coordinates clipped onto the same value get no estimate
+ * @param optimiser The optimiser holding the evaluated pair
+ * @param gradient The buffer to hold the estimate
+ */
+void perturbation_gradient(native_optimiser_t *optimiser, double *gradient) {
+    int n = optimiser->num_params;
+    double distance;
+    for (int j = 0; j < n; ++j) {
+        distance = optimiser->points[j] - optimiser->points[j + n];
+        gradient[j] = distance != 0.0 ? (optimiser->values[0] - optimiser->values[1]) / distance : 0.0;
+    }
+}
+
+/**
+ * @brief Moves the mean by a step, respecting the bounds, and records the size of the step taken
+ * @param optimiser The optimiser to be moved
+ * @param step The step to be taken
+ */
+void take_step(native_optimiser_t *optimiser, const double *step) {
+    double previous, norm = 0.0;
+    for (int j = 0; j < optimiser->num_params; ++j) {
+        previous = optimiser->mean[j];
+        optimiser->mean[j] += step[j];
+        optimiser->mean[j] = optimiser->mean[j] < optimiser->lower_bounds[j] ? optimiser->lower_bounds[j] :
+                             optimiser->mean[j];
+        optimiser->mean[j] = optimiser->mean[j] > optimiser->upper_bounds[j] ? optimiser->upper_bounds[j] :
+                             optimiser->mean[j];
+        norm += fabs(optimiser->mean[j] - previous);
+    }
+    optimiser->step_norm = norm;
+}
+
+/**
+ * @brief Performs an SPSA update (https://doi.org/10.1109/9.119632) with the standard gain sequences
+ * @param optimiser The optimiser holding the evaluated pair
+ * @param step Workspace of num_params length
+ */
+void spsa_tell(native_optimiser_t *optimiser, double *step) {
+    double a_k = optimiser->step_size / pow(optimiser->iteration + 1 + optimiser->stability, 0.602);
+    perturbation_gradient(optimiser, step);
+    cblas_dscal(optimiser->num_params, a_k, step, 1);
+    take_step(optimiser, step);
+}
+
+/**
+ * @brief Performs an Adam update (https://arxiv.org/abs/1412.6980) for maximisation
+ * @param optimiser The optimiser holding the evaluated point(s)
+ * @param step Workspace of num_params length
+ */
+void adam_tell(native_optimiser_t *optimiser, double *step) {
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    double correction1 = 1.0 - pow(beta1, optimiser->iteration + 1);
+    double correction2 = 1.0 - pow(beta2, optimiser->iteration + 1);
+    if (optimiser->analytic_gradient) {
+        cblas_dcopy(optimiser->num_params, optimiser->gradients, 1, step, 1);
+    } else {
+        perturbation_gradient(optimiser, step);
+    }
+    for (int j = 0; j < optimiser->num_params; ++j) {
+        optimiser->moment1[j] = beta1 * optimiser->moment1[j] + (1.0 - beta1) * step[j];
+        optimiser->moment2[j] = beta2 * optimiser->moment2[j] + (1.0 - beta2) * step[j] * step[j];
+        step[j] = optimiser->step_size * (optimiser->moment1[j] / correction1) /
+                  (sqrt(optimiser->moment2[j] / correction2) + epsilon);
+    }
+    take_step(optimiser, step);
+}
+
+/**
+ * @brief Samples a CMA-ES population about the mean
+ * @details Steps which leave the bounds are repaired by clamping, the repaired step is what the update sees
+ * @param optimiser The optimiser asking for points
+ * @param z Workspace of num_params length
+ */
+void cmaes_ask(native_optimiser_t *optimiser, double *z) {
+    int n = optimiser->num_params;
+    double *point, *direction;
+    for (int k = 0; k < optimiser->batch_size; ++k) {
+        point = optimiser->points + k * n;
+        direction = optimiser->direction + k * n;
+        vdRngGaussian(VSL_RNG_METHOD_GAUSSIAN_ICDF, optimiser->stream, n, z, 0.0, 1.0);
+        vdMul(n, z, optimiser->eigenvalues, z);
+        cblas_dgemv(CblasRowMajor, CblasNoTrans, n, n, 1.0, optimiser->eigenvectors, n, z, 1, 0.0, direction, 1);
+        for (int j = 0; j < n; ++j) {
+            point[j] = optimiser->mean[j] + optimiser->sigma * direction[j];
+        }
+        clip_point(optimiser, point);
+        for (int j = 0; j < n; ++j) {
+            direction[j] = (point[j] - optimiser->mean[j]) / optimiser->sigma;
+        }
+    }
+}
+
+/**
+ * @brief Performs a (mu/mu_w, lambda)-CMA-ES update with rank-one and rank-mu covariance adaptation
+ * @details Follows the default strategy parameters of https://arxiv.org/abs/1604.00772. The covariance is
+ * re-decomposed every iteration, which is cheap at QAOA parameter counts.
+ * @param optimiser The optimiser holding the evaluated population
+ * @param step Workspace of num_params length
+ */
+void cmaes_tell(native_optimiser_t *optimiser, double *step) {
+    int n = optimiser->num_params;
+    int mu = optimiser->batch_size / 2 > 0 ? optimiser->batch_size / 2 : 1;
+    int *order = mkl_malloc(optimiser->batch_size * sizeof(int), DEF_ALIGNMENT);
+    double *work = mkl_malloc(n * sizeof(double), DEF_ALIGNMENT);
+    double mu_eff, c_s, d_s, c_c, c_1, c_mu, chi_n, norm_s, h_sig, temp;
+    int swap;
+    check_alloc(order);
+    check_alloc(work);
+
+    mu_eff = 1.0 / cblas_ddot(mu, optimiser->weights, 1, optimiser->weights, 1);
+    c_s = (mu_eff + 2.0) / (n + mu_eff + 5.0);
+    d_s = 1.0 + 2.0 * fmax(0.0, sqrt((mu_eff - 1.0) / (n + 1.0)) - 1.0) + c_s;
+    c_c = (4.0 + mu_eff / n) / (n + 4.0 + 2.0 * mu_eff / n);
+    c_1 = 2.0 / ((n + 1.3) * (n + 1.3) + mu_eff);
+    c_mu = fmin(1.0 - c_1, 2.0 * (mu_eff - 2.0 + 1.0 / mu_eff) / ((n + 2.0) * (n + 2.0) + mu_eff));
+    chi_n = sqrt((double) n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+    //Rank the population, best (largest) first
+    for (int k = 0; k < optimiser->batch_size; ++k) {
+        order[k] = k;
+    }
+    for (int k = 1; k < optimiser->batch_size; ++k) {
+        for (int l = k; l > 0 && optimiser->values[order[l]] > optimiser->values[order[l - 1]]; --l) {
+            swap = order[l], order[l] = order[l - 1], order[l - 1] = swap;
+        }
+    }
+
+    //Recombination
+    for (int j = 0; j < n; ++j) {
+        step[j] = 0.0;
+    }
+    for (int i = 0; i < mu; ++i) {
+        cblas_daxpy(n, optimiser->weights[i], optimiser->direction + order[i] * n, 1, step, 1);
+    }
+    for (int j = 0; j < n; ++j) {
+        work[j] = optimiser->sigma * step[j];
+    }
+    take_step(optimiser, work);
+
+    //Step-size path uses C^(-1/2) y_w = B D^-1 B^T y_w
+    cblas_dgemv(CblasRowMajor, CblasTrans, n, n, 1.0, optimiser->eigenvectors, n, step, 1, 0.0, work, 1);
+    vdDiv(n, work, optimiser->eigenvalues, work);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, n, n, sqrt(c_s * (2.0 - c_s) * mu_eff), optimiser->eigenvectors, n,
+                work, 1, 1.0 - c_s, optimiser->path_s, 1);
+    norm_s = cblas_dnrm2(n, optimiser->path_s, 1);
+    h_sig = norm_s / sqrt(1.0 - pow(1.0 - c_s, 2.0 * (optimiser->iteration + 1))) / chi_n < 1.4 + 2.0 / (n + 1.0) ?
+            1.0 : 0.0;
+    cblas_dscal(n, 1.0 - c_c, optimiser->path_c, 1);
+    cblas_daxpy(n, h_sig * sqrt(c_c * (2.0 - c_c) * mu_eff), step, 1, optimiser->path_c, 1);
+
+    //Covariance update
+    temp = 1.0 - c_1 - c_mu + c_1 * (1.0 - h_sig) * c_c * (2.0 - c_c);
+    for (int j = 0; j < n; ++j) {
+        for (int l = 0; l < n; ++l) {
+            optimiser->covariance[j * n + l] = temp * optimiser->covariance[j * n + l] +
+                                               c_1 * optimiser->path_c[j] * optimiser->path_c[l];
+            for (int i = 0; i < mu; ++i) {
+                optimiser->covariance[j * n + l] += c_mu * optimiser->weights[i] *
+                                                    optimiser->direction[order[i] * n + j] *
+                                                    optimiser->direction[order[i] * n + l];
+            }
+        }
+    }
+    optimiser->sigma *= exp((c_s / d_s) * (norm_s / chi_n - 1.0));
+
+    //Re-decompose C = B D^2 B^T
+    cblas_dcopy(n * n, optimiser->covariance, 1, optimiser->eigenvectors, 1);
+    if (LAPACKE_dsyev(LAPACK_ROW_MAJOR, 'V', 'U', n, optimiser->eigenvectors, n, optimiser->eigenvalues) != 0) {
+        fprintf(stderr, "CMA-ES covariance decomposition failed\n");
+        exit(EXIT_FAILURE);
+    }
+    temp = 0.0;
+    for (int j = 0; j < n; ++j) {
+        optimiser->eigenvalues[j] = sqrt(fmax(optimiser->eigenvalues[j], 1e-20));
+        temp = fmax(temp, optimiser->eigenvalues[j]);
+    }
+    //Converged once the whole search distribution is within tolerance
+    optimiser->step_norm = fmax(optimiser->step_norm, optimiser->sigma * temp);
+
+    mkl_free(work);
+    mkl_free(order);
+}
+
+/**
+ * @brief Allocates and initialises a built-in optimiser
+ * @details Unset (zero) step sizes and population sizes are replaced with conventional defaults.
+ * @param optimiser The optimiser to be initialised
+ * @param opt_spec Contains the method, hyper-parameters, bounds and evaluation budget
+ * @param num_params The dimension of the search space
+ * @param analytic_gradient Whether evaluations can return exact gradients
+ * @param seed Seeds the optimiser's own stream of perturbations and populations
+ * @warning The mean is left uninitialised and must be set by the caller
+ */
+void native_optimiser_create(native_optimiser_t *optimiser, optimization_spec_t *opt_spec, int num_params,
+                             bool analytic_gradient, MKL_UINT seed) {
+    int n = num_params;
+    int mu;
+    double weight_sum = 0.0;
+    optimiser->type = opt_spec->optimiser_type;
+    optimiser->num_params = n;
+    optimiser->iteration = 0;
+    optimiser->analytic_gradient = analytic_gradient && optimiser->type == OPTIMISER_ADAM;
+    optimiser->lower_bounds = opt_spec->lower_bounds;
+    optimiser->upper_bounds = opt_spec->upper_bounds;
+    optimiser->perturbation = opt_spec->perturbation > 0.0 ? opt_spec->perturbation : 0.1;
+    optimiser->step_norm = INFINITY;
+    optimiser->gradients = NULL;
+    optimiser->moment1 = NULL;
+    optimiser->moment2 = NULL;
+    optimiser->covariance = NULL;
+    optimiser->eigenvectors = NULL;
+    optimiser->eigenvalues = NULL;
+    optimiser->path_c = NULL;
+    optimiser->path_s = NULL;
+    optimiser->weights = NULL;
+    optimiser->sigma = 0.0;
+
+    switch (optimiser->type) {
+        case OPTIMISER_SPSA:
+            optimiser->batch_size = 2;
+            optimiser->step_size = opt_spec->step_size > 0.0 ? opt_spec->step_size : 0.2;
+            break;
+        case OPTIMISER_ADAM:
+            optimiser->batch_size = optimiser->analytic_gradient ? 1 : 2;
+            optimiser->step_size = opt_spec->step_size > 0.0 ? opt_spec->step_size : 0.05;
+            break;
+        case OPTIMISER_CMAES:
+            optimiser->batch_size = opt_spec->population > 1 ? opt_spec->population : 4 + (int) (3.0 * log(n));
+            optimiser->step_size = opt_spec->step_size > 0.0 ? opt_spec->step_size : 0.5;
+            break;
+        default:
+            fprintf(stderr, "Not a built-in optimiser\n");
+            exit(EXIT_FAILURE);
+    }
+    //SPSA stability constant, 10% of the iterations available
+    optimiser->stability = 0.1 * opt_spec->max_evals / optimiser->batch_size;
+
+    optimiser->mean = mkl_calloc((size_t) n, sizeof(double), DEF_ALIGNMENT);
+    optimiser->points = mkl_calloc((size_t) optimiser->batch_size * n, sizeof(double), DEF_ALIGNMENT);
+    optimiser->values = mkl_calloc((size_t) optimiser->batch_size, sizeof(double), DEF_ALIGNMENT);
+    optimiser->direction = mkl_calloc((size_t) optimiser->batch_size * n, sizeof(double), DEF_ALIGNMENT);
+    check_alloc(optimiser->mean);
+    check_alloc(optimiser->points);
+    check_alloc(optimiser->values);
+    check_alloc(optimiser->direction);
+
+    if (optimiser->analytic_gradient) {
+        optimiser->gradients = mkl_calloc((size_t) optimiser->batch_size * n, sizeof(double), DEF_ALIGNMENT);
+        check_alloc(optimiser->gradients);
+    }
+    if (optimiser->type == OPTIMISER_ADAM) {
+        optimiser->moment1 = mkl_calloc((size_t) n, sizeof(double), DEF_ALIGNMENT);
+        optimiser->moment2 = mkl_calloc((size_t) n, sizeof(double), DEF_ALIGNMENT);
+        check_alloc(optimiser->moment1);
+        check_alloc(optimiser->moment2);
+    }
+    if (optimiser->type == OPTIMISER_CMAES) {
+        mu = optimiser->batch_size / 2 > 0 ? optimiser->batch_size / 2 : 1;
+        optimiser->sigma = optimiser->step_size;
+        optimiser->covariance = mkl_calloc((size_t) n * n, sizeof(double), DEF_ALIGNMENT);
+        optimiser->eigenvectors = mkl_calloc((size_t) n * n, sizeof(double), DEF_ALIGNMENT);
+        optimiser->eigenvalues = mkl_calloc((size_t) n, sizeof(double), DEF_ALIGNMENT);
+        optimiser->path_c = mkl_calloc((size_t) n, sizeof(double), DEF_ALIGNMENT);
+        optimiser->path_s = mkl_calloc((size_t) n, sizeof(double), DEF_ALIGNMENT);
+        optimiser->weights = mkl_calloc((size_t) mu, sizeof(double), DEF_ALIGNMENT);
+        check_alloc(optimiser->covariance);
+        check_alloc(optimiser->eigenvectors);
+        check_alloc(optimiser->eigenvalues);
+        check_alloc(optimiser->path_c);
+        check_alloc(optimiser->path_s);
+        check_alloc(optimiser->weights);
+        for (int j = 0; j < n; ++j) {
+            optimiser->covariance[j * n + j] = 1.0;
+            optimiser->eigenvectors[j * n + j] = 1.0;
+            optimiser->eigenvalues[j] = 1.0;
+        }
+        for (int i = 0; i < mu; ++i) {
+            optimiser->weights[i] = log(mu + 0.5) - log(i + 1.0);
+            weight_sum += optimiser->weights[i];
+        }
+        cblas_dscal(mu, 1.0 / weight_sum, optimiser->weights, 1);
+    }
+
+    vslNewStream(&optimiser->stream, VSL_BRNG_MT19937, seed);
+}
+
+/**
+ * @brief Fills the optimiser's batch of points to be evaluated this iteration
+ * @param optimiser The optimiser in question
+ */
+void native_optimiser_ask(native_optimiser_t *optimiser) {
+    double *z;
+    switch (optimiser->type) {
+        case OPTIMISER_ADAM:
+            if (optimiser->analytic_gradient) {
+                cblas_dcopy(optimiser->num_params, optimiser->mean, 1, optimiser->points, 1);
+                break;
+            }
+            perturbation_ask(optimiser);
+            break;
+        case OPTIMISER_CMAES:
+            z = mkl_malloc(optimiser->num_params * sizeof(double), DEF_ALIGNMENT);
+            check_alloc(z);
+            cmaes_ask(optimiser, z);
+            mkl_free(z);
+            break;
+        default:
+            perturbation_ask(optimiser);
+            break;
+    }
+}
+
+/**
+ * @brief Updates the optimiser from the values (and gradients) of its evaluated batch
+ * @param optimiser The optimiser in question
+ */
+void native_optimiser_tell(native_optimiser_t *optimiser) {
+    double *step = mkl_malloc(optimiser->num_params * sizeof(double), DEF_ALIGNMENT);
+    check_alloc(step);
+    switch (optimiser->type) {
+        case OPTIMISER_ADAM:
+            adam_tell(optimiser, step);
+            break;
+        case OPTIMISER_CMAES:
+            cmaes_tell(optimiser, step);
+            break;
+        default:
+            spsa_tell(optimiser, step);
+            break;
+    }
+    optimiser->iteration++;
+    mkl_free(step);
+}
+
+/**
+ * @brief De-allocates all memory associated with a built-in optimiser
+ * @param optimiser The optimiser in question
+ */
+void native_optimiser_destroy(native_optimiser_t *optimiser) {
+    vslDeleteStream(&optimiser->stream);
+    mkl_free(optimiser->mean);
+    mkl_free(optimiser->points);
+    mkl_free(optimiser->values);
+    mkl_free(optimiser->direction);
+    mkl_free(optimiser->gradients);
+    mkl_free(optimiser->moment1);
+    mkl_free(optimiser->moment2);
+    mkl_free(optimiser->covariance);
+    mkl_free(optimiser->eigenvectors);
+    mkl_free(optimiser->eigenvalues);
+    mkl_free(optimiser->path_c);
+    mkl_free(optimiser->path_s);
+    mkl_free(optimiser->weights);
+}
+
+/**
+ * @brief Evaluates a batch of points concurrently
+ * @details Points are spread over the available cores, each with a share of the MKL and OpenMP threads. Every
+ * evaluation is recorded and reported through the usual objective path, the points sharing the run's statistics under
+ * meta_spec->batch_lock. A sampled objective draws from a stream of its own, seeded in order from the run's stream,
+ * so the samples do not depend on the order the points finish in or the number of cores.
+ * @param meta_spec Data structure containing all simulation information
+ * @param points The points to be evaluated (num_points * num_params)
+ * @param num_points The number of points in the batch
+ * @param num_params The number of parameters of each point
+ * @param values The buffer to hold the value of each point
+ * @param gradients The buffer to hold the gradient at each point (NULL if not required)
+ */
+void evaluate_batch(qaoa_data_t *meta_spec, const double *points, int num_points, int num_params, double *values,
+                    double *gradients) {
+    int num_cores = mkl_get_max_threads();
+    int concurrent = num_points < num_cores ? num_points : num_cores;
+    int threads_per_point = num_cores / concurrent;
+    int max_levels = omp_get_max_active_levels();
+    bool outermost = omp_get_active_level() == 0;
+    int *seeds = NULL;
+    omp_lock_t lock;
+
+    if (meta_spec->run_spec->sampling) {
+        seeds = mkl_malloc(num_points * sizeof(int), DEF_ALIGNMENT);
+        check_alloc(seeds);
+        check_stream(viRngUniform(VSL_RNG_METHOD_UNIFORM_STD, meta_spec->stream, num_points, seeds, 0, INT_MAX));
+    }
+    omp_init_lock(&lock);
+    meta_spec->batch_lock = concurrent > 1 ? &lock : NULL;
+    if (outermost) {
+        mkl_set_dynamic(0);
+        omp_set_max_active_levels(2);
+    }
+#pragma omp parallel for num_threads(concurrent) schedule(dynamic, 1)
+    for (int k = 0; k < num_points; ++k) {
+        omp_set_num_threads(threads_per_point);
+        int previous = mkl_set_num_threads_local(threads_per_point);
+        if (outermost) {
+            bind_group(meta_spec->run_spec->binding, omp_get_thread_num(), threads_per_point);
+        }
+        qaoa_data_t point = *meta_spec;
+        if (seeds != NULL) {
+            check_stream(vslNewStream(&point.stream, VSL_BRNG_PHILOX4X32X10, (MKL_UINT) seeds[k]));
+        }
+        PROFILE_ATTACH(point_profile, point.profile);
+        values[k] = qaoa_objective((unsigned) num_params, points + k * num_params,
+                                   gradients == NULL ? NULL : gradients + k * num_params, &point);
+        PROFILE_DETACH(point_profile);
+        if (seeds != NULL) {
+            vslDeleteStream(&point.stream);
+        }
+        mkl_set_num_threads_local(previous);
+    }
+    if (outermost) {
+        omp_set_max_active_levels(max_levels);
+        bind_threads(meta_spec->run_spec->binding);
+    }
+    meta_spec->batch_lock = NULL;
+    omp_destroy_lock(&lock);
+    mkl_free(seeds);
+}
+
+/**
+ * @brief Runs the built-in optimiser selected in the optimisation specification
+ * @details Iterates ask, evaluate, tell until the evaluation budget cannot fit another batch or the mean stops
+ * moving. The best point ever evaluated is returned, matching the behaviour of nlopt's derivative-free methods.
+ * @param meta_spec Data structure containing all simulation information
+ * @param parameters The initial point, overwritten with the best point found
+ * @param result The best value found
+ * @return An nlopt termination code describing why the optimiser stopped
+ */
+nlopt_result native_optimise(qaoa_data_t *meta_spec, double *parameters, double *result) {
+    native_optimiser_t optimiser;
+    int num_params = parameter_count(meta_spec);
+    int num_evals = 0;
+    int seed;
+    nlopt_result status = NLOPT_MAXEVAL_REACHED;
+
+    viRngUniform(VSL_RNG_METHOD_UNIFORM_STD, meta_spec->stream, 1, &seed, 0, INT_MAX);
+    native_optimiser_create(&optimiser, meta_spec->opt_spec, num_params, gradient_available(meta_spec),
+                            (MKL_UINT) seed);
+    cblas_dcopy(num_params, parameters, 1, optimiser.mean, 1);
+    *result = -INFINITY;
+
+    while (num_evals + optimiser.batch_size <= meta_spec->opt_spec->max_evals) {
+        native_optimiser_ask(&optimiser);
+        evaluate_batch(meta_spec, optimiser.points, optimiser.batch_size, num_params, optimiser.values,
+                       optimiser.gradients);
+        num_evals += optimiser.batch_size;
+        for (int k = 0; k < optimiser.batch_size; ++k) {
+            if (optimiser.values[k] > *result) {
+                *result = optimiser.values[k];
+                cblas_dcopy(num_params, optimiser.points + k * num_params, 1, parameters, 1);
+            }
+        }
+        native_optimiser_tell(&optimiser);
+        if (optimiser.step_norm < meta_spec->opt_spec->xtol) {
+            status = NLOPT_XTOL_REACHED;
+            break;
+        }
+    }
+    if (num_evals == 0) {
+        *result = qaoa_objective((unsigned) num_params, parameters, NULL, meta_spec);
+    }
+
+    native_optimiser_destroy(&optimiser);
+    return status;
+}
@@ -0,0 +1,57 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ */
+
+#ifndef QOLAB_OPTIMISERS_H
+#define QOLAB_OPTIMISERS_H
+
+#include <mkl.h>
+#include <stdbool.h>
+#include "globals.h"
+
+/*! The state of a built-in batched optimiser
+ *
+ * Each iteration asks for a batch of points, which are evaluated together before being told back to the optimiser. */
+typedef struct {
+    optimiser_t type;           /**< The optimisation method */
+    int num_params;             /**< The dimension of the search space */
+    int batch_size;             /**< The number of points asked for every iteration */
+    int iteration;              /**< The number of completed iterations */
+    bool analytic_gradient;     /**< Whether evaluations also return exact gradients (Adam only) */
+    const double *lower_bounds; /**< The lower bounds of every parameter */
+    const double *upper_bounds; /**< The upper bounds of every parameter */
+    double *mean;               /**< The current iterate (or distribution mean for CMA-ES) */
+    double *points;             /**< The batch of points to be evaluated (batch_size * num_params) */
+    double *values;             /**< The objective value of each point in the batch */
+    double *gradients;          /**< The gradient at each point in the batch, if analytic */
+    double *direction;          /**< The SPSA perturbation direction, or CMA-ES search steps (batch * params) */
+    double *moment1, *moment2;  /**< Adam's first and second moment estimates */
+    double *covariance;         /**< CMA-ES covariance matrix (row-major, params * params) */
+    double *eigenvectors;       /**< CMA-ES eigen-basis of the covariance */
+    double *eigenvalues;        /**< CMA-ES axis lengths (square root of the covariance eigenvalues) */
+    double *path_c, *path_s;    /**< CMA-ES evolution paths of the covariance and step-size */
+    double *weights;            /**< CMA-ES recombination weights */
+    double sigma;               /**< CMA-ES step-size */
+    double step_size;           /**< Adam learning rate or SPSA gain a */
+    double perturbation;        /**< SPSA / finite-difference perturbation c */
+    double stability;           /**< SPSA stability constant A of the gain sequence */
+    double step_norm;           /**< The size of the last step taken by the mean */
+    VSLStreamStatePtr stream;   /**< The random stream used for perturbations and populations */
+} native_optimiser_t;
+
+void native_optimiser_create(native_optimiser_t *optimiser, optimization_spec_t *opt_spec, int num_params,
+                             bool analytic_gradient, MKL_UINT seed);
+
+void native_optimiser_ask(native_optimiser_t *optimiser);
+
+void native_optimiser_tell(native_optimiser_t *optimiser);
+
+void native_optimiser_destroy(native_optimiser_t *optimiser);
+
+void evaluate_batch(qaoa_data_t *meta_spec, const double *points, int num_points, int num_params, double *values,
+                    double *gradients);
+
+nlopt_result native_optimise(qaoa_data_t *meta_spec, double *parameters, double *result);
+
+#endif //QOLAB_OPTIMISERS_H
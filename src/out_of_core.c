@@ -0,0 +1,100 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Memory-mapped backing of the state and cost vectors for runs which exceed DRAM
+ * @details Backing files are unlinked as soon as they are mapped, so they are reclaimed when unmapped (or when the
+ * process dies) and concurrent evaluations never collide. The hints are advisory: failures are ignored.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "out_of_core.h"
+
+/**
+ * @brief Widens a byte range to the pages containing it
+ * @param vector The start of the range
+ * @param bytes The length of the range
+ * @param length Output length of the page-aligned range
+ * @return The page-aligned start of the range
+ */
+void *ooc_pages(const void *vector, size_t bytes, size_t *length) {
+    uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t) vector & ~(page - 1);
+    *length = (uintptr_t) vector + bytes - start;
+    return (void *) start;
+}
+
+/**
+ * @brief Allocates a zeroed vector backed by a memory-mapped file
+ * @param bytes The size of the vector
+ * @param directory The directory the (immediately unlinked) backing file is created in
+ * @return The page-aligned vector, exits on failure
+ */
+void *ooc_allocate(size_t bytes, const char *directory) {
+    size_t path_length = strlen(directory) + 32;
+    char *path = malloc(path_length);
+    if (path == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(path, path_length, "%s/qolab_XXXXXX", directory);
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("Attempting to create out-of-core file");
+        exit(EXIT_FAILURE);
+    }
+    unlink(path);
+    free(path);
+    if (ftruncate(fd, (off_t) bytes) != 0) {
+        perror("Attempting to size out-of-core file");
+        exit(EXIT_FAILURE);
+    }
+    void *vector = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (vector == MAP_FAILED) {
+        perror("Attempting to map out-of-core file");
+        exit(EXIT_FAILURE);
+    }
+    posix_madvise(vector, bytes, POSIX_MADV_SEQUENTIAL);
+    return vector;
+}
+
+/**
+ * @brief Releases a vector allocated by ooc_allocate(), discarding its contents
+ * @param vector The vector
+ * @param bytes The size it was allocated with
+ */
+void ooc_free(void *vector, size_t bytes) {
+    munmap(vector, bytes);
+}
+
+/**
+ * @brief Requests read-ahead of a range of a mapped vector
+ * @param vector The start of the range
+ * @param bytes The length of the range (nothing is done if 0)
+ */
+void ooc_prefetch(const void *vector, size_t bytes) {
+    size_t length;
+    if (bytes > 0) {
+        void *start = ooc_pages(vector, bytes, &length);
+        posix_madvise(start, length, POSIX_MADV_WILLNEED);
+    }
+}
+
+/**
+ * @brief Starts asynchronous write-back of a range of a mapped vector
+ * @param vector The start of the range
+ * @param bytes The length of the range (nothing is done if 0)
+ */
+void ooc_writeback(void *vector, size_t bytes) {
+    size_t length;
+    if (bytes > 0) {
+        void *start = ooc_pages(vector, bytes, &length);
+        msync(start, length, MS_ASYNC);
+    }
+}
@@ -0,0 +1,23 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Memory-mapped backing of the state and cost vectors for runs which exceed DRAM
+ * @details Each vector is a file in a local directory (ideally NVMe) mapped shared, so the page cache reads it in and
+ * writes it back. The blocked kernels walk these mappings sequentially, requesting read-ahead of the next block and
+ * asynchronous write-back of the block just finished.
+ */
+
+#ifndef QOLAB_OUT_OF_CORE_H
+#define QOLAB_OUT_OF_CORE_H
+
+#include <stddef.h>
+
+void *ooc_allocate(size_t bytes, const char *directory);
+
+void ooc_free(void *vector, size_t bytes);
+
+void ooc_prefetch(const void *vector, size_t bytes);
+
+void ooc_writeback(void *vector, size_t bytes);
+
+#endif //QOLAB_OUT_OF_CORE_H
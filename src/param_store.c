@@ -0,0 +1,219 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief An on-disk store of converged parameters used to warm-start new instances of the same class
+ * @details The store is a plain text file with one entry per line:
+ *     class num_qubits P restricted value length angle_0 ... angle_{length-1}
+ * where the angles are laid out as for evolve() or evolve_restricted() (length = 2*P, or 2*P + 1 if restricted),
+ * independent of the strategy used to find them. Entries are only ever appended.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <mathimf.h>
+#include "param_store.h"
+#include "optimisers.h"
+
+/**
+ * @brief Linearly resamples a sequence of angles onto a different number of layers
+ * @details Each layer is treated as sitting at the midpoint of its slice of the unit interval
+ * @param num_old The length of the original sequence
+ * @param old The original sequence
+ * @param num_new The length of the resampled sequence
+ * @param output The resampled sequence
+ */
+void resample_sequence(int num_old, const double *old, int num_new, double *output) {
+    for (int i = 0; i < num_new; ++i) {
+        double t = (i + 0.5) * num_old / num_new - 0.5;
+        t = t < 0.0 ? 0.0 : (t > num_old - 1 ? num_old - 1 : t);
+        int lower = (int) t;
+        int upper = lower + 1 < num_old ? lower + 1 : lower;
+        double weight = t - lower;
+        output[i] = (1.0 - weight) * old[lower] + weight * old[upper];
+    }
+}
+
+/**
+ * @brief Determines whether a stored entry is at least as close to the target as another
+ * @details Closeness is lexicographic: the difference in P first, then in the number of qubits
+ * @return True if (p_distance, q_distance) is no further than (p_other, q_other)
+ */
+bool store_closer(int p_distance, int q_distance, int p_other, int q_other) {
+    return p_distance < p_other || (p_distance == p_other && q_distance <= q_other);
+}
+
+/**
+ * @brief Finds the stored entries nearest to a run and resamples them to its P
+ * @details Only entries of the same class and mode are considered. Ties are broken in favour of the most recent entry
+ * and malformed lines are skipped.
+ * @param path The store file (a missing file is treated as empty)
+ * @param problem_class The class of the problem instance
+ * @param num_qubits The number of qubits of the run
+ * @param P The decomposition value of the run
+ * @param restricted Whether the run is of the restricted QAOA
+ * @param max_seeds The maximum number of entries returned
+ * @param seeds The nearest entries, nearest first (max_seeds * (2*P + restricted) length)
+ * @return The number of entries found
+ */
+int store_lookup(const char *path, const char *problem_class, int num_qubits, int P, bool restricted,
+                 int max_seeds, double *seeds) {
+    FILE *store = fopen(path, "r");
+    if (store == NULL) {
+        return 0;
+    }
+    int length = 2 * P + (restricted ? 1 : 0);
+    int found = 0;
+    int fields;
+    int entry_qubits, entry_P, entry_restricted, entry_length;
+    int capacity = 0;
+    double entry_value;
+    double *angles = NULL;
+    char entry_class[STORE_CLASS_LENGTH];
+    int *p_distances = mkl_malloc(max_seeds * sizeof(int), DEF_ALIGNMENT);
+    int *q_distances = mkl_malloc(max_seeds * sizeof(int), DEF_ALIGNMENT);
+    check_alloc(p_distances);
+    check_alloc(q_distances);
+
+    while ((fields = fscanf(store, "%63s %d %d %d %lf %d", entry_class, &entry_qubits, &entry_P, &entry_restricted,
+                            &entry_value, &entry_length)) != EOF) {
+        bool valid = fields == 6 && entry_P > 0 && entry_length == 2 * entry_P + (entry_restricted ? 1 : 0);
+        if (valid && entry_length > capacity) {
+            capacity = entry_length;
+            angles = mkl_realloc(angles, capacity * sizeof(double));
+            check_alloc(angles);
+        }
+        for (int j = 0; valid && j < entry_length; ++j) {
+            valid = fscanf(store, "%lf", &angles[j]) == 1;
+        }
+        fscanf(store, "%*[^\n]");
+        if (!valid || strcmp(entry_class, problem_class) != 0 || (entry_restricted != 0) != restricted) {
+            continue;
+        }
+
+        int p_distance = abs(entry_P - P);
+        int q_distance = abs(entry_qubits - num_qubits);
+        int slot;
+        if (found < max_seeds) {
+            slot = found++;
+        } else if (store_closer(p_distance, q_distance, p_distances[max_seeds - 1], q_distances[max_seeds - 1])) {
+            slot = max_seeds - 1;
+        } else {
+            continue;
+        }
+        for (; slot > 0 && store_closer(p_distance, q_distance, p_distances[slot - 1], q_distances[slot - 1]); --slot) {
+            p_distances[slot] = p_distances[slot - 1];
+            q_distances[slot] = q_distances[slot - 1];
+            cblas_dcopy(length, seeds + (slot - 1) * length, 1, seeds + slot * length, 1);
+        }
+        p_distances[slot] = p_distance;
+        q_distances[slot] = q_distance;
+        resample_sequence(entry_P, angles, P, seeds + slot * length);
+        resample_sequence(entry_length - entry_P, angles + entry_P, length - P, seeds + slot * length + P);
+    }
+    fclose(store);
+    mkl_free(angles);
+    mkl_free(p_distances);
+    mkl_free(q_distances);
+    return found;
+}
+
+/**
+ * @brief Overwrites the initial parameters with the nearest entries in the parameter store
+ * @details With store_seeds > 1 the nearest entries are evaluated together and the best is kept (a short multi-seed
+ * screen, costing one evaluation per seed). Under the FOURIER strategy the stored angles are projected onto the
+ * amplitudes. Seeds are clipped to the optimiser's bounds. If the store holds no match the parameters are untouched.
+ * @param meta_spec The data-structure containing all fields, with UC, UB and the bounds initialised
+ */
+void store_seed(qaoa_data_t *meta_spec) {
+    optimization_spec_t *opt_spec = meta_spec->opt_spec;
+    int P = meta_spec->machine_spec->P;
+    bool restricted = meta_spec->run_spec->restricted;
+    int length = schedule_length(meta_spec);
+    int num_params = parameter_count(meta_spec);
+    int best = 0;
+    double *seeds = mkl_malloc(opt_spec->store_seeds * length * sizeof(double), DEF_ALIGNMENT);
+    check_alloc(seeds);
+    int found = store_lookup(opt_spec->store_path, opt_spec->problem_class, meta_spec->machine_spec->num_qubits, P,
+                             restricted, opt_spec->store_seeds, seeds);
+    if (found == 0) {
+        mkl_free(seeds);
+        return;
+    }
+
+    double *points = seeds;
+    if (opt_spec->strategy == STRATEGY_FOURIER) {
+        points = mkl_malloc(found * num_params * sizeof(double), DEF_ALIGNMENT);
+        check_alloc(points);
+        for (int k = 0; k < found; ++k) {
+            fourier_project(P, num_params / 2, restricted, seeds + k * length, points + k * num_params);
+        }
+    }
+    for (int k = 0; k < found; ++k) {
+        for (int j = 0; j < num_params; ++j) {
+            double *value = &points[k * num_params + j];
+            *value = fmax(opt_spec->lower_bounds[j], fmin(opt_spec->upper_bounds[j], *value));
+        }
+    }
+    if (found > 1) {
+        double *values = mkl_malloc(found * sizeof(double), DEF_ALIGNMENT);
+        check_alloc(values);
+        evaluate_batch(meta_spec, points, found, num_params, values, NULL);
+        for (int k = 1; k < found; ++k) {
+            if (values[k] > values[best]) {
+                best = k;
+            }
+        }
+        mkl_free(values);
+    }
+    cblas_dcopy(num_params, points + best * num_params, 1, opt_spec->parameters, 1);
+    if (meta_spec->run_spec->verbose) {
+        printf("Seeded from %d stored entries\n", found);
+    }
+    if (points != seeds) {
+        mkl_free(points);
+    }
+    mkl_free(seeds);
+}
+
+/**
+ * @brief Appends the optimised parameters of a run to the parameter store
+ * @details The entry is formatted in memory and written with a single unbuffered write so that concurrent runs of a
+ * sweep sharing a store append whole lines. Failing to open the store is reported but not fatal.
+ * @param meta_spec The data-structure containing all fields, after optimisation
+ */
+void store_record(qaoa_data_t *meta_spec) {
+    optimization_spec_t *opt_spec = meta_spec->opt_spec;
+    int P = meta_spec->machine_spec->P;
+    bool restricted = meta_spec->run_spec->restricted;
+    int length = schedule_length(meta_spec);
+    double *angles = opt_spec->parameters;
+    size_t offset;
+    size_t size = STORE_CLASS_LENGTH + 64 + (size_t) length * 26;
+    char *line = mkl_malloc(size, DEF_ALIGNMENT);
+    check_alloc(line);
+    if (opt_spec->strategy == STRATEGY_FOURIER) {
+        angles = mkl_malloc(length * sizeof(double), DEF_ALIGNMENT);
+        check_alloc(angles);
+        fourier_expand(P, parameter_count(meta_spec) / 2, restricted, opt_spec->parameters, angles);
+    }
+
+    offset = (size_t) sprintf(line, "%s %d %d %d %.17g %d", opt_spec->problem_class,
+                              meta_spec->machine_spec->num_qubits, P, restricted ? 1 : 0,
+                              meta_spec->qaoa_statistics->result, length);
+    for (int i = 0; i < length; ++i) {
+        offset += (size_t) sprintf(line + offset, " %.17g", angles[i]);
+    }
+    sprintf(line + offset, "\n");
+
+    FILE *store = fopen(opt_spec->store_path, "a");
+    if (store == NULL) {
+        perror("Attempting to open parameter store");
+    } else {
+        setvbuf(store, NULL, _IONBF, 0);
+        fputs(line, store);
+        fclose(store);
+    }
+    if (angles != opt_spec->parameters) {
+        mkl_free(angles);
+    }
+    mkl_free(line);
+}
@@ -0,0 +1,22 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ */
+
+#ifndef QOLAB_PARAM_STORE_H
+#define QOLAB_PARAM_STORE_H
+
+#include <mkl.h>
+#include <stdbool.h>
+#include "globals.h"
+
+#define STORE_CLASS_LENGTH 64
+
+int store_lookup(const char *path, const char *problem_class, int num_qubits, int P, bool restricted,
+                 int max_seeds, double *seeds);
+
+void store_seed(qaoa_data_t *meta_spec);
+
+void store_record(qaoa_data_t *meta_spec);
+
+#endif //QOLAB_PARAM_STORE_H
@@ -0,0 +1,329 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief An accuracy versus speed comparison of the evolution engines, built as pareto.exe
+ * @details For every small qubit count, mixing angle beta and depth P, evolves the equal superposition through P
+ * layers (gamma ramped linearly to PARETO_GAMMA, every beta equal) with each engine configuration and with a dense
+ * reference: the exact phase and exp(-i beta B) = V exp(-i beta D) V^T from a full eigendecomposition of the driver.
+ * Reports the fidelity |<ref|psi>|^2, the absolute error of the expectation value and the wall time of each engine,
+ * then the cheapest configuration meeting the target infidelity. Rows are appended as CSV.
+ *
+ * Usage: pareto.exe [min_qubits] [max_qubits] [target_infidelity] [csv_file]   (defaults 4 10 1e-10 pareto.csv)
+ */
+
+#include <stdlib.h>
+#include <mathimf.h>
+#include "qaoa.h"
+#include "graph_utils.h"
+#include "ub.h"
+#include "uc.h"
+#include "cost_vector.h"
+#include "state_evolve.h"
+#include "eigen_solve.h"
+#include "placement.h"
+
+#define PARETO_MAX_QUBITS 12
+#define PARETO_GAMMA 0.4
+#define PARETO_REPEATS 3
+
+/*! An evolution engine configuration under test */
+typedef struct {
+    const char *name;       /**< The engine */
+    mixer_engine_t mixer;   /**< The mixer it selects */
+    double tolerance;       /**< Its accuracy setting (0 if exact) */
+} pareto_engine_t;
+
+static const pareto_engine_t engines[] = {
+        {"chebyshev", MIXER_CHEBYSHEV, 1e-4},
+        {"chebyshev", MIXER_CHEBYSHEV, 1e-6},
+        {"chebyshev", MIXER_CHEBYSHEV, 1e-8},
+        {"chebyshev", MIXER_CHEBYSHEV, 1e-10},
+        {"chebyshev", MIXER_CHEBYSHEV, 1e-12},
+        {"chebyshev", MIXER_CHEBYSHEV, 1e-14},
+        {"chebyshev", MIXER_CHEBYSHEV, CHEBY_DEFAULT_TOLERANCE},
+        {"product", MIXER_PRODUCT, 0.0}
+};
+static const double betas[] = {0.1, 0.5, 1.0, PI / 2.0, 2.0};
+static const int depths[] = {1, 2, 4, 8};
+
+/**
+ * @brief Configures the run specification to use an engine
+ * @param run_spec The run specification handed to apply_phase() and apply_mixer()
+ * @param engine The engine configuration
+ */
+void pareto_configure(run_spec_t *run_spec, const pareto_engine_t *engine) {
+    run_spec->mixer = engine->mixer;
+    if (engine->mixer == MIXER_CHEBYSHEV) {
+        run_spec->cheby_tolerance = engine->tolerance;
+    }
+}
+
+/**
+ * @brief The expectation value of the cost function in a state
+ * @param state The state-vector
+ * @param meta_spec Contains the cost function
+ * @return sum_x |psi_x|^2 C(x)
+ */
+double pareto_expectation(const MKL_Complex16 *state, qaoa_data_t *meta_spec) {
+    return cost_vector_expectation(meta_spec->uc, state);
+}
+
+/**
+ * @brief Evolves the equal superposition with the configured engine
+ * @param state The output state-vector
+ * @param beta The mixing angle of every layer
+ * @param P The number of layers
+ * @param meta_spec Contains the cost function, driver and engine configuration
+ */
+void pareto_evolve(MKL_Complex16 *state, double beta, int P, qaoa_data_t *meta_spec) {
+    for (MKL_INT j = 0; j < meta_spec->machine_spec->space_dimension; ++j) {
+        state[j] = (MKL_Complex16) {0.0, 0.0};
+    }
+    initialise_state(state, meta_spec->machine_spec);
+    for (int i = 0; i < P; ++i) {
+        apply_phase(state, PARETO_GAMMA * (i + 1) / P, meta_spec);
+        apply_mixer(state, beta, meta_spec);
+    }
+}
+
+/**
+ * @brief Evolves the equal superposition exactly using the dense eigendecomposition of the driver
+ * @param state The output state-vector
+ * @param beta The mixing angle of every layer
+ * @param P The number of layers
+ * @param eigenvectors The orthonormal eigenvectors of the (real) driver, row-major
+ * @param eigenvalues The eigenvalues of the driver
+ * @param meta_spec Contains the cost function
+ */
+void pareto_reference(MKL_Complex16 *state, double beta, int P, const double *eigenvectors, const double *eigenvalues,
+                      qaoa_data_t *meta_spec) {
+    MKL_INT n = meta_spec->machine_spec->space_dimension;
+    double *real = mkl_malloc(n * sizeof(double), DEF_ALIGNMENT);
+    double *imag = mkl_malloc(n * sizeof(double), DEF_ALIGNMENT);
+    double *real_work = mkl_malloc(n * sizeof(double), DEF_ALIGNMENT);
+    double *imag_work = mkl_malloc(n * sizeof(double), DEF_ALIGNMENT);
+    check_alloc(real);
+    check_alloc(imag);
+    check_alloc(real_work);
+    check_alloc(imag_work);
+    for (MKL_INT j = 0; j < n; ++j) {
+        real[j] = 1.0 / sqrt((double) n);
+        imag[j] = 0.0;
+    }
+    for (int i = 0; i < P; ++i) {
+        double gamma = PARETO_GAMMA * (i + 1) / P;
+        for (MKL_INT j = 0; j < n; ++j) {
+            double phase = -gamma * cost_vector_get(meta_spec->uc, j);
+            double re = real[j] * cos(phase) - imag[j] * sin(phase);
+            imag[j] = real[j] * sin(phase) + imag[j] * cos(phase);
+            real[j] = re;
+        }
+        cblas_dgemv(CblasRowMajor, CblasTrans, n, n, 1.0, eigenvectors, n, real, 1, 0.0, real_work, 1);
+        cblas_dgemv(CblasRowMajor, CblasTrans, n, n, 1.0, eigenvectors, n, imag, 1, 0.0, imag_work, 1);
+        for (MKL_INT k = 0; k < n; ++k) {
+            double phase = -beta * eigenvalues[k];
+            double re = real_work[k] * cos(phase) - imag_work[k] * sin(phase);
+            imag_work[k] = real_work[k] * sin(phase) + imag_work[k] * cos(phase);
+            real_work[k] = re;
+        }
+        cblas_dgemv(CblasRowMajor, CblasNoTrans, n, n, 1.0, eigenvectors, n, real_work, 1, 0.0, real, 1);
+        cblas_dgemv(CblasRowMajor, CblasNoTrans, n, n, 1.0, eigenvectors, n, imag_work, 1, 0.0, imag, 1);
+    }
+    for (MKL_INT j = 0; j < n; ++j) {
+        state[j] = (MKL_Complex16) {real[j], imag[j]};
+    }
+    mkl_free(real);
+    mkl_free(imag);
+    mkl_free(real_work);
+    mkl_free(imag_work);
+}
+
+/**
+ * @brief Builds the dense driver Hamiltonian from the (real) sparse UB matrix and diagonalises it
+ * @param ub The real UB matrix, before convert_ub()
+ * @param n The dimension of the matrix
+ * @param eigenvectors Output n*n row-major eigenvectors (columns)
+ * @param eigenvalues Output n eigenvalues
+ */
+void pareto_diagonalise(sparse_matrix_t ub, MKL_INT n, double *eigenvectors, double *eigenvalues) {
+    sparse_index_base_t indexing;
+    MKL_INT rows, cols, *rows_start, *rows_end, *col_indx;
+    double *values;
+    mkl_sparse_d_export_csr(ub, &indexing, &rows, &cols, &rows_start, &rows_end, &col_indx, &values);
+    for (MKL_INT j = 0; j < n * n; ++j) {
+        eigenvectors[j] = 0.0;
+    }
+    for (MKL_INT r = 0; r < rows; ++r) {
+        for (MKL_INT k = rows_start[r] - indexing; k < rows_end[r] - indexing; ++k) {
+            eigenvectors[r * n + col_indx[k] - indexing] = values[k];
+        }
+    }
+    if (LAPACKE_dsyev(LAPACK_ROW_MAJOR, 'V', 'U', n, eigenvectors, n, eigenvalues) != 0) {
+        fprintf(stderr, "Dense eigendecomposition failed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int min_qubits = argc > 1 ? atoi(argv[1]) : 4;
+    int max_qubits = argc > 2 ? atoi(argv[2]) : 10;
+    double target = argc > 3 ? atof(argv[3]) : 1e-10;
+    const char *csv_path = argc > 4 ? argv[4] : "pareto.csv";
+    int num_engines = sizeof(engines) / sizeof(engines[0]);
+
+    if (min_qubits < 1 || max_qubits < min_qubits || target <= 0.0) {
+        fprintf(stderr, "Usage: %s [min_qubits] [max_qubits] [target_infidelity] [csv_file]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (max_qubits > PARETO_MAX_QUBITS) {
+        fprintf(stderr, "The dense reference is limited to %d qubits.\n", PARETO_MAX_QUBITS);
+        max_qubits = PARETO_MAX_QUBITS;
+    }
+    FILE *csv = fopen(csv_path, "a");
+    if (csv == NULL) {
+        perror("Attempting to open pareto file");
+        exit(EXIT_FAILURE);
+    }
+    if (ftell(csv) == 0) {
+        fprintf(csv, "qubits,beta,P,engine,tolerance,fidelity,infidelity,expectation_error,seconds,"
+                     "reference_seconds\n");
+    }
+
+    run_spec_t run_spec;
+    run_spec.correct = false;
+    run_spec.report = false;
+    run_spec.timing = false;
+    run_spec.sampling = false;
+    run_spec.verbose = false;
+    run_spec.restricted = false;
+    run_spec.restart = false;
+    run_spec.seed = 1;
+    run_spec.num_samples = 100;
+    run_spec.objective = OBJECTIVE_EXPECTATION;
+    run_spec.cvar_alpha = 0.1;
+    run_spec.gibbs_eta = 1.0;
+    run_spec.cheby_tolerance = CHEBY_DEFAULT_TOLERANCE;
+    run_spec.spectral_limit = SPECTRAL_LIMIT_DEFAULT;
+    run_spec.mixer = MIXER_CHEBYSHEV;
+    run_spec.xy_topology = XY_RING;
+    run_spec.xy_steps = 1;
+    run_spec.xy_weight = 2;
+    run_spec.symmetric = false;
+    run_spec.lightcone = false;
+    run_spec.block_length = BLOCK_LENGTH_DEFAULT;
+    run_spec.ooc_directory = NULL;
+    run_spec.state_cache_bytes = 0;
+    run_spec.binding = BINDING_NONE;
+    run_spec.trace_path = NULL;
+    run_spec.trace_format = TRACE_BINARY;
+    run_spec.profile_path = NULL;
+    run_spec.outfile = stdout;
+
+    for (int num_qubits = min_qubits; num_qubits <= max_qubits; ++num_qubits) {
+        machine_spec_t mach_spec;
+        mach_spec.num_qubits = num_qubits;
+        mach_spec.P = 1;
+        mach_spec.space_dimension = (MKL_INT) pow(2, num_qubits);
+        MKL_INT n = mach_spec.space_dimension;
+
+        cost_data_t cost_data;
+        cost_data.x_range = n;
+        cost_data.cx_range = n;
+        cost_data.num_vertices = num_qubits;
+        cost_data.hamiltonian = NULL;
+        cost_data.graph = mkl_malloc(sizeof(MKL_INT) * num_qubits * num_qubits, DEF_ALIGNMENT);
+        check_alloc(cost_data.graph);
+
+        qaoa_statistics_t statistics;
+        statistics.best_sample = -INFINITY;
+        statistics.best_expectation = -INFINITY;
+        statistics.num_evals = 0;
+        statistics.trace = NULL;
+        statistics.trace_length = 0;
+        statistics.start = 0;
+
+        qaoa_data_t meta_spec;
+        meta_spec.machine_spec = &mach_spec;
+        meta_spec.run_spec = &run_spec;
+        meta_spec.cost_data = &cost_data;
+        meta_spec.qaoa_statistics = &statistics;
+        meta_spec.start_statistics = NULL;
+        meta_spec.trace = NULL;
+        meta_spec.lightcone = NULL;
+        meta_spec.grover = NULL;
+        meta_spec.spectral = NULL;
+        meta_spec.state_cache = NULL;
+        check_stream(vslNewStream(&meta_spec.stream, VSL_BRNG_PHILOX4X32X10, run_spec.seed));
+        generate_graph(cost_data.graph, num_qubits, 0.5, meta_spec.stream);
+        meta_spec.profile = NULL;
+        meta_spec.workspace = NULL;
+        meta_spec.batch_lock = NULL;
+        meta_spec.opt_spec = NULL;
+        generate_uc(&meta_spec, Cx, mask);
+
+        double *eigenvectors = mkl_malloc(n * n * sizeof(double), DEF_ALIGNMENT);
+        double *eigenvalues = mkl_malloc(n * sizeof(double), DEF_ALIGNMENT);
+        MKL_Complex16 *reference = mkl_malloc(n * sizeof(MKL_Complex16), DEF_ALIGNMENT);
+        MKL_Complex16 *state = mkl_malloc(n * sizeof(MKL_Complex16), DEF_ALIGNMENT);
+        check_alloc(eigenvectors);
+        check_alloc(eigenvalues);
+        check_alloc(reference);
+        check_alloc(state);
+        MKL_INT ub_nnz = generate_ub(&meta_spec, mask);
+        pareto_diagonalise(meta_spec.ub, n, eigenvectors, eigenvalues);
+        meta_spec.ub_eigenvalue = max_eigen_find(meta_spec.ub);
+        convert_ub(&meta_spec, ub_nnz);
+
+        for (int b = 0; b < (int) (sizeof(betas) / sizeof(betas[0])); ++b) {
+            for (int d = 0; d < (int) (sizeof(depths) / sizeof(depths[0])); ++d) {
+                int P = depths[d];
+                int cheapest = -1;
+                double cheapest_time = INFINITY;
+                double start = dsecnd();
+                pareto_reference(reference, betas[b], P, eigenvectors, eigenvalues, &meta_spec);
+                double reference_time = dsecnd() - start;
+                double reference_expectation = pareto_expectation(reference, &meta_spec);
+
+                for (int e = 0; e < num_engines; ++e) {
+                    double time = INFINITY;
+                    MKL_Complex16 overlap;
+                    pareto_configure(&run_spec, &engines[e]);
+                    for (int r = 0; r < PARETO_REPEATS; ++r) {
+                        start = dsecnd();
+                        pareto_evolve(state, betas[b], P, &meta_spec);
+                        time = fmin(time, dsecnd() - start);
+                    }
+                    cblas_zdotc_sub(n, reference, 1, state, 1, &overlap);
+                    double fidelity = overlap.real * overlap.real + overlap.imag * overlap.imag;
+                    double error = fabs(pareto_expectation(state, &meta_spec) - reference_expectation);
+                    fprintf(csv, "%d,%f,%d,%s,%e,%.17g,%.6e,%.6e,%.9e,%.9e\n", num_qubits, betas[b], P,
+                            engines[e].name, engines[e].tolerance, fidelity, fabs(1.0 - fidelity), error, time,
+                            reference_time);
+                    if (fabs(1.0 - fidelity) <= target && time < cheapest_time) {
+                        cheapest = e;
+                        cheapest_time = time;
+                    }
+                }
+                if (cheapest < 0) {
+                    printf("Q=%2d beta=%.3f P=%d: no engine meets infidelity %.1e\n", num_qubits, betas[b], P,
+                           target);
+                } else {
+                    printf("Q=%2d beta=%.3f P=%d: cheapest is %s (tolerance %.0e) at %.3e s\n", num_qubits,
+                           betas[b], P, engines[cheapest].name, engines[cheapest].tolerance, cheapest_time);
+                }
+            }
+        }
+        fflush(csv);
+
+        destroy_ub(meta_spec.ub);
+        cost_vector_free(meta_spec.uc);
+        vslDeleteStream(&meta_spec.stream);
+        mkl_free(cost_data.graph);
+        mkl_free(eigenvectors);
+        mkl_free(eigenvalues);
+        mkl_free(reference);
+        mkl_free(state);
+    }
+    fclose(csv);
+    return 0;
+}
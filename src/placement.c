@@ -0,0 +1,536 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief NUMA-aware allocation, thread-to-core binding and placement reporting
+ * @details Topology is read from sysfs. The binding order is computed once, from the CPUs the process may use when it
+ * is first needed, and places one thread per physical core before using any hyper-thread siblings.
+ *
+ * Large arrays are mapped directly rather than taken from the heap so they can be backed by huge pages: 1 GiB then
+ * 2 MiB pages from the hugetlbfs pools (MAP_HUGETLB), falling back to a 2 MiB aligned mapping marked for transparent
+ * huge pages (MADV_HUGEPAGE). The mappings are recorded so numa_free() can tell them from heap arrays.
+ */
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <sched.h>
+#include <dirent.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "placement.h"
+#include "cost_vector.h"
+
+#ifdef __linux__
+
+#define HUGE_PAGE_2M ((size_t) 1 << 21)
+#define HUGE_PAGE_1G ((size_t) 1 << 30)
+#define HUGE_PAGE_THRESHOLD (4 * HUGE_PAGE_2M)
+
+/*! A large array mapped by numa_allocate() */
+typedef struct placement_mapping {
+    void *address;                  /**< The start of the mapping (and of the array) */
+    size_t length;                  /**< The length of the mapping, a multiple of page_size */
+    size_t page_size;               /**< The page size requested */
+    bool transparent;               /**< Whether the pages are transparent huge pages rather than hugetlbfs pages */
+    struct placement_mapping *next; /**< The next live mapping */
+} placement_mapping_t;
+
+static placement_mapping_t *mappings = NULL;
+
+/**
+ * @brief Maps an anonymous region backed by the largest huge pages available
+ * @param bytes The minimum length of the region
+ * @param mapping Output description of the mapping
+ * @return The region (zeroed by the kernel), NULL if nothing could be mapped
+ */
+static void *huge_map(size_t bytes, placement_mapping_t *mapping) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void *address;
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+    const size_t sizes[2] = {HUGE_PAGE_1G, HUGE_PAGE_2M};
+    const int shifts[2] = {30, 21};
+    for (int k = bytes >= HUGE_PAGE_1G ? 0 : 1; k < 2; ++k) {
+        mapping->length = (bytes + sizes[k] - 1) & ~(sizes[k] - 1);
+        address = mmap(NULL, mapping->length, PROT_READ | PROT_WRITE,
+                       flags | MAP_HUGETLB | (shifts[k] << MAP_HUGE_SHIFT), -1, 0);
+        if (address != MAP_FAILED) {
+            mapping->page_size = sizes[k];
+            mapping->transparent = false;
+            return address;
+        }
+    }
+#endif
+    //Over-map by a page so the region can be trimmed to 2 MiB alignment, which transparent huge pages require
+    mapping->length = (bytes + HUGE_PAGE_2M - 1) & ~(HUGE_PAGE_2M - 1);
+    char *raw = mmap(NULL, mapping->length + HUGE_PAGE_2M, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (raw == MAP_FAILED) {
+        return NULL;
+    }
+    char *aligned = (char *) (((uintptr_t) raw + HUGE_PAGE_2M - 1) & ~((uintptr_t) HUGE_PAGE_2M - 1));
+    if (aligned > raw) {
+        munmap(raw, (size_t) (aligned - raw));
+    }
+    munmap(aligned + mapping->length, (size_t) (raw + HUGE_PAGE_2M - aligned));
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, mapping->length, MADV_HUGEPAGE);
+#endif
+    mapping->page_size = HUGE_PAGE_2M;
+    mapping->transparent = true;
+    return aligned;
+}
+
+/**
+ * @brief Maps and records a large array
+ * @param bytes The size of the array
+ * @return The array, NULL if it should come from the heap instead
+ */
+static void *huge_allocate(size_t bytes) {
+    placement_mapping_t *mapping = malloc(sizeof(placement_mapping_t));
+    check_alloc(mapping);
+    mapping->address = huge_map(bytes, mapping);
+    if (mapping->address == NULL) {
+        free(mapping);
+        return NULL;
+    }
+#pragma omp critical(placement_mappings)
+    {
+        mapping->next = mappings;
+        mappings = mapping;
+    }
+    return mapping->address;
+}
+
+/**
+ * @brief Unmaps an array if it was mapped by huge_allocate()
+ * @param array The array
+ * @return Whether the array was a recorded mapping
+ */
+static bool huge_release(void *array) {
+    placement_mapping_t *found = NULL;
+#pragma omp critical(placement_mappings)
+    for (placement_mapping_t **link = &mappings; *link != NULL; link = &(*link)->next) {
+        if ((*link)->address == array) {
+            found = *link;
+            *link = found->next;
+            break;
+        }
+    }
+    if (found == NULL) {
+        return false;
+    }
+    munmap(found->address, found->length);
+    free(found);
+    return true;
+}
+
+#endif
+
+/**
+ * @brief Allocates a zeroed array, first touching each thread's share from that thread
+ * @details The shares are those of an OpenMP schedule(static) loop over count elements (contiguous, sizes differing
+ * by at most one), matching the partition of the kernels that later stream the array. Arrays of 8 MiB or more are
+ * backed by huge pages where the system provides them (see placement_report()).
+ * @param count The number of elements
+ * @param size The size of each element
+ * @return The array, to be released with numa_free()
+ */
+void *numa_allocate(size_t count, size_t size) {
+    char *array = NULL;
+#ifdef __linux__
+    if (count * size >= HUGE_PAGE_THRESHOLD) {
+        array = huge_allocate(count * size);
+    }
+#endif
+    if (array == NULL) {
+        array = mkl_malloc(count * size, DEF_ALIGNMENT);
+        check_alloc(array);
+    }
+#pragma omp parallel
+    {
+        size_t threads = (size_t) omp_get_num_threads();
+        size_t thread = (size_t) omp_get_thread_num();
+        size_t share = count / threads;
+        size_t extra = count % threads;
+        size_t first = thread * share + (thread < extra ? thread : extra);
+        size_t length = share + (thread < extra ? 1 : 0);
+        memset(array + first * size, 0, length * size);
+    }
+    return array;
+}
+
+/**
+ * @brief Releases an array allocated by numa_allocate()
+ * @param array The array
+ */
+void numa_free(void *array) {
+#ifdef __linux__
+    if (huge_release(array)) {
+        return;
+    }
+#endif
+    mkl_free(array);
+}
+
+/**
+ * @brief Creates an empty pool of arrays
+ * @param count The number of elements of each array
+ * @param size The size of each element
+ * @return The pool, to be released with numa_pool_destroy()
+ */
+numa_pool_t *numa_pool_create(size_t count, size_t size) {
+    numa_pool_t *pool = mkl_malloc(sizeof(numa_pool_t), DEF_ALIGNMENT);
+    check_alloc(pool);
+    pool->count = count;
+    pool->size = size;
+    pool->available = 0;
+    pool->capacity = 8;
+    pool->arrays = mkl_malloc(pool->capacity * sizeof(void *), DEF_ALIGNMENT);
+    check_alloc(pool->arrays);
+    omp_init_lock(&pool->lock);
+    return pool;
+}
+
+/**
+ * @brief Takes an array from a pool, placing a new one with numa_allocate() if none is free
+ * @param pool The pool
+ * @return The array, whose contents are left from its last use, to be handed back with numa_pool_give()
+ */
+void *numa_pool_take(numa_pool_t *pool) {
+    void *array = NULL;
+    omp_set_lock(&pool->lock);
+    if (pool->available > 0) {
+        array = pool->arrays[--pool->available];
+    }
+    omp_unset_lock(&pool->lock);
+    if (array == NULL) {
+        array = numa_allocate(pool->count, pool->size);
+    }
+    return array;
+}
+
+/**
+ * @brief Hands an array taken with numa_pool_take() back to its pool
+ * @param pool The pool
+ * @param array The array
+ */
+void numa_pool_give(numa_pool_t *pool, void *array) {
+    omp_set_lock(&pool->lock);
+    if (pool->available == pool->capacity) {
+        void **arrays = mkl_malloc(2 * pool->capacity * sizeof(void *), DEF_ALIGNMENT);
+        check_alloc(arrays);
+        memcpy(arrays, pool->arrays, pool->capacity * sizeof(void *));
+        mkl_free(pool->arrays);
+        pool->arrays = arrays;
+        pool->capacity *= 2;
+    }
+    pool->arrays[pool->available++] = array;
+    omp_unset_lock(&pool->lock);
+}
+
+/**
+ * @brief Releases a pool and its arrays
+ * @param pool The pool (may be NULL), every array of which has been handed back
+ */
+void numa_pool_destroy(numa_pool_t *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    for (int a = 0; a < pool->available; ++a) {
+        numa_free(pool->arrays[a]);
+    }
+    omp_destroy_lock(&pool->lock);
+    mkl_free(pool->arrays);
+    mkl_free(pool);
+}
+
+#ifdef __linux__
+
+#define PLACEMENT_PAGE_SAMPLES 64
+#define PLACEMENT_MAX_NODES 64
+
+/*! A CPU and the keys it is ordered by */
+typedef struct {
+    int cpu;    /**< The logical CPU */
+    int key[3]; /**< Sort keys, most significant first */
+} placement_cpu_t;
+
+static int *allowed_cpus = NULL;    /**< The CPUs available to the process before any binding, ascending */
+static int *binding_order = NULL;   /**< allowed_cpus in the order threads are bound to them */
+static int binding_count = 0;
+static binding_policy_t binding_policy = BINDING_NONE;
+
+/**
+ * @brief Reads a single integer from a sysfs file of a CPU
+ * @param cpu The logical CPU
+ * @param name The file below /sys/devices/system/cpu/cpuN/
+ * @return The value, 0 if unavailable
+ */
+static int cpu_attribute(int cpu, const char *name) {
+    char path[128];
+    int value = 0;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/%s", cpu, name);
+    FILE *file = fopen(path, "r");
+    if (file != NULL) {
+        if (fscanf(file, "%d", &value) != 1) {
+            value = 0;
+        }
+        fclose(file);
+    }
+    return value;
+}
+
+/**
+ * @brief Finds the NUMA node of a CPU from its nodeK link in sysfs
+ * @param cpu The logical CPU
+ * @return The node, 0 if unavailable
+ */
+static int cpu_node(int cpu) {
+    char path[64];
+    int node = 0;
+    struct dirent *entry;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *directory = opendir(path);
+    if (directory == NULL) {
+        return 0;
+    }
+    while ((entry = readdir(directory)) != NULL) {
+        if (strncmp(entry->d_name, "node", 4) == 0 && sscanf(entry->d_name + 4, "%d", &node) == 1) {
+            break;
+        }
+    }
+    closedir(directory);
+    return node;
+}
+
+static int placement_compare(const void *a, const void *b) {
+    const placement_cpu_t *x = a;
+    const placement_cpu_t *y = b;
+    for (int k = 0; k < 3; ++k) {
+        if (x->key[k] != y->key[k]) {
+            return x->key[k] < y->key[k] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Computes the order in which threads are bound to the CPUs available to the process
+ * @details The available CPUs are captured on the first call, before any thread has been bound. Each CPU's sibling
+ * index (its position among the hyper-threads of its core) is the leading key, so every core receives a thread before
+ * any core receives two. CLOSE then orders by (node, cpu) and SPREAD by (rank within node, node).
+ * @param policy The binding policy
+ */
+static void binding_initialise(binding_policy_t policy) {
+    if (allowed_cpus != NULL && binding_policy == policy) {
+        return;
+    }
+    if (allowed_cpus == NULL) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        sched_getaffinity(0, sizeof(allowed), &allowed);
+        binding_count = CPU_COUNT(&allowed);
+        allowed_cpus = malloc(binding_count * sizeof(int));
+        binding_order = malloc(binding_count * sizeof(int));
+        check_alloc(allowed_cpus);
+        check_alloc(binding_order);
+        for (int cpu = 0, c = 0; cpu < CPU_SETSIZE && c < binding_count; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                allowed_cpus[c++] = cpu;
+            }
+        }
+    }
+
+    placement_cpu_t *cpus = malloc(binding_count * sizeof(placement_cpu_t));
+    int *topology = malloc(4 * binding_count * sizeof(int));
+    check_alloc(cpus);
+    check_alloc(topology);
+    int *package = topology;
+    int *core = topology + binding_count;
+    int *node = topology + 2 * binding_count;
+    int *sibling = topology + 3 * binding_count;
+    for (int c = 0; c < binding_count; ++c) {
+        package[c] = cpu_attribute(allowed_cpus[c], "topology/physical_package_id");
+        core[c] = cpu_attribute(allowed_cpus[c], "topology/core_id");
+        node[c] = cpu_node(allowed_cpus[c]);
+        sibling[c] = 0;
+        for (int d = 0; d < c; ++d) {
+            sibling[c] += package[d] == package[c] && core[d] == core[c];
+        }
+    }
+    for (int c = 0; c < binding_count; ++c) {
+        int rank = 0;
+        for (int d = 0; d < c; ++d) {
+            rank += node[d] == node[c] && sibling[d] == sibling[c];
+        }
+        cpus[c].cpu = allowed_cpus[c];
+        cpus[c].key[0] = sibling[c];
+        cpus[c].key[1] = policy == BINDING_SPREAD ? rank : node[c];
+        cpus[c].key[2] = policy == BINDING_SPREAD ? node[c] : allowed_cpus[c];
+    }
+    qsort(cpus, (size_t) binding_count, sizeof(placement_cpu_t), placement_compare);
+    for (int c = 0; c < binding_count; ++c) {
+        binding_order[c] = cpus[c].cpu;
+    }
+    binding_policy = policy;
+    free(cpus);
+    free(topology);
+}
+
+/**
+ * @brief Reports the huge pages backing the live large arrays
+ * @details hugetlbfs pages are reserved in full when mapped. Transparent huge pages are whatever the kernel actually
+ * provided: the AnonHugePages of every region in /proc/self/smaps overlapping a recorded mapping (a region merged with
+ * a neighbouring mapping is counted whole).
+ * @param outfile The stream to report to
+ */
+static void huge_page_report(FILE *outfile) {
+    size_t num_arrays = 0, pages_1g = 0, pages_2m = 0, transparent_bytes = 0, transparent_kb = 0, kb;
+    unsigned long start, end;
+    bool overlaps = false;
+    char line[256];
+#pragma omp critical(placement_mappings)
+    {
+        for (placement_mapping_t *m = mappings; m != NULL; m = m->next) {
+            num_arrays++;
+            if (m->transparent) {
+                transparent_bytes += m->length;
+            } else if (m->page_size == HUGE_PAGE_1G) {
+                pages_1g += m->length / HUGE_PAGE_1G;
+            } else {
+                pages_2m += m->length / HUGE_PAGE_2M;
+            }
+        }
+        FILE *smaps = transparent_bytes > 0 ? fopen("/proc/self/smaps", "r") : NULL;
+        if (smaps != NULL) {
+            while (fgets(line, sizeof(line), smaps) != NULL) {
+                if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+                    overlaps = false;
+                    for (placement_mapping_t *m = mappings; m != NULL; m = m->next) {
+                        overlaps |= m->transparent && (uintptr_t) m->address < end &&
+                                    (uintptr_t) m->address + m->length > start;
+                    }
+                } else if (overlaps && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+                    transparent_kb += kb;
+                }
+            }
+            fclose(smaps);
+        }
+    }
+    fprintf(outfile, "%zu Large arrays\n"
+                     "%zu 1GiB pages\n"
+                     "%zu 2MiB pages\n"
+                     "%zu/%zu Transparent 2MiB pages\n", num_arrays, pages_1g, pages_2m,
+            transparent_kb * 1024 / HUGE_PAGE_2M, transparent_bytes / HUGE_PAGE_2M);
+}
+
+#endif
+
+/**
+ * @brief Binds each thread of the OpenMP team to its own core in the order given by the policy
+ * @details Threads beyond the number of available CPUs wrap around. Nothing is done for BINDING_NONE, nor within a
+ * parallel region, whose thread keeps the core group given to it by bind_group().
+ * @param policy The binding policy
+ */
+void bind_threads(binding_policy_t policy) {
+#ifdef __linux__
+    if (policy == BINDING_NONE || omp_get_active_level() > 0) {
+        return;
+    }
+    binding_initialise(policy);
+#pragma omp parallel
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(binding_order[omp_get_thread_num() % binding_count], &set);
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+#else
+    (void) policy;
+#endif
+}
+
+/**
+ * @brief Binds the calling thread to a contiguous group of cores in the order given by the policy
+ * @details Used by the outer threads of nested parallel regions: the inner teams they create inherit the group's mask,
+ * so concurrent evaluations share neither cores nor (where the group fits) a NUMA node. Call bind_threads() once the
+ * outer region ends to restore one core per thread. Nothing is done for BINDING_NONE.
+ * @param policy The binding policy
+ * @param group The index of the group
+ * @param group_size The number of cores in each group
+ */
+void bind_group(binding_policy_t policy, int group, int group_size) {
+#ifdef __linux__
+    if (policy == BINDING_NONE) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+#pragma omp critical(placement)
+    binding_initialise(policy);
+    for (int k = 0; k < group_size; ++k) {
+        CPU_SET(binding_order[(group * group_size + k) % binding_count], &set);
+    }
+    sched_setaffinity(0, sizeof(set), &set);
+#else
+    (void) policy;
+    (void) group;
+    (void) group_size;
+#endif
+}
+
+/**
+ * @brief Reports the CPU and NUMA node of every thread, the nodes holding a sample of the cost vector's pages and the
+ * huge pages backing the large arrays
+ * @param meta_spec Data structure containing the binding policy and the cost vector
+ * @param outfile The stream to report to
+ */
+void placement_report(qaoa_data_t *meta_spec, FILE *outfile) {
+    const char *names[] = {"none", "close", "spread"};
+    int num_threads = omp_get_max_threads();
+    fprintf(outfile, "Placement report:\n"
+                     "%s Binding\n"
+                     "%d Threads\n", names[meta_spec->run_spec->binding], num_threads);
+#ifdef __linux__
+    int *cpus = malloc(num_threads * sizeof(int));
+    check_alloc(cpus);
+#pragma omp parallel num_threads(num_threads)
+    cpus[omp_get_thread_num()] = sched_getcpu();
+    for (int t = 0; t < num_threads; ++t) {
+        fprintf(outfile, "%d: %d CPU %d Node\n", t, cpus[t], cpus[t] < 0 ? -1 : cpu_node(cpus[t]));
+    }
+    free(cpus);
+
+#ifdef SYS_move_pages
+    //A NULL node list makes move_pages() report where each page resides without moving it
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    //No cost vector is stored for a Hamiltonian of Z strings
+    size_t bytes = meta_spec->uc == NULL ? 0 : (size_t) meta_spec->uc->length * cost_type_size(meta_spec->uc->type);
+    size_t num_pages = (bytes + page - 1) / page;
+    unsigned long num_samples = num_pages < PLACEMENT_PAGE_SAMPLES ? num_pages : PLACEMENT_PAGE_SAMPLES;
+    void *pages[PLACEMENT_PAGE_SAMPLES];
+    int status[PLACEMENT_PAGE_SAMPLES];
+    int counts[PLACEMENT_MAX_NODES] = {0};
+    for (unsigned long s = 0; s < num_samples; ++s) {
+        pages[s] = (char *) meta_spec->uc->values + (s * num_pages / num_samples) * page;
+    }
+    if (syscall(SYS_move_pages, 0, num_samples, pages, NULL, status, 0) == 0) {
+        for (unsigned long s = 0; s < num_samples; ++s) {
+            if (status[s] >= 0 && status[s] < PLACEMENT_MAX_NODES) {
+                counts[status[s]]++;
+            }
+        }
+        for (int n = 0; n < PLACEMENT_MAX_NODES; ++n) {
+            if (counts[n] > 0) {
+                fprintf(outfile, "%d: %d/%lu UC pages sampled\n", n, counts[n], num_samples);
+            }
+        }
+    }
+#endif
+    huge_page_report(outfile);
+#endif
+}
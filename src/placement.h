@@ -0,0 +1,49 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief NUMA-aware allocation, thread-to-core binding and placement reporting
+ * @details Large vectors are zeroed in parallel with the static partition the kernels use, so that under the default
+ * first-touch policy each thread's share of every vector lives on its own socket. On Linux vectors of 8 MiB or more
+ * are also backed by huge pages, cutting the TLB misses of the mixer's strided bit-flip access. Binding and huge pages
+ * are Linux only; elsewhere binding is a no-op and every array comes from mkl_malloc().
+ *
+ * Placing a large array costs a mapping, page faults and the kernel's zeroing of every page, so the temporaries of the
+ * evaluations (states, mixer work vectors and probabilities) are not allocated anew each time. A run keeps them in a
+ * numa_pool_t: each array is placed by numa_allocate() the first time it is needed and then handed from evaluation to
+ * evaluation until the run ends.
+ */
+
+#ifndef QOLAB_PLACEMENT_H
+#define QOLAB_PLACEMENT_H
+
+#include "globals.h"
+
+void *numa_allocate(size_t count, size_t size);
+
+void numa_free(void *array);
+
+/*! Arrays of one size, placed once and reused by the temporaries of a run's evaluations */
+typedef struct numa_pool {
+    size_t count;           /**< The number of elements of each array */
+    size_t size;            /**< The size of each element */
+    void **arrays;          /**< The arrays not currently taken */
+    int available;          /**< The number of arrays not currently taken */
+    int capacity;           /**< The length of arrays */
+    omp_lock_t lock;        /**< Guards the pool, which concurrent evaluations share */
+} numa_pool_t;
+
+numa_pool_t *numa_pool_create(size_t count, size_t size);
+
+void *numa_pool_take(numa_pool_t *pool);
+
+void numa_pool_give(numa_pool_t *pool, void *array);
+
+void numa_pool_destroy(numa_pool_t *pool);
+
+void bind_threads(binding_policy_t policy);
+
+void bind_group(binding_policy_t policy, int group, int group_size);
+
+void placement_report(qaoa_data_t *meta_spec, FILE *outfile);
+
+#endif //QOLAB_PLACEMENT_H
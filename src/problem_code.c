@@ -6,21 +6,21 @@
 
 /**
  * @brief To be implemented by the user. This defines the problem investigated by the QAOA
- * @param i
+ * @param i The candidate solution (state index, 64-bit under ILP64)
  * @param num_qubits
  * @param cost_data
  * @return A single integer value
  */
-int Cx(int i, int num_qubits, cost_data_t *cost_data){
-    return i;
+int Cx(MKL_INT i, int num_qubits, cost_data_t *cost_data){
+    return (int) i;
 }
 
 /**
  * @brief An optional function to be implemented by the user. Determines whether a given candidate solution is valid
- * @param i The candidate solution
+ * @param i The candidate solution (state index, 64-bit under ILP64)
  * @param cost_data Contains problem dependent data, may or may not be useful
  * @return True if the given solution is valid, false otherwise
  */
-bool mask(unsigned int i, cost_data_t *cost_data) {
+bool mask(MKL_INT i, cost_data_t *cost_data) {
     return true;
 }
\ No newline at end of file
@@ -18,10 +18,12 @@ typedef struct {
     MKL_INT cx_range;   // The upper bound of cost-function output values.
     MKL_INT *graph;
     MKL_INT num_vertices;
+    struct ising_hamiltonian *hamiltonian; // Optional Z-string form of the cost function used instead of Cx (see ising.h)
 } cost_data_t;
 
-int Cx(int i, int num_qubits, cost_data_t *cost_data);
+//Both are called concurrently from OpenMP threads and must not modify shared state
+int Cx(MKL_INT i, int num_qubits, cost_data_t *cost_data);
 
-bool mask(unsigned int i, cost_data_t *cost_data);
+bool mask(MKL_INT i, cost_data_t *cost_data);
 
 #endif //QOLAB_PROBLEM_CODE_H
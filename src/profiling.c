@@ -0,0 +1,220 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Per-kernel instrumentation of the simulation hot path, emitted as JSON
+ * @details A run's counters are shared by the threads attached to it and updated atomically, so its concurrent
+ * evaluations (multi-start or batched optimisers) accumulate into the same totals; times are then summed over threads.
+ * The attached profile is threadprivate. Hardware counters are opened per
+ * online CPU (pid = -1) so that work done by MKL and OpenMP worker threads is included, which requires
+ * perf_event_paranoid <= 0 or CAP_PERFMON. They are system-wide over each kernel's interval and therefore overlap when
+ * kernels run concurrently or nest (SpMV within the mixer); they are exact for the outermost kernel of a single start
+ * of a single run.
+ */
+#ifdef QOLAB_PROFILE
+#ifdef QOLAB_PERF_EVENTS
+#define _GNU_SOURCE
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <mkl.h>
+#include "globals.h"
+#include "profiling.h"
+
+static const char *kernel_names[PROFILE_NUM_KERNELS] = {
+        "evaluation", "phase", "mixer", "spmv", "gradient", "measure", "sample"
+};
+
+static profile_t *attached = NULL;   /* The profile the calling thread's kernels accumulate into */
+#pragma omp threadprivate(attached)
+
+#ifdef QOLAB_PERF_EVENTS
+static int num_cpus = 0;        /* The number of CPUs with open counters (0 if unavailable) */
+static int *cycle_fds = NULL;   /* Per-CPU cycle counters */
+static int *miss_fds = NULL;    /* Per-CPU last-level cache miss counters */
+
+/**
+ * @brief Opens a hardware counter on a single CPU covering all processes
+ * @param config The generic hardware event
+ * @param cpu The CPU to count on
+ * @return The file descriptor of the counter, -1 on failure
+ */
+int perf_open(unsigned long long config, int cpu) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.exclude_hv = 1;
+    return (int) syscall(SYS_perf_event_open, &attr, -1, cpu, -1, 0);
+}
+
+/**
+ * @brief Opens the per-CPU counters once per process, disabling hardware counters if any cannot be opened
+ */
+void perf_initialise(void) {
+    int cpus = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    cycle_fds = malloc(cpus * sizeof(int));
+    miss_fds = malloc(cpus * sizeof(int));
+    for (int c = 0; c < cpus; ++c) {
+        cycle_fds[c] = perf_open(PERF_COUNT_HW_CPU_CYCLES, c);
+        miss_fds[c] = perf_open(PERF_COUNT_HW_CACHE_MISSES, c);
+        if (cycle_fds[c] < 0 || miss_fds[c] < 0) {
+            perror("Attempting to open hardware counters");
+            for (int d = 0; d <= c; ++d) {
+                if (cycle_fds[d] >= 0) close(cycle_fds[d]);
+                if (miss_fds[d] >= 0) close(miss_fds[d]);
+            }
+            free(cycle_fds);
+            free(miss_fds);
+            cycle_fds = miss_fds = NULL;
+            num_cpus = -1;
+            return;
+        }
+    }
+    num_cpus = cpus;
+}
+
+/**
+ * @brief Sums a counter over every CPU
+ * @param fds The per-CPU file descriptors of the counter
+ * @return The total count
+ */
+long long perf_read(const int *fds) {
+    long long total = 0, value;
+    for (int c = 0; c < num_cpus; ++c) {
+        if (read(fds[c], &value, sizeof(value)) == sizeof(value)) {
+            total += value;
+        }
+    }
+    return total;
+}
+#endif
+
+/**
+ * @brief Creates the cleared counters of a run, opening the hardware counters on first use
+ * @return The profile, to be released with profile_destroy()
+ */
+profile_t *profile_create(void) {
+    profile_t *profile = mkl_malloc(sizeof(profile_t), DEF_ALIGNMENT);
+    check_alloc(profile);
+    for (int k = 0; k < PROFILE_NUM_KERNELS; ++k) {
+        profile->counters[k] = (profile_counter_t) {0, 0.0, 0, 0, 0, 0};
+    }
+#ifdef QOLAB_PERF_EVENTS
+#pragma omp critical (profile_perf)
+    if (num_cpus == 0) {
+        perf_initialise();
+    }
+#endif
+    return profile;
+}
+
+/**
+ * @brief Attaches a profile to the calling thread, whose kernels then accumulate into it
+ * @param profile The profile (NULL to stop counting)
+ * @return The profile previously attached, to be restored once the thread is done
+ */
+profile_t *profile_attach(profile_t *profile) {
+    profile_t *previous = attached;
+    attached = profile;
+    return previous;
+}
+
+/**
+ * @brief Captures the state at the beginning of a kernel
+ * @return The time (and hardware counts) at entry
+ */
+profile_mark_t profile_begin(void) {
+    profile_mark_t mark = {0.0, 0, 0};
+#ifdef QOLAB_PERF_EVENTS
+    if (num_cpus > 0) {
+        mark.cycles = perf_read(cycle_fds);
+        mark.llc_misses = perf_read(miss_fds);
+    }
+#endif
+    mark.start = dsecnd();
+    return mark;
+}
+
+/**
+ * @brief Accumulates the counters of a kernel that began at mark
+ * @param kernel The kernel that completed
+ * @param mark The state captured by profile_begin()
+ * @param bytes The bytes the kernel moved to and from memory
+ * @param terms The number of Chebyshev terms used (0 for other kernels)
+ */
+void profile_end(profile_kernel_t kernel, profile_mark_t mark, long long bytes, long long terms) {
+    double seconds = dsecnd() - mark.start;
+    long long cycles = 0, llc_misses = 0;
+    if (attached == NULL) {
+        return;
+    }
+#ifdef QOLAB_PERF_EVENTS
+    if (num_cpus > 0) {
+        cycles = perf_read(cycle_fds) - mark.cycles;
+        llc_misses = perf_read(miss_fds) - mark.llc_misses;
+    }
+#endif
+    profile_counter_t *counter = &attached->counters[kernel];
+#pragma omp atomic
+    counter->calls++;
+#pragma omp atomic
+    counter->seconds += seconds;
+#pragma omp atomic
+    counter->bytes += bytes;
+#pragma omp atomic
+    counter->terms += terms;
+#pragma omp atomic
+    counter->cycles += cycles;
+#pragma omp atomic
+    counter->llc_misses += llc_misses;
+}
+
+/**
+ * @brief Writes all counters as a single JSON object
+ * @details Bandwidth is the algorithmic bytes over time. With hardware counters, DRAM bandwidth is estimated as one
+ * 64-byte line per last-level cache miss.
+ * @param profile The counters of the run
+ * @param outfile The file stream to print to
+ */
+void profile_report(const profile_t *profile, FILE *outfile) {
+    bool hardware = false;
+#ifdef QOLAB_PERF_EVENTS
+    hardware = num_cpus > 0;
+#endif
+    if (outfile == NULL) {
+        outfile = stdout;
+    }
+    fprintf(outfile, "{\"hardware_counters\": %s, \"kernels\": {", hardware ? "true" : "false");
+    for (int k = 0; k < PROFILE_NUM_KERNELS; ++k) {
+        const profile_counter_t *counter = &profile->counters[k];
+        double seconds = counter->seconds > 0.0 ? counter->seconds : 1.0;
+        fprintf(outfile, "%s\n  \"%s\": {\"calls\": %lld, \"seconds\": %.9e, \"bytes\": %lld, \"bandwidth_gbs\": %.6e",
+                k == 0 ? "" : ",", kernel_names[k], counter->calls, counter->seconds, counter->bytes,
+                counter->bytes / seconds * 1e-9);
+        if (k == PROFILE_MIXER) {
+            fprintf(outfile, ", \"terms\": %lld", counter->terms);
+        }
+        if (hardware) {
+            fprintf(outfile, ", \"cycles\": %lld, \"llc_misses\": %lld, \"dram_gbs_estimate\": %.6e",
+                    counter->cycles, counter->llc_misses, counter->llc_misses * 64.0 / seconds * 1e-9);
+        }
+        fprintf(outfile, "}");
+    }
+    fprintf(outfile, "\n}}\n");
+}
+
+/**
+ * @brief Releases the counters of a run
+ * @param profile The profile (detached from every thread)
+ */
+void profile_destroy(profile_t *profile) {
+    mkl_free(profile);
+}
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Per-kernel instrumentation of the simulation hot path
+ * @details Compiled in with -DQOLAB_PROFILE, otherwise every macro below expands to nothing (including the byte-count
+ * expressions handed to them). Adding -DQOLAB_PERF_EVENTS (Linux only) also reads cycles and last-level cache misses
+ * through perf_event_open.
+ * Times are inclusive of nested kernels. Bytes are the algorithmic traffic of each kernel's own operands (state
+ * vectors, diagonals, CSR arrays), except that the mixer includes its SpMVs; evaluations record time only.
+ *
+ * Every run (qaoa_solve()) owns its counters. A kernel accumulates into the profile attached to the calling thread, so
+ * the threads that evaluate on a run's behalf (multi-start workers and batched points) attach the run's profile with
+ * PROFILE_ATTACH() and restore their previous one with PROFILE_DETACH(). Kernels called with no profile attached are
+ * not counted. Concurrent runs (see job_runner.h) therefore report only their own kernels.
+ */
+
+#ifndef QOLAB_PROFILING_H
+#define QOLAB_PROFILING_H
+
+#include <stdio.h>
+
+/*! The instrumented kernels */
+typedef enum {
+    PROFILE_EVALUATION, /**< A full objective evaluation (evolve() or evolve_restricted()) */
+    PROFILE_PHASE,      /**< Application of the phase separator */
+    PROFILE_MIXER,      /**< Application of the mixer (Chebyshev expansion, includes its SpMVs) */
+    PROFILE_SPMV,       /**< A single sparse matrix-vector product */
+    PROFILE_GRADIENT,   /**< The adjoint gradient back-propagation */
+    PROFILE_MEASURE,    /**< Exact computation of the objective from the state */
+    PROFILE_SAMPLE,     /**< Sampling the objective from the state */
+    PROFILE_NUM_KERNELS
+} profile_kernel_t;
+
+#ifdef QOLAB_PROFILE
+
+/*! The accumulated counters of one kernel */
+typedef struct {
+    long long calls;        /**< The number of calls */
+    double seconds;         /**< The total wall-clock time */
+    long long bytes;        /**< The (algorithmic) bytes moved to and from memory */
+    long long terms;        /**< Chebyshev terms used (mixer only) */
+    long long cycles;       /**< CPU cycles (perf events only) */
+    long long llc_misses;   /**< Last-level cache misses (perf events only) */
+} profile_counter_t;
+
+/*! The counters of one run */
+typedef struct profile {
+    profile_counter_t counters[PROFILE_NUM_KERNELS]; /**< The counters of each kernel */
+} profile_t;
+
+/*! The state captured when a kernel begins */
+typedef struct {
+    double start;           /**< Wall-clock time */
+    long long cycles;       /**< Cycle count */
+    long long llc_misses;   /**< Last-level cache miss count */
+} profile_mark_t;
+
+profile_t *profile_create(void);
+
+profile_t *profile_attach(profile_t *profile);
+
+profile_mark_t profile_begin(void);
+
+void profile_end(profile_kernel_t kernel, profile_mark_t mark, long long bytes, long long terms);
+
+void profile_report(const profile_t *profile, FILE *outfile);
+
+void profile_destroy(profile_t *profile);
+
+#define PROFILE_BEGIN(mark) profile_mark_t mark = profile_begin()
+#define PROFILE_END(kernel, mark, bytes, terms) profile_end(kernel, mark, bytes, terms)
+#define PROFILE_CREATE() profile_create()
+#define PROFILE_ATTACH(saved, run_profile) struct profile *saved = profile_attach(run_profile)
+#define PROFILE_DETACH(saved) profile_attach(saved)
+#define PROFILE_REPORT(profile, outfile) profile_report(profile, outfile)
+#define PROFILE_DESTROY(profile) profile_destroy(profile)
+
+#else
+
+#define PROFILE_BEGIN(mark)
+#define PROFILE_END(kernel, mark, bytes, terms)
+#define PROFILE_CREATE() NULL
+#define PROFILE_ATTACH(saved, run_profile)
+#define PROFILE_DETACH(saved)
+#define PROFILE_REPORT(profile, outfile)
+#define PROFILE_DESTROY(profile)
+
+#endif
+
+#endif //QOLAB_PROFILING_H
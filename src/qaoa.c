@@ -8,75 +8,250 @@
 #include "state_evolve.h"
 #include "reporting.h"
 #include "eigen_solve.h"
+#include "optimisers.h"
+#include "param_store.h"
+#include "profiling.h"
+#include "placement.h"
+#include "trace.h"
+#include "lightcone.h"
+#include "ising.h"
+#include "cost_vector.h"
+#include "grover.h"
+#include "xy_mixer.h"
+#include "spectral_mixer.h"
+#include "state_cache.h"
+#include <omp.h>
+#include <limits.h>
+#include <string.h>
 
 //TODO Unit test all of the these
 /**
- * @brief Checks paramters in the meta-specification for validity
- * @param meta_spec The data-structure containing all relevant fields
- * @warning Number of qubits cannot exceed 31, we are forced to used 32bit integers for intel's FFTW backend
+ * @brief Checks the machine and run specifications for validity
+ * @param mach_spec The specification of the machine
+ * @param run_spec The specification of the run
+ * @warning UB holds num_qubits * pow(2, num_qubits) non-zeros indexed by MKL_INT, which limits an LP64 build to 26 qubits
+ * with the Chebyshev mixer (30 with the product mixer); larger runs require the ILP64 build (-DMKL_ILP64 with
+ * mkl_intel_ilp64)
  */
-void parameter_checking(qaoa_data_t *meta_spec) {
+void specification_checking(machine_spec_t *mach_spec, run_spec_t *run_spec) {
     //Check machine specification
-    if (meta_spec->machine_spec->num_qubits <= 0) {
+    if (mach_spec->num_qubits <= 0) {
         fprintf(stderr, "Invalid number of qubits.\n");
         exit(EXIT_FAILURE);
     }
-    if (meta_spec->machine_spec->num_qubits > 31) {
-        fprintf(stderr, "Too many qubits, numerical stability will fail.\n");
+    //Light-cone evaluation never holds the state-space
+    if (!run_spec->lightcone &&
+        ldexp(run_spec->mixer == MIXER_CHEBYSHEV ? (double) mach_spec->num_qubits : 1.0, mach_spec->num_qubits) >
+        (sizeof(MKL_INT) == sizeof(int) ? (double) INT_MAX : (double) LLONG_MAX)) {
+        fprintf(stderr, "Too many qubits for %d-bit indices, build with -DMKL_ILP64.\n", (int) (8 * sizeof(MKL_INT)));
+        exit(EXIT_FAILURE);
     }
-    if (meta_spec->machine_spec->P <= 0) {
+    if (mach_spec->P <= 0) {
         fprintf(stderr, "Invalid amount of decomposition.\n");
         exit(EXIT_FAILURE);
     }
 
     //Check run specification
-    if (meta_spec->run_spec->num_samples <= 0 && meta_spec->run_spec->sampling == true) {
+    if (run_spec->num_samples <= 0 && run_spec->sampling == true) {
         fprintf(stderr, "Too few samples.\n");
         exit(EXIT_FAILURE);
     }
-    if (meta_spec->run_spec->outfile == NULL) {
+    if (run_spec->outfile == NULL) {
         fprintf(stderr, "No output location.\n");
         exit(EXIT_FAILURE);
     }
+    if (run_spec->cheby_tolerance <= 0.0) {
+        fprintf(stderr, "Invalid Chebyshev tolerance.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->spectral_limit < 0) {
+        fprintf(stderr, "Invalid spectral limit.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->mixer != MIXER_CHEBYSHEV && run_spec->mixer != MIXER_PRODUCT && run_spec->mixer != MIXER_GROVER &&
+        run_spec->mixer != MIXER_XY) {
+        fprintf(stderr, "Invalid mixer.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->mixer == MIXER_XY) {
+        if (mach_spec->num_qubits < 2 || (run_spec->xy_topology != XY_RING && run_spec->xy_topology != XY_COMPLETE)) {
+            fprintf(stderr, "The XY mixer needs at least 2 qubits on a ring or complete graph.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (run_spec->xy_steps < 1) {
+            fprintf(stderr, "Invalid number of Trotter steps.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (run_spec->xy_weight < 0 || run_spec->xy_weight > mach_spec->num_qubits) {
+            fprintf(stderr, "Invalid Hamming weight for the XY mixer.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (run_spec->symmetric) {
+            fprintf(stderr, "The XY mixer does not support the symmetric half-space.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (run_spec->mixer == MIXER_PRODUCT && run_spec->restricted) {
+        fprintf(stderr, "The product mixer is only available for the unrestricted QAOA.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->block_length <= 0 ||
+        (run_spec->block_length & (run_spec->block_length - 1)) != 0) {
+        fprintf(stderr, "Block length must be a power of two.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->binding != BINDING_NONE && run_spec->binding != BINDING_CLOSE &&
+        run_spec->binding != BINDING_SPREAD) {
+        fprintf(stderr, "Invalid binding policy.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->trace_path != NULL && run_spec->trace_format != TRACE_BINARY &&
+        run_spec->trace_format != TRACE_CSV) {
+        fprintf(stderr, "Invalid trace format.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->lightcone && (run_spec->restricted || run_spec->sampling || run_spec->symmetric ||
+                                run_spec->objective != OBJECTIVE_EXPECTATION || run_spec->ooc_directory != NULL ||
+                                run_spec->mixer == MIXER_GROVER || run_spec->mixer == MIXER_XY)) {
+        fprintf(stderr, "Light-cone evaluation supports the exact expectation value of the unrestricted QAOA only.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->symmetric && mach_spec->num_qubits < 3) {
+        fprintf(stderr, "The symmetric half-space needs at least 3 qubits.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->ooc_directory != NULL && (run_spec->mixer == MIXER_CHEBYSHEV || run_spec->mixer == MIXER_XY)) {
+        fprintf(stderr, "Out-of-core runs require the product or Grover mixer.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->ooc_directory != NULL && run_spec->state_cache_bytes > 0) {
+        fprintf(stderr, "The state cache is not available out-of-core.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->objective == OBJECTIVE_CVAR &&
+        (run_spec->cvar_alpha <= 0.0 || run_spec->cvar_alpha > 1.0)) {
+        fprintf(stderr, "Invalid CVaR alpha.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (run_spec->objective == OBJECTIVE_GIBBS && run_spec->gibbs_eta <= 0.0) {
+        fprintf(stderr, "Invalid Gibbs eta.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Checks paramters in the meta-specification for validity
+ * @param meta_spec The data-structure containing all relevant fields
+ */
+void parameter_checking(qaoa_data_t *meta_spec) {
+    specification_checking(meta_spec->machine_spec, meta_spec->run_spec);
 
     //Check optimisation specification
     if (meta_spec->opt_spec->max_evals <= 0) {
         fprintf(stderr, "Invalid evaluation count.\n");
         exit(EXIT_FAILURE);
     }
+    if (meta_spec->opt_spec->optimiser_type < OPTIMISER_NLOPT || meta_spec->opt_spec->optimiser_type > OPTIMISER_CMAES) {
+        fprintf(stderr, "Invalid optimiser.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (meta_spec->opt_spec->strategy < STRATEGY_ZERO || meta_spec->opt_spec->strategy > STRATEGY_FOURIER) {
+        fprintf(stderr, "Invalid parameter strategy.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (meta_spec->opt_spec->fourier_q < 0) {
+        fprintf(stderr, "Invalid number of Fourier amplitudes.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (meta_spec->opt_spec->store_path != NULL) {
+        if (meta_spec->opt_spec->problem_class == NULL || meta_spec->opt_spec->problem_class[0] == '\0' ||
+            strlen(meta_spec->opt_spec->problem_class) >= STORE_CLASS_LENGTH ||
+            strpbrk(meta_spec->opt_spec->problem_class, " \t\n") != NULL) {
+            fprintf(stderr, "Invalid problem class for the parameter store.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (meta_spec->opt_spec->store_seeds <= 0) {
+            fprintf(stderr, "Invalid number of store seeds.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (meta_spec->opt_spec->num_starts <= 0) {
+        fprintf(stderr, "Invalid number of starts.\n");
+        exit(EXIT_FAILURE);
+    }
 
 }
 
 /**
- * @brief De-allocates all memory associated with a QAOA simulation
+ * @brief De-allocates the optimiser state of a QAOA simulation (the problem's operators are released by qaoa_release())
  * @param meta_spec The data-structure containing all relevant fields
  */
 void qaoa_teardown(qaoa_data_t *meta_spec){
-    mkl_sparse_destroy(meta_spec->ub);
-    mkl_free(meta_spec->uc);
     if (!meta_spec->run_spec->restart)
         mkl_free(meta_spec->opt_spec->parameters);
     mkl_free(meta_spec->opt_spec->lower_bounds);
     mkl_free(meta_spec->opt_spec->upper_bounds);
+    if (meta_spec->opt_spec->optimiser != NULL) {
+        nlopt_destroy(meta_spec->opt_spec->optimiser);
+    }
 }
 
-//TODO: Include custom optimisation method (not nlopt)
 /**
- * @brief Initializes the nlopt optimisation data-structures with provided fields
+ * @brief Creates an nlopt optimiser over the bounds in the optimisation specification
+ * @param meta_spec The data-structure handed to each objective evaluation
+ * @param num_params The number of parameters being optimised
+ * @return A new nlopt optimiser object
+ */
+nlopt_opt optimiser_create(qaoa_data_t *meta_spec, int num_params) {
+    nlopt_opt optimiser = nlopt_create(meta_spec->opt_spec->nlopt_method, (unsigned int) num_params);
+    nlopt_set_max_objective(optimiser, (nlopt_func) qaoa_objective, (void *) meta_spec);
+    nlopt_set_lower_bounds(optimiser, meta_spec->opt_spec->lower_bounds);
+    nlopt_set_upper_bounds(optimiser, meta_spec->opt_spec->upper_bounds);
+    nlopt_set_xtol_abs1(optimiser, meta_spec->opt_spec->xtol);
+    nlopt_set_ftol_abs(optimiser, meta_spec->opt_spec->ftol);
+    nlopt_set_maxeval(optimiser, meta_spec->opt_spec->max_evals);
+    return optimiser;
+}
+
+/**
+ * @brief Runs the optimiser selected in the optimisation specification from the given point
+ * @param meta_spec The data-structure containing all fields
+ * @param parameters The initial point, overwritten with the optimum found
+ * @param result The optimal value found
+ * @return The termination status of the optimiser
+ */
+nlopt_result optimise(qaoa_data_t *meta_spec, double *parameters, double *result) {
+    if (meta_spec->opt_spec->optimiser_type == OPTIMISER_NLOPT) {
+        return nlopt_optimize(meta_spec->opt_spec->optimiser, parameters, result);
+    }
+    return native_optimise(meta_spec, parameters, result);
+}
+
+/**
+ * @brief Initializes the optimisation data-structures with provided fields
+ * @details The nlopt object is only created when nlopt is the selected optimiser. Under the FOURIER strategy the
+ * parameters are q amplitudes for each of gamma and beta, bounded by the range of the angle they expand into and
+ * initialised to the lowest frequency only. If a parameter store is given, fresh parameters are then seeded from it.
  * @param meta_spec The data-structure containing all fields
  * @param retain If set, initializer won't allocate or reset parametesr
  * @warning Assumes paramters are of appropriate size and contain relevant values
  */
 void optimiser_Initialize(qaoa_data_t *meta_spec, bool retain) {
-    int num_params = 2 * meta_spec->machine_spec->P;
-    if (meta_spec->run_spec->restricted) {
-        num_params++;
-    }
+    int num_params = parameter_count(meta_spec);
+    int P = meta_spec->machine_spec->P;
     if (!retain) {
         meta_spec->opt_spec->parameters = mkl_calloc((size_t) num_params, sizeof(double), DEF_ALIGNMENT);
-        for (int i = 0; i < meta_spec->machine_spec->P; ++i) {
-            meta_spec->opt_spec->parameters[i] = (double) PI;
-            meta_spec->opt_spec->parameters[i + meta_spec->machine_spec->P] = (double) PI / 2.0;
+        if (meta_spec->opt_spec->strategy == STRATEGY_FOURIER) {
+            meta_spec->opt_spec->parameters[0] = (double) PI;
+            meta_spec->opt_spec->parameters[num_params / 2] = (double) PI / 2.0;
+        } else {
+            for (int i = 0; i < P; ++i) {
+                meta_spec->opt_spec->parameters[i] = (double) PI;
+                meta_spec->opt_spec->parameters[i + P] = (double) PI / 2.0;
+            }
+            if (meta_spec->run_spec->restricted) {
+                meta_spec->opt_spec->parameters[2 * P] = (double) PI / 2.0;
+            }
         }
     } else {
         if (meta_spec->opt_spec->parameters == NULL) {
@@ -88,85 +263,418 @@ void optimiser_Initialize(qaoa_data_t *meta_spec, bool retain) {
     meta_spec->opt_spec->lower_bounds = mkl_calloc((size_t) num_params, sizeof(double), DEF_ALIGNMENT);
     meta_spec->opt_spec->upper_bounds = mkl_calloc((size_t) num_params, sizeof(double), DEF_ALIGNMENT);
 
+    if (meta_spec->opt_spec->strategy == STRATEGY_FOURIER) {
+        int q = num_params / 2;
+        for (int k = 0; k < q; ++k) {
+            meta_spec->opt_spec->upper_bounds[k] = 2 * (double) PI;
+            meta_spec->opt_spec->lower_bounds[k] = -2 * (double) PI;
+            meta_spec->opt_spec->upper_bounds[k + q] = (double) PI;
+            meta_spec->opt_spec->lower_bounds[k + q] = -(double) PI;
+        }
+    } else {
+        for (int i = 0; i < P; ++i) {
+            meta_spec->opt_spec->upper_bounds[i] = 2 * (double) PI;
+            meta_spec->opt_spec->lower_bounds[i] = 0.0;
+            meta_spec->opt_spec->upper_bounds[i + P] = (double) PI;
+            meta_spec->opt_spec->lower_bounds[i + P] = 0.0;
+        }
+        if (meta_spec->run_spec->restricted) {
+            meta_spec->opt_spec->upper_bounds[2 * P] = (double) PI;
+            meta_spec->opt_spec->lower_bounds[2 * P] = 0.0;
+        }
+    }
+    if (!retain && meta_spec->opt_spec->store_path != NULL) {
+        store_seed(meta_spec);
+    }
+    meta_spec->opt_spec->optimiser = NULL;
+    if (meta_spec->opt_spec->optimiser_type == OPTIMISER_NLOPT) {
+        meta_spec->opt_spec->optimiser = optimiser_create(meta_spec, num_params);
+    }
+}
+
+/**
+ * @brief Runs several independent optimisers concurrently from different initial points
+ * @details Start 0 begins from the parameters in the optimisation specification, the remainder from uniformly random
+ * points within the bounds. Each start owns a copy of the meta-structure with its own parameters, statistics and
+ * optimiser while sharing the (read-only) UC and UB data. Start i draws from the run's stream skipped ahead by
+ * (i + 1) * QAOA_STREAM_STRIDE, so a seeded run is reproducible however the starts are scheduled. Starts are spread
+ * over the available cores with the MKL and OpenMP threads of each start reduced so that the total never exceeds the
+ * core count (that of the calling job's core group when nested, see job_runner.h). On completion the best start's
+ * parameters and result are written back into the shared specification and the per-start statistics are retained for
+ * reporting.
+ * @param meta_spec The fully initialised data-structure for the run
+ * @param num_params The number of parameters being optimised
+ */
+void multistart_optimise(qaoa_data_t *meta_spec, int num_params) {
+    int num_starts = meta_spec->opt_spec->num_starts;
+    int num_cores = mkl_get_max_threads();
+    int concurrent = num_starts < num_cores ? num_starts : num_cores;
+    int threads_per_start = num_cores / concurrent;
+    int max_levels = omp_get_max_active_levels();
+    bool outermost = omp_get_active_level() == 0;
+    int best = 0;
+    qaoa_data_t *workers = mkl_malloc(num_starts * sizeof(qaoa_data_t), DEF_ALIGNMENT);
+    qaoa_statistics_t *statistics = mkl_malloc(num_starts * sizeof(qaoa_statistics_t), DEF_ALIGNMENT);
+    optimization_spec_t *opt_specs = mkl_malloc(num_starts * sizeof(optimization_spec_t), DEF_ALIGNMENT);
+    check_alloc(workers);
+    check_alloc(statistics);
+    check_alloc(opt_specs);
+
+    for (int i = 0; i < num_starts; ++i) {
+        workers[i] = *meta_spec;
+        statistics[i] = *meta_spec->qaoa_statistics;
+        opt_specs[i] = *meta_spec->opt_spec;
+        workers[i].qaoa_statistics = &statistics[i];
+        workers[i].opt_spec = &opt_specs[i];
+        vslCopyStream(&workers[i].stream, meta_spec->stream);
+        vslSkipAheadStream(workers[i].stream, (long long) (i + 1) * QAOA_STREAM_STRIDE);
+        statistics[i].start = i;
+        statistics[i].trace_length = meta_spec->opt_spec->max_evals;
+        statistics[i].trace = mkl_calloc((size_t) statistics[i].trace_length, sizeof(double), DEF_ALIGNMENT);
+        opt_specs[i].parameters = mkl_malloc(num_params * sizeof(double), DEF_ALIGNMENT);
+        check_alloc(statistics[i].trace);
+        check_alloc(opt_specs[i].parameters);
+        if (i == 0) {
+            cblas_dcopy(num_params, meta_spec->opt_spec->parameters, 1, opt_specs[i].parameters, 1);
+        } else {
+            vdRngUniform(VSL_RNG_METHOD_UNIFORM_STD, meta_spec->stream, num_params, opt_specs[i].parameters, 0.0, 1.0);
+            for (int j = 0; j < num_params; ++j) {
+                opt_specs[i].parameters[j] = opt_specs[i].lower_bounds[j] + opt_specs[i].parameters[j] *
+                                             (opt_specs[i].upper_bounds[j] - opt_specs[i].lower_bounds[j]);
+            }
+        }
+        opt_specs[i].optimiser = NULL;
+        if (opt_specs[i].optimiser_type == OPTIMISER_NLOPT) {
+            opt_specs[i].optimiser = optimiser_create(&workers[i], num_params);
+        }
+    }
+
+    if (outermost) {
+        mkl_set_dynamic(0);
+        omp_set_max_active_levels(2);
+    }
+#pragma omp parallel for num_threads(concurrent) schedule(dynamic, 1)
+    for (int i = 0; i < num_starts; ++i) {
+        omp_set_num_threads(threads_per_start);
+        int previous = mkl_set_num_threads_local(threads_per_start);
+        if (outermost) {
+            bind_group(meta_spec->run_spec->binding, omp_get_thread_num(), threads_per_start);
+        }
+        PROFILE_ATTACH(worker_profile, workers[i].profile);
+        statistics[i].term_status = optimise(&workers[i], opt_specs[i].parameters, &statistics[i].result);
+        PROFILE_DETACH(worker_profile);
+        mkl_set_num_threads_local(previous);
+    }
+    if (outermost) {
+        omp_set_max_active_levels(max_levels);
+        bind_threads(meta_spec->run_spec->binding);
+    }
+
+    meta_spec->qaoa_statistics->num_evals = 0;
+    for (int i = 0; i < num_starts; ++i) {
+        if (statistics[i].result > statistics[best].result) {
+            best = i;
+        }
+        meta_spec->qaoa_statistics->num_evals += statistics[i].num_evals;
+        if (statistics[i].best_sample > meta_spec->qaoa_statistics->best_sample) {
+            meta_spec->qaoa_statistics->best_sample = statistics[i].best_sample;
+        }
+        if (statistics[i].best_expectation > meta_spec->qaoa_statistics->best_expectation) {
+            meta_spec->qaoa_statistics->best_expectation = statistics[i].best_expectation;
+        }
+        if (opt_specs[i].optimiser != NULL) {
+            nlopt_destroy(opt_specs[i].optimiser);
+        }
+        vslDeleteStream(&workers[i].stream);
+    }
+    meta_spec->qaoa_statistics->result = statistics[best].result;
+    meta_spec->qaoa_statistics->term_status = statistics[best].term_status;
+    cblas_dcopy(num_params, opt_specs[best].parameters, 1, meta_spec->opt_spec->parameters, 1);
 
-    for(int i = 0; i < meta_spec->machine_spec->P; ++i){
-        meta_spec->opt_spec->upper_bounds[i] = 2 * (double) PI;
-        meta_spec->opt_spec->lower_bounds[i] = 0.0;
-        meta_spec->opt_spec->upper_bounds[i + meta_spec->machine_spec->P] = (double) PI;
-        meta_spec->opt_spec->lower_bounds[i + meta_spec->machine_spec->P] = 0.0;
+    for (int i = 0; i < num_starts; ++i) {
+        mkl_free(opt_specs[i].parameters);
     }
+    mkl_free(opt_specs);
+    mkl_free(workers);
+    meta_spec->start_statistics = statistics;
+}
 
-    meta_spec->opt_spec->optimiser = nlopt_create(meta_spec->opt_spec->nlopt_method, (unsigned int) num_params);
+/**
+ * @brief Releases the per-start statistics of a multi-start run
+ * @param meta_spec The data-structure holding the statistics
+ */
+void multistart_teardown(qaoa_data_t *meta_spec) {
+    if (meta_spec->start_statistics == NULL) {
+        return;
+    }
+    for (int i = 0; i < meta_spec->opt_spec->num_starts; ++i) {
+        mkl_free(meta_spec->start_statistics[i].trace);
+    }
+    mkl_free(meta_spec->start_statistics);
+    meta_spec->start_statistics = NULL;
+}
 
-    if (meta_spec->run_spec->restricted) {
-        meta_spec->opt_spec->upper_bounds[meta_spec->machine_spec->P] = 2 * (double) PI;
-        meta_spec->opt_spec->lower_bounds[meta_spec->machine_spec->P] = 0.0;
-        meta_spec->opt_spec->parameters[meta_spec->machine_spec->P] = (double) PI / 2.0;
-        nlopt_set_max_objective(meta_spec->opt_spec->optimiser, (nlopt_func) evolve_restricted, (void *) meta_spec);
+/**
+ * @brief Builds the operators of a problem instance: the cost function UC and, for the Chebyshev mixer, the driver UB
+ * @details The result depends only on the instance (cost_data), the number of qubits, the mixer and the out-of-core
+ * directory, so it may be handed to any number of qaoa_solve() calls which agree on those. With run_spec->symmetric the
+ * cost function and mask are checked for invariance under flipping every bit and only the half-space with the top qubit
+ * clear is built, problem->space_dimension recording the halved dimension while mach_spec is left as it is. With
+ * run_spec->lightcone neither operator is built, only the light-cone evaluator of the graph (see lightcone.h). With
+ * cost_data->hamiltonian set UC is not stored, the kernels evaluate the Z strings on the fly (see ising.h); its maximum
+ * is still taken over the states accepted by mask(), like UC's, so restricted runs and masked mixers report ratios
+ * against a feasible optimum. When the Chebyshev mixer's UB has at most run_spec->spectral_limit feasible states it is
+ * also diagonalised on them, and the mixer applied from that eigendecomposition (see spectral_mixer.h).
+ * @param problem The structure to hold the operators
+ * @param mach_spec Contains the specification of the hypothetial quantum machine
+ * @param cost_data Contains information about the cost_function
+ * @param run_spec Contains specifcation of the type of simulation to be run
+ */
+void qaoa_prepare(qaoa_problem_t *problem, machine_spec_t *mach_spec, cost_data_t *cost_data, run_spec_t *run_spec) {
+    qaoa_data_t meta_spec;
+    qaoa_statistics_t statistics;
+    machine_spec_t working = *mach_spec;
+    MKL_INT ub_nnz;
+    meta_spec.qaoa_statistics = &statistics;
+    meta_spec.start_statistics = NULL;
+    meta_spec.machine_spec = &working;
+    meta_spec.run_spec = run_spec;
+    meta_spec.opt_spec = NULL;
+    meta_spec.cost_data = cost_data;
+    meta_spec.trace = NULL;
+    meta_spec.lightcone = NULL;
+    meta_spec.grover = NULL;
+    meta_spec.spectral = NULL;
+    meta_spec.state_cache = NULL;
+    meta_spec.stream = NULL;
+    meta_spec.profile = NULL;
+    meta_spec.workspace = NULL;
+    meta_spec.batch_lock = NULL;
+
+    specification_checking(mach_spec, run_spec);
+    if (cost_data->hamiltonian != NULL && (run_spec->sampling || run_spec->objective != OBJECTIVE_EXPECTATION ||
+                                           run_spec->symmetric || run_spec->lightcone)) {
+        fprintf(stderr, "Z-string Hamiltonians support the exact expectation value only.\n");
+        exit(EXIT_FAILURE);
+    }
+    bind_threads(run_spec->binding);
+    problem->lightcone = NULL;
+    problem->grover = NULL;
+    problem->spectral = NULL;
+    problem->space_dimension = mach_spec->space_dimension;
+    if (run_spec->lightcone) {
+        //Only the graph is needed, the light cones themselves depend on P (see qaoa_solve())
+        statistics.startTimes[1] = dsecnd();
+        problem->lightcone = lightcone_create(cost_data, mach_spec->num_qubits);
+        problem->uc = NULL;
+        problem->ub = NULL;
+        problem->ub_eigenvalue = mach_spec->num_qubits;
+        problem->max_value = (int) problem->lightcone->total_weight;
+        problem->max_index = 0;
+        problem->classical_exp = problem->lightcone->total_weight / 2.0;
+        problem->random_exp = problem->classical_exp;
+        problem->uc_seconds = dsecnd() - statistics.startTimes[1];
+        problem->ub_seconds = 0.0;
+        problem->num_runs = 0;
+        return;
+    }
+    if (run_spec->symmetric) {
+        MKL_INT broken = check_symmetry(&meta_spec, Cx, mask);
+        if (broken >= 0) {
+            fprintf(stderr, "The cost function is not symmetric under flipping every bit (state %lld).\n",
+                    (long long) broken);
+            exit(EXIT_FAILURE);
+        }
+        working.space_dimension /= 2;
+        problem->space_dimension = working.space_dimension;
+    }
+
+    //Initialise UC
+    statistics.startTimes[1] = dsecnd();
+    if (cost_data->hamiltonian != NULL) {
+        //Evaluated on the fly by the kernels, only the maximum needs a pass over the state-space
+        ising_check(cost_data->hamiltonian, mach_spec->num_qubits);
+        meta_spec.uc = NULL;
+        double maximum = ising_maximum(cost_data->hamiltonian, working.space_dimension, mask, cost_data,
+                                       &statistics.max_index);
+        if (maximum == -INFINITY) {
+            fprintf(stderr, "No state is feasible under the mask.\n");
+            exit(EXIT_FAILURE);
+        }
+        statistics.max_value = (int) floor(maximum + 0.5);
+        //Every Z string averages to zero over the state-space
+        statistics.classical_exp = cost_data->hamiltonian->offset;
+        statistics.random_exp = statistics.classical_exp;
+    } else {
+        generate_uc(&meta_spec, Cx, mask);
+    }
+    statistics.endTimes[1] = dsecnd();
+    if (run_spec->verbose) {
+        printf("UC Created\n");
+    }
+    //Initialise UB (the product, Grover and XY mixers apply their drivers without it)
+    statistics.startTimes[2] = dsecnd();
+    if (run_spec->mixer == MIXER_CHEBYSHEV) {
+        ub_nnz = generate_ub(&meta_spec, mask);
+        meta_spec.spectral = spectral_create(meta_spec.ub, run_spec->spectral_limit);
+        if (meta_spec.spectral != NULL) {
+            //UB's other eigenvalues are zero, its leading one is that of the feasible block
+            meta_spec.ub_eigenvalue = meta_spec.spectral->eigenvalues[meta_spec.spectral->dimension - 1];
+        } else {
+            meta_spec.ub_eigenvalue = max_eigen_find(meta_spec.ub);
+        }
+        //Convert UB to complex values
+        convert_ub(&meta_spec, ub_nnz);
+    } else if (run_spec->mixer == MIXER_GROVER) {
+        meta_spec.ub = NULL;
+        meta_spec.grover = grover_create(&meta_spec, mask);
+        meta_spec.ub_eigenvalue = 1.0;
+    } else if (run_spec->mixer == MIXER_XY) {
+        meta_spec.ub = NULL;
+        meta_spec.ub_eigenvalue = xy_mixer_terms(mach_spec->num_qubits, run_spec->xy_topology);
     } else {
-        nlopt_set_max_objective(meta_spec->opt_spec->optimiser, (nlopt_func) evolve, (void *) meta_spec);
+        meta_spec.ub = NULL;
+        meta_spec.ub_eigenvalue = mach_spec->num_qubits;
+    }
+    statistics.endTimes[2] = dsecnd();
+    if (run_spec->verbose) {
+        printf("UB Created\n");
     }
-    nlopt_set_lower_bounds(meta_spec->opt_spec->optimiser, meta_spec->opt_spec->lower_bounds);
-    nlopt_set_upper_bounds(meta_spec->opt_spec->optimiser, meta_spec->opt_spec->upper_bounds);
-    nlopt_set_xtol_abs1(meta_spec->opt_spec->optimiser, meta_spec->opt_spec->xtol);
-    nlopt_set_ftol_abs(meta_spec->opt_spec->optimiser, meta_spec->opt_spec->ftol);
-    nlopt_set_maxeval(meta_spec->opt_spec->optimiser, meta_spec->opt_spec->max_evals);
+    if (run_spec->verbose || run_spec->binding != BINDING_NONE) {
+        placement_report(&meta_spec, run_spec->outfile);
+    }
+
+    problem->uc = meta_spec.uc;
+    problem->ub = meta_spec.ub;
+    problem->grover = meta_spec.grover;
+    problem->spectral = meta_spec.spectral;
+    problem->ub_eigenvalue = meta_spec.ub_eigenvalue;
+    problem->max_value = statistics.max_value;
+    problem->max_index = statistics.max_index;
+    problem->classical_exp = statistics.classical_exp;
+    problem->random_exp = statistics.random_exp;
+    problem->uc_seconds = statistics.endTimes[1] - statistics.startTimes[1];
+    problem->ub_seconds = statistics.endTimes[2] - statistics.startTimes[2];
+    problem->num_runs = 0;
 }
 
 /**
- * @brief The main method which performs a QAOA simulation
+ * @brief Releases the operators built by qaoa_prepare()
+ * @param problem The operators
+ */
+void qaoa_release(qaoa_problem_t *problem) {
+    if (problem->lightcone != NULL) {
+        lightcone_destroy(problem->lightcone);
+        problem->lightcone = NULL;
+        return;
+    }
+    if (problem->ub != NULL) {
+        destroy_ub(problem->ub);
+    }
+    cost_vector_free(problem->uc);
+    grover_destroy(problem->grover);
+    spectral_destroy(problem->spectral);
+    problem->uc = NULL;
+    problem->ub = NULL;
+    problem->grover = NULL;
+    problem->spectral = NULL;
+}
+
+/**
+ * @brief Optimises the QAOA over prepared operators and reports the result
+ * @details The UC and UB build times are reported by the first run on the problem only, later runs report them as 0.
+ * With run_spec->state_cache_bytes set its evaluations share a layer-prefix state cache (see state_cache.h).
+ * @param problem The operators from qaoa_prepare(), with the same qubits, mixer and out-of-core directory as run_spec
  * @param mach_spec Contains the specification of the hypothetial quantum machine
  * @param cost_data Contains information about the cost_function
  * @param opt_spec Contains specification of the classical optimization routine
  * @param run_spec Contains specifcation of the type of simulation to be run
  * @param retain If set, will use parameter values in the opt_spec.
+ * @param result If not NULL, receives the final statistics of the run (without the convergence trace)
  * @warning If retain set, optimizer will expect values to be pre-initialized
  */
-void qaoa(machine_spec_t *mach_spec, cost_data_t *cost_data, optimization_spec_t *opt_spec, run_spec_t *run_spec,
-          bool retain) {
+void qaoa_solve(qaoa_problem_t *problem, machine_spec_t *mach_spec, cost_data_t *cost_data,
+                optimization_spec_t *opt_spec, run_spec_t *run_spec, bool retain, qaoa_statistics_t *result) {
     qaoa_data_t meta_spec;
     qaoa_statistics_t statistics;
-    MKL_INT ub_nnz;
+    //The problem's operators may act on half the machine's space
+    machine_spec_t working = *mach_spec;
+    working.space_dimension = problem->space_dimension;
     statistics.num_evals = 0;
     statistics.best_sample = -INFINITY;
     statistics.best_expectation = -INFINITY;
+    statistics.trace = NULL;
+    statistics.trace_length = 0;
+    statistics.start = 0;
     meta_spec.qaoa_statistics = &statistics;
-    meta_spec.machine_spec = mach_spec;
+    meta_spec.start_statistics = NULL;
+    meta_spec.machine_spec = &working;
     meta_spec.run_spec = run_spec;
     meta_spec.opt_spec = opt_spec;
     meta_spec.cost_data = cost_data;
 
-    srand((unsigned) time(0));
+    check_stream(vslNewStream(&meta_spec.stream, VSL_BRNG_PHILOX4X32X10,
+                              (MKL_UINT) (run_spec->seed != 0 ? run_spec->seed : (unsigned) time(0))));
 
     parameter_checking(&meta_spec);
+    bind_threads(run_spec->binding);
+    //The run's own kernel counters, restored to the caller's once it is done
+    meta_spec.profile = PROFILE_CREATE();
+    meta_spec.batch_lock = NULL;
+    PROFILE_ATTACH(caller_profile, meta_spec.profile);
+    //The evaluations' temporaries are allocated once and reused; out-of-core states are mapped from files instead
+    meta_spec.workspace = NULL;
+    if (problem->lightcone == NULL && run_spec->ooc_directory == NULL) {
+        meta_spec.workspace = numa_pool_create((size_t) working.space_dimension, sizeof(MKL_Complex16));
+    }
 
-    dsecnd();
-
-    //Initialise UC
-    meta_spec.uc = mkl_calloc((size_t) pow(2, meta_spec.machine_spec->num_qubits), sizeof(MKL_Complex16),
-                              DEF_ALIGNMENT);
-    meta_spec.qaoa_statistics->startTimes[0] = dsecnd();
-    meta_spec.qaoa_statistics->startTimes[1] = dsecnd();
-    generate_uc(&meta_spec, Cx, mask);
-    meta_spec.qaoa_statistics->endTimes[1] = dsecnd();
-    if (meta_spec.run_spec->verbose) {
-        printf("UC Created\n");
+    meta_spec.uc = problem->uc;
+    meta_spec.ub = problem->ub;
+    meta_spec.grover = problem->grover;
+    meta_spec.spectral = problem->spectral;
+    meta_spec.lightcone = problem->lightcone;
+    if (meta_spec.lightcone != NULL) {
+        lightcone_set_depth(meta_spec.lightcone, mach_spec->P);
     }
-    //Initialise UB
-    meta_spec.qaoa_statistics->startTimes[2] = dsecnd();
-    ub_nnz = generate_ub(&meta_spec, mask);
-    meta_spec.ub_eigenvalue = max_eigen_find(meta_spec.ub);
-    //Convert UB to complex values
-    convert_ub(&meta_spec, ub_nnz);
-    meta_spec.qaoa_statistics->endTimes[2] = dsecnd();
-    if (meta_spec.run_spec->verbose) {
-        printf("UB Created\n");
+    //Cached states depend on P and the restriction, so every solve starts with an empty cache
+    meta_spec.state_cache = NULL;
+    if (meta_spec.lightcone == NULL) {
+        meta_spec.state_cache = state_cache_create(run_spec->state_cache_bytes, working.space_dimension,
+                                                   mach_spec->P);
+    }
+    meta_spec.ub_eigenvalue = problem->ub_eigenvalue;
+    statistics.max_value = problem->max_value;
+    statistics.max_index = problem->max_index;
+    statistics.classical_exp = problem->classical_exp;
+    statistics.random_exp = problem->random_exp;
+    statistics.startTimes[1] = statistics.endTimes[1] = 0.0;
+    statistics.startTimes[2] = statistics.endTimes[2] = 0.0;
+    if (problem->num_runs++ == 0) {
+        statistics.endTimes[1] = problem->uc_seconds;
+        statistics.endTimes[2] = problem->ub_seconds;
+    }
+    statistics.startTimes[0] = dsecnd() - (statistics.endTimes[1] + statistics.endTimes[2]);
+
+    meta_spec.trace = NULL;
+    if (meta_spec.run_spec->trace_path != NULL) {
+        meta_spec.trace = trace_open(&meta_spec, parameter_count(&meta_spec));
     }
     optimiser_Initialize(&meta_spec, retain);
     meta_spec.qaoa_statistics->startTimes[3] = dsecnd();
-    meta_spec.qaoa_statistics->term_status = nlopt_optimize(meta_spec.opt_spec->optimiser,
-                                                            opt_spec->parameters, &meta_spec.qaoa_statistics->result);
+    if (meta_spec.opt_spec->num_starts > 1) {
+        multistart_optimise(&meta_spec, parameter_count(&meta_spec));
+    } else {
+        meta_spec.qaoa_statistics->term_status = optimise(&meta_spec, opt_spec->parameters,
+                                                          &meta_spec.qaoa_statistics->result);
+    }
     meta_spec.qaoa_statistics->endTimes[3] = dsecnd();
+    if (meta_spec.trace != NULL) {
+        trace_close(meta_spec.trace);
+        meta_spec.trace = NULL;
+    }
+    if (meta_spec.opt_spec->store_path != NULL && meta_spec.qaoa_statistics->term_status > 0) {
+        store_record(&meta_spec);
+    }
     meta_spec.qaoa_statistics->endTimes[0] = dsecnd();
     if (meta_spec.run_spec->verbose) {
         printf("Optimisation complete\n");
@@ -174,5 +682,33 @@ void qaoa(machine_spec_t *mach_spec, cost_data_t *cost_data, optimization_spec_t
     //Teardown
 
     final_report(&meta_spec);
+    state_cache_destroy(meta_spec.state_cache);
+    if (result != NULL) {
+        *result = statistics;
+    }
+    multistart_teardown(&meta_spec);
     qaoa_teardown(&meta_spec);
+    numa_pool_destroy(meta_spec.workspace);
+    vslDeleteStream(&meta_spec.stream);
+    PROFILE_DETACH(caller_profile);
+    PROFILE_DESTROY(meta_spec.profile);
+}
+
+/**
+ * @brief The main method which performs a QAOA simulation
+ * @details Prepares the problem's operators, solves once and releases them. Use qaoa_prepare(), qaoa_solve() and
+ * qaoa_release() directly to run several optimisations on the same instance.
+ * @param mach_spec Contains the specification of the hypothetial quantum machine
+ * @param cost_data Contains information about the cost_function
+ * @param opt_spec Contains specification of the classical optimization routine
+ * @param run_spec Contains specifcation of the type of simulation to be run
+ * @param retain If set, will use parameter values in the opt_spec.
+ * @warning If retain set, optimizer will expect values to be pre-initialized
+ */
+void qaoa(machine_spec_t *mach_spec, cost_data_t *cost_data, optimization_spec_t *opt_spec, run_spec_t *run_spec,
+          bool retain) {
+    qaoa_problem_t problem;
+    qaoa_prepare(&problem, mach_spec, cost_data, run_spec);
+    qaoa_solve(&problem, mach_spec, cost_data, opt_spec, run_spec, retain, NULL);
+    qaoa_release(&problem);
 }
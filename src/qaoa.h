@@ -3,12 +3,45 @@
  * @date 1/07/18
  */
 
+#ifndef QOLAB_QAOA_H
+#define QOLAB_QAOA_H
+
 #include <mkl.h>
 #include <stdbool.h>
 #include <time.h>
 #include "problem_code.h"
 #include "globals.h"
 
+/*! The operators of one problem instance, built once by qaoa_prepare() and shared by every qaoa_solve() on it */
+typedef struct {
+    cost_vector_t *uc;      /**< The cost function (NULL for a Hamiltonian of Z strings) */
+    sparse_matrix_t ub;     /**< The complex driver Hamiltonian (NULL for the product mixer) */
+    struct lightcone *lightcone; /**< The light-cone evaluator, replacing UC and UB (NULL unless run_spec->lightcone) */
+    struct grover_mixer *grover; /**< The feasible set of the Grover mixer, replacing UB (NULL unless MIXER_GROVER) */
+    struct spectral_mixer *spectral; /**< The eigendecomposition of UB on a small feasible space (NULL if none) */
+    MKL_INT space_dimension; /**< The amplitudes of the states evolved (half the machine's for a symmetric problem) */
+    double ub_eigenvalue;   /**< The leading eigenvalue of the driver */
+    int max_value;          /**< The maximum of the cost function over valid states (rounded for a Hamiltonian of Z
+                             * strings, the total weight, an upper bound, under light-cone evaluation) */
+    MKL_INT max_index;      /**< The first state attaining max_value */
+    double classical_exp;   /**< The mean of the cost function over its domain */
+    double random_exp;      /**< The mean of the cost function over the whole state-space */
+    double uc_seconds;      /**< The time taken to build UC */
+    double ub_seconds;      /**< The time taken to build UB */
+    int num_runs;           /**< The number of qaoa_solve() calls made on the problem */
+} qaoa_problem_t;
+
+void optimiser_Initialize(qaoa_data_t *meta_spec, bool retain);
+
+void qaoa_teardown(qaoa_data_t *meta_spec);
+
+void qaoa_prepare(qaoa_problem_t *problem, machine_spec_t *mach_spec, cost_data_t *cost_data, run_spec_t *run_spec);
+
+void qaoa_solve(qaoa_problem_t *problem, machine_spec_t *mach_spec, cost_data_t *cost_data,
+                optimization_spec_t *opt_spec, run_spec_t *run_spec, bool retain, qaoa_statistics_t *result);
+
+void qaoa_release(qaoa_problem_t *problem);
+
 void qaoa(machine_spec_t *mach_spec, cost_data_t *cost_data, optimization_spec_t *opt_spec, run_spec_t *run_spec,
           bool retain);
 /*! \mainpage Main Menu
@@ -62,4 +95,6 @@ void qaoa(machine_spec_t *mach_spec, cost_data_t *cost_data, optimization_spec_t
  *
  * \section licensing Licence
  * GPLv3
- */
\ No newline at end of file
+ */
+
+#endif //QOLAB_QAOA_H
@@ -4,7 +4,11 @@
  * @brief Contains methods used to print out reports
  */
 #include <time.h>
+#include <mathimf.h>
 #include "reporting.h"
+#include "profiling.h"
+#include "lightcone.h"
+#include "state_cache.h"
 
 /**
  * @brief Generates a filename for a given run
@@ -47,7 +51,8 @@ void machine_report(machine_spec_t *mach_spec, FILE *outfile) {
     fprintf(outfile, "Machine Specification:\n"
                      "Qubits: %d\n"
                      "Decomposition: %d\n"
-                     "Space Dimension: %d\n", mach_spec->num_qubits, mach_spec->P, mach_spec->space_dimension);
+                     "Space Dimension: %lld\n", mach_spec->num_qubits, mach_spec->P,
+            (long long) mach_spec->space_dimension);
 }
 
 /**
@@ -72,6 +77,33 @@ void timing_report(qaoa_statistics_t *statistics, FILE *outfile){
             statistics->num_evals);
 }
 
+/**
+ * @brief Writes the per-kernel profile as JSON (only when built with QOLAB_PROFILE)
+ * @param run_spec Contains the profile path
+ * @param profile The run's kernel counters
+ * @param outfile The stream written to without a profile path
+ */
+void kernel_report(run_spec_t *run_spec, struct profile *profile, FILE *outfile) {
+#ifdef QOLAB_PROFILE
+    FILE *profile_file = outfile;
+    if (run_spec->profile_path != NULL) {
+        profile_file = fopen(run_spec->profile_path, "a");
+        if (profile_file == NULL) {
+            perror("Attempting to open profile file");
+            return;
+        }
+    }
+    PROFILE_REPORT(profile, profile_file);
+    if (profile_file != outfile) {
+        fclose(profile_file);
+    }
+#else
+    (void) run_spec;
+    (void) profile;
+    (void) outfile;
+#endif
+}
+
 /**
  * @brief Reports on the correctness of the algorithm
  * @param statistics Contains the correctness information
@@ -82,15 +114,15 @@ void result_report(qaoa_statistics_t *statistics, FILE *outfile){
         outfile = stdout;
     }
     fprintf(outfile, "Result report:\n"
-                     "%d %d gOpt, Loc\n"
+                     "%d %lld gOpt, Loc\n"
                      "%f Final Expectation\n"
-                     "%d Best Sample\n"
+                     "%lld Best Sample\n"
                      "%f Best expectation\n"
                      "%f Classical Exp\n"
                      "%f Initial Exp\n",
-            statistics->max_value, statistics->max_index,
+            statistics->max_value, (long long) statistics->max_index,
             statistics->result,
-            (MKL_INT) statistics->best_sample,
+            (long long) statistics->best_sample,
             statistics->best_expectation,
             statistics->classical_exp,
             statistics->random_exp);
@@ -99,30 +131,107 @@ void result_report(qaoa_statistics_t *statistics, FILE *outfile){
 
 /**
  * @brief Reports on the final state of the classical optimisation
+ * @details Under the FOURIER strategy the amplitudes are reported alongside the angles they expand into
  * @param opt_spec Contains the informaiton about the classical optimiser
  * @param P The amount of decomposition used in the simulation
+ * @param restricted Whether the parameters are for the restricted QAOA (reports the final beta)
  * @param outfile The file stream to print to
  */
-void optimiser_report(optimization_spec_t *opt_spec, int P, FILE *outfile) {
+void optimiser_report(optimization_spec_t *opt_spec, int P, bool restricted, FILE *outfile) {
     if (outfile == NULL) {
         outfile = stdout;
     }
     fprintf(outfile, "Optimisation report\n"
+                     "%d Optimiser\n"
                      "%d Method\n"
+                     "%d Strategy\n"
                      "%d Max evals\n"
                      "%.2e xtol\n"
                      "%.2e ftol\n",
+            opt_spec->optimiser_type,
             opt_spec->nlopt_method,
+            opt_spec->strategy,
             opt_spec->max_evals,
             opt_spec->xtol,
             opt_spec->ftol);
     int i,j;
+    int num_betas = P + (restricted ? 1 : 0);
+    double *angles = opt_spec->parameters;
+    if (opt_spec->strategy == STRATEGY_FOURIER) {
+        int q = fourier_amplitudes(P, opt_spec->fourier_q);
+        for (i = 0; i < q; ++i) {
+            fprintf(outfile, "%f ", opt_spec->parameters[i]);
+        }fprintf(outfile, "Gamma amplitudes\n");
+        for (j = 0; j < q; ++j) {
+            fprintf(outfile, "%f ", opt_spec->parameters[j + q]);
+        }fprintf(outfile, "Beta amplitudes\n");
+        angles = mkl_malloc((P + num_betas) * sizeof(double), DEF_ALIGNMENT);
+        check_alloc(angles);
+        fourier_expand(P, q, restricted, opt_spec->parameters, angles);
+    }
     for (i = 0; i < P; ++i) {
-        fprintf(outfile, "%f ", opt_spec->parameters[i]);
+        fprintf(outfile, "%f ", angles[i]);
     }fprintf(outfile, "Gammas\n");
-    for (j = 0; j < P; ++j) {
-        fprintf(outfile, "%f ", opt_spec->parameters[j + P]);
+    for (j = 0; j < num_betas; ++j) {
+        fprintf(outfile, "%f ", angles[j + P]);
     }fprintf(outfile, "Betas\n");
+    if (angles != opt_spec->parameters) {
+        mkl_free(angles);
+    }
+}
+
+/**
+ * @brief Reports on the objective function handed to the optimiser
+ * @param run_spec Contains the objective and its parameters
+ * @param outfile The file stream to print to
+ */
+void objective_report(run_spec_t *run_spec, FILE *outfile) {
+    if (outfile == NULL) {
+        outfile = stdout;
+    }
+    switch (run_spec->objective) {
+        case OBJECTIVE_CVAR:
+            fprintf(outfile, "%f CVaR alpha\n", run_spec->cvar_alpha);
+            break;
+        case OBJECTIVE_GIBBS:
+            fprintf(outfile, "%f Gibbs eta\n", run_spec->gibbs_eta);
+            break;
+        default:
+            fprintf(outfile, "Expectation objective\n");
+            break;
+    }
+}
+
+/**
+ * @brief Reports on each start of a multi-start optimisation
+ * @details Prints the final result and evaluation count of every start followed by its convergence trace, given as
+ * the best value found after each evaluation
+ * @param start_statistics The statistics of each start
+ * @param num_starts The number of starts run
+ * @param outfile The file stream to print to
+ */
+void multistart_report(qaoa_statistics_t *start_statistics, int num_starts, FILE *outfile) {
+    double best;
+    int length;
+    if (outfile == NULL) {
+        outfile = stdout;
+    }
+    fprintf(outfile, "Multi-start report:\n"
+                     "%d Starts\n", num_starts);
+    for (int i = 0; i < num_starts; ++i) {
+        fprintf(outfile, "%d: %f Result %d #Evals ", i, start_statistics[i].result, start_statistics[i].num_evals);
+        nlopt_termination_parser(start_statistics[i].term_status, outfile);
+        length = start_statistics[i].num_evals < start_statistics[i].trace_length ?
+                 start_statistics[i].num_evals : start_statistics[i].trace_length;
+        best = -INFINITY;
+        for (int j = 0; j < length; ++j) {
+            if (start_statistics[i].trace[j] > best) {
+                best = start_statistics[i].trace[j];
+            }
+            fprintf(outfile, "%f ", best);
+        }
+        fprintf(outfile, "Trace\n");
+    }
 }
 
 /**
@@ -140,26 +249,45 @@ void iteration_report(double measurement, qaoa_data_t *meta_spec) {
 
 /**
  * @brief Print a full report after the simulation has been run
+ * @details Written to a new file when run_spec->report is set, otherwise to run_spec->outfile. The run specification
+ * is left untouched, so runs sharing a process keep their own streams.
  * @param meta_spec Contains information about the simulation
  */
 void final_report(qaoa_data_t *meta_spec){
-    FILE *oFile;
+    FILE *oFile = meta_spec->run_spec->outfile;
     if(meta_spec->run_spec->report){
         oFile = file_generate(meta_spec);
-        meta_spec->run_spec->outfile = oFile;
-    } else {
-        meta_spec->run_spec->outfile = stdout;
     }
-    machine_report(meta_spec->machine_spec, meta_spec->run_spec->outfile);
+    machine_report(meta_spec->machine_spec, oFile);
+    if (meta_spec->run_spec->symmetric) {
+        fprintf(oFile, "Symmetric Half-Space: %lld of %lld states\n",
+                (long long) meta_spec->machine_spec->space_dimension,
+                2 * (long long) meta_spec->machine_spec->space_dimension);
+    }
+    if (meta_spec->lightcone != NULL) {
+        lightcone_report(meta_spec->lightcone, oFile);
+    }
+    if (meta_spec->state_cache != NULL) {
+        state_cache_report(meta_spec->state_cache, oFile);
+    }
     if (meta_spec->run_spec->timing) {
-        timing_report(meta_spec->qaoa_statistics, meta_spec->run_spec->outfile);
+        timing_report(meta_spec->qaoa_statistics, oFile);
+        kernel_report(meta_spec->run_spec, meta_spec->profile, oFile);
     }
     if (meta_spec->run_spec->correct) {
-        optimiser_report(meta_spec->opt_spec, meta_spec->machine_spec->P, meta_spec->run_spec->outfile);
-        result_report(meta_spec->qaoa_statistics, meta_spec->run_spec->outfile);
+        optimiser_report(meta_spec->opt_spec, meta_spec->machine_spec->P, meta_spec->run_spec->restricted, oFile);
+        objective_report(meta_spec->run_spec, oFile);
+        if (meta_spec->run_spec->trace_path != NULL) {
+            fprintf(oFile, "%s %s Trace\n", meta_spec->run_spec->trace_path,
+                    meta_spec->run_spec->trace_format == TRACE_CSV ? "CSV" : "Binary");
+        }
+        result_report(meta_spec->qaoa_statistics, oFile);
+        if (meta_spec->start_statistics != NULL) {
+            multistart_report(meta_spec->start_statistics, meta_spec->opt_spec->num_starts, oFile);
+        }
     }
     if(meta_spec->run_spec->report){
-        fclose(meta_spec->run_spec->outfile);
+        fclose(oFile);
     }
 }
 
@@ -9,8 +9,11 @@
 
 void machine_report(machine_spec_t * mach_spec, FILE *outfile);
 void timing_report(qaoa_statistics_t *statistics, FILE *outfile);
+void kernel_report(run_spec_t *run_spec, struct profile *profile, FILE *outfile);
 void result_report(qaoa_statistics_t *statistics, FILE *outfile);
-void optimiser_report(optimization_spec_t *opt_spec, int P, FILE *outfile);
+void optimiser_report(optimization_spec_t *opt_spec, int P, bool restricted, FILE *outfile);
+void objective_report(run_spec_t *run_spec, FILE *outfile);
+void multistart_report(qaoa_statistics_t *start_statistics, int num_starts, FILE *outfile);
 
 void iteration_report(double measurement, qaoa_data_t *meta_spec);
 void final_report(qaoa_data_t *meta_spec);
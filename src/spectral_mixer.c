@@ -0,0 +1,220 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief The dense spectral mixer over a small feasible space
+ * @details The feasible states are the columns of UB, found in one pass over its CSR. A is diagonalised by dsyevd. At
+ * each application the feasible amplitudes are gathered into an |F| x 2 matrix (their real and imaginary parts), so
+ * both products with V are level 3 BLAS calls on two and four right-hand sides.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <mathimf.h>
+#include "spectral_mixer.h"
+#include "placement.h"
+#include "profiling.h"
+
+/**
+ * @brief Orders two states for bsearch()
+ * @param a A state
+ * @param b Another state
+ * @return The sign of *a - *b
+ */
+static int compare_states(const void *a, const void *b) {
+    MKL_INT x = *(const MKL_INT *) a;
+    MKL_INT y = *(const MKL_INT *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Finds the position of a feasible state
+ * @param spectral The mixer, with its feasible states
+ * @param state A feasible state
+ * @return Its position in spectral->states
+ */
+static MKL_INT position(const spectral_t *spectral, MKL_INT state) {
+    const MKL_INT *found = bsearch(&state, spectral->states, (size_t) spectral->dimension, sizeof(MKL_INT),
+                                   compare_states);
+    return found - spectral->states;
+}
+
+/**
+ * @brief Diagonalises the driver on the feasible states if there are few enough of them
+ * @details Exits with an error message if the eigendecomposition fails.
+ * @param ub The real driver, before convert_ub()
+ * @param limit The largest number of feasible states diagonalised (0 never diagonalises)
+ * @return The mixer, to be released with spectral_destroy(), or NULL if there are more than limit feasible states
+ */
+spectral_t *spectral_create(sparse_matrix_t ub, MKL_INT limit) {
+    sparse_index_base_t index_base;
+    MKL_INT rows, cols;
+    MKL_INT *rows_start, *rows_end, *col_indx;
+    double *values;
+    MKL_INT dimension = 0;
+    mkl_error_parse(mkl_sparse_d_export_csr(ub, &index_base, &rows, &cols, &rows_start, &rows_end, &col_indx, &values),
+                    stderr);
+    if (limit <= 0) {
+        return NULL;
+    }
+
+    //The feasible states are the columns of UB
+    MKL_INT num_words = (rows + 63) / 64;
+    uint64_t *feasible = numa_allocate((size_t) num_words, sizeof(uint64_t));
+#pragma omp parallel for schedule(static)
+    for (MKL_INT i = 0; i < rows; ++i) {
+        for (MKL_INT k = rows_start[i]; k < rows_end[i]; ++k) {
+#pragma omp atomic
+            feasible[col_indx[k] / 64] |= (uint64_t) 1 << (col_indx[k] % 64);
+        }
+    }
+#pragma omp parallel for schedule(static) reduction(+:dimension)
+    for (MKL_INT w = 0; w < num_words; ++w) {
+        dimension += __builtin_popcountll(feasible[w]);
+    }
+    if (dimension == 0 || dimension > limit) {
+        numa_free(feasible);
+        return NULL;
+    }
+
+    spectral_t *spectral = mkl_malloc(sizeof(spectral_t), DEF_ALIGNMENT);
+    check_alloc(spectral);
+    spectral->dimension = dimension;
+    spectral->states = mkl_malloc(dimension * sizeof(MKL_INT), DEF_ALIGNMENT);
+    spectral->eigenvalues = mkl_malloc(dimension * sizeof(double), DEF_ALIGNMENT);
+    spectral->eigenvectors = mkl_calloc((size_t) (dimension * dimension), sizeof(double), DEF_ALIGNMENT);
+    check_alloc(spectral->states);
+    check_alloc(spectral->eigenvalues);
+    check_alloc(spectral->eigenvectors);
+    MKL_INT count = 0;
+    spectral->num_fed = 0;
+    for (MKL_INT i = 0; i < rows; ++i) {
+        if ((feasible[i / 64] >> (i % 64)) & 1) {
+            spectral->states[count++] = i;
+        } else if (rows_end[i] > rows_start[i]) {
+            spectral->num_fed++;
+        }
+    }
+
+    //A among the feasible rows, C from the rest
+    spectral->fed_states = mkl_malloc((spectral->num_fed + 1) * sizeof(MKL_INT), DEF_ALIGNMENT);
+    spectral->fed_begin = mkl_malloc((spectral->num_fed + 1) * sizeof(MKL_INT), DEF_ALIGNMENT);
+    check_alloc(spectral->fed_states);
+    check_alloc(spectral->fed_begin);
+    count = 0;
+    spectral->fed_begin[0] = 0;
+    for (MKL_INT i = 0; i < rows; ++i) {
+        if (!((feasible[i / 64] >> (i % 64)) & 1) && rows_end[i] > rows_start[i]) {
+            spectral->fed_states[count] = i;
+            spectral->fed_begin[count + 1] = spectral->fed_begin[count] + rows_end[i] - rows_start[i];
+            count++;
+        }
+    }
+    spectral->fed_sources = mkl_malloc((spectral->fed_begin[spectral->num_fed] + 1) * sizeof(MKL_INT),
+                                       DEF_ALIGNMENT);
+    check_alloc(spectral->fed_sources);
+#pragma omp parallel for schedule(static)
+    for (MKL_INT r = 0; r < spectral->num_fed; ++r) {
+        MKL_INT i = spectral->fed_states[r];
+        for (MKL_INT k = rows_start[i]; k < rows_end[i]; ++k) {
+            spectral->fed_sources[spectral->fed_begin[r] + k - rows_start[i]] = position(spectral, col_indx[k]);
+        }
+    }
+#pragma omp parallel for schedule(static)
+    for (MKL_INT p = 0; p < dimension; ++p) {
+        MKL_INT i = spectral->states[p];
+        for (MKL_INT k = rows_start[i]; k < rows_end[i]; ++k) {
+            spectral->eigenvectors[p * dimension + position(spectral, col_indx[k])] = values[k];
+        }
+    }
+    numa_free(feasible);
+
+    if (LAPACKE_dsyevd(LAPACK_ROW_MAJOR, 'V', 'U', dimension, spectral->eigenvectors, dimension,
+                       spectral->eigenvalues) != 0) {
+        fprintf(stderr, "The eigendecomposition of the feasible driver failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    return spectral;
+}
+
+/**
+ * @brief Applies exp(-i beta UB) to a state through the eigendecomposition
+ * @param spectral The mixer
+ * @param beta The mixing angle (negative to invert)
+ * @param state The state, updated in place
+ */
+void spectral_expm(const spectral_t *spectral, double beta, MKL_Complex16 *state) {
+    PROFILE_BEGIN(profile_mark);
+    MKL_INT n = spectral->dimension;
+    //Rows of gathered and rotated are complex numbers, rows of diagonal and work pairs of them (the two blocks)
+    double *gathered = mkl_malloc(2 * n * sizeof(double), DEF_ALIGNMENT);
+    double *rotated = mkl_malloc(2 * n * sizeof(double), DEF_ALIGNMENT);
+    double *diagonal = mkl_malloc(4 * n * sizeof(double), DEF_ALIGNMENT);
+    double *work = mkl_malloc(4 * n * sizeof(double), DEF_ALIGNMENT);
+    check_alloc(gathered);
+    check_alloc(rotated);
+    check_alloc(diagonal);
+    check_alloc(work);
+
+#pragma omp parallel for schedule(static)
+    for (MKL_INT p = 0; p < n; ++p) {
+        gathered[2 * p] = state[spectral->states[p]].real;
+        gathered[2 * p + 1] = state[spectral->states[p]].imag;
+    }
+    cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, n, 2, n, 1.0, spectral->eigenvectors, n, gathered, 2, 0.0,
+                rotated, 2);
+#pragma omp parallel for schedule(static)
+    for (MKL_INT k = 0; k < n; ++k) {
+        double angle = beta * spectral->eigenvalues[k];
+        double c = cos(angle);
+        double s = sin(angle);
+        double real = rotated[2 * k];
+        double imag = rotated[2 * k + 1];
+        //g(lambda) = (exp(-i beta lambda) - 1) / lambda, written to stay accurate as lambda approaches 0
+        double g_real = spectral->eigenvalues[k] == 0.0 ? 0.0 : -2.0 * sin(angle / 2.0) * sin(angle / 2.0) /
+                                                                spectral->eigenvalues[k];
+        double g_imag = spectral->eigenvalues[k] == 0.0 ? -beta : -s / spectral->eigenvalues[k];
+        diagonal[4 * k] = c * real + s * imag;
+        diagonal[4 * k + 1] = c * imag - s * real;
+        diagonal[4 * k + 2] = g_real * real - g_imag * imag;
+        diagonal[4 * k + 3] = g_real * imag + g_imag * real;
+    }
+    cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n, 4, n, 1.0, spectral->eigenvectors, n, diagonal, 4, 0.0,
+                work, 4);
+#pragma omp parallel for schedule(static)
+    for (MKL_INT p = 0; p < n; ++p) {
+        state[spectral->states[p]].real = work[4 * p];
+        state[spectral->states[p]].imag = work[4 * p + 1];
+    }
+#pragma omp parallel for schedule(static)
+    for (MKL_INT r = 0; r < spectral->num_fed; ++r) {
+        for (MKL_INT k = spectral->fed_begin[r]; k < spectral->fed_begin[r + 1]; ++k) {
+            state[spectral->fed_states[r]].real += work[4 * spectral->fed_sources[k] + 2];
+            state[spectral->fed_states[r]].imag += work[4 * spectral->fed_sources[k] + 3];
+        }
+    }
+
+    mkl_free(work);
+    mkl_free(diagonal);
+    mkl_free(rotated);
+    mkl_free(gathered);
+    //Two passes over V, the feasible amplitudes read and written and the fed amplitudes updated
+    PROFILE_END(PROFILE_MIXER, profile_mark, 2LL * n * n * (long long) sizeof(double) +
+                (2LL * n + 2LL * spectral->num_fed) * (long long) sizeof(MKL_Complex16), 0);
+}
+
+/**
+ * @brief Releases a spectral mixer
+ * @param spectral The mixer (may be NULL)
+ */
+void spectral_destroy(spectral_t *spectral) {
+    if (spectral == NULL) {
+        return;
+    }
+    mkl_free(spectral->fed_sources);
+    mkl_free(spectral->fed_begin);
+    mkl_free(spectral->fed_states);
+    mkl_free(spectral->eigenvectors);
+    mkl_free(spectral->eigenvalues);
+    mkl_free(spectral->states);
+    mkl_free(spectral);
+}
@@ -0,0 +1,36 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief The driver's mixer exp(-i beta B) from a dense eigendecomposition, for small feasible spaces
+ * @details UB connects every state to its feasible neighbours, so in the order (feasible F, other states) the driver is
+ * B = [A 0; C 0] with A the real symmetric driver among the feasible states. Then
+ * exp(-i beta B) = [exp(-i beta A) 0; C g(A) I] with g(x) = (exp(-i beta x) - 1) / x, and with A = V diag(lambda) V^T
+ * both blocks are two dense products with V around a diagonal: one pass over V^T and one over V, independent of the
+ * Chebyshev truncation. qaoa_prepare() diagonalises A once when |F| is at most run_spec->spectral_limit, and the
+ * Chebyshev mixer then applies this instead of spmatrix_expm_cheby().
+ */
+
+#ifndef QOLAB_SPECTRAL_MIXER_H
+#define QOLAB_SPECTRAL_MIXER_H
+
+#include "globals.h"
+
+/*! The eigendecomposition of the driver on the feasible states, and the other states it feeds */
+typedef struct spectral_mixer {
+    MKL_INT dimension;      /**< The number of feasible states |F| */
+    MKL_INT *states;        /**< The feasible states, ascending */
+    double *eigenvalues;    /**< The eigenvalues of A, ascending */
+    double *eigenvectors;   /**< The orthonormal eigenvectors of A, row-major (column k for eigenvalue k) */
+    MKL_INT num_fed;        /**< The number of other states with feasible neighbours (the rows of C) */
+    MKL_INT *fed_states;    /**< Those states */
+    MKL_INT *fed_begin;     /**< The first entry of each row of C in fed_sources (num_fed + 1 entries) */
+    MKL_INT *fed_sources;   /**< The positions in states of the feasible neighbours of each row of C */
+} spectral_t;
+
+spectral_t *spectral_create(sparse_matrix_t ub, MKL_INT limit);
+
+void spectral_expm(const spectral_t *spectral, double beta, MKL_Complex16 *state);
+
+void spectral_destroy(spectral_t *spectral);
+
+#endif //QOLAB_SPECTRAL_MIXER_H
@@ -0,0 +1,207 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief The layer-prefix state cache
+ * @details Entries are found by a linear scan comparing angles exactly, so only bit-identical prefixes match and a
+ * resumed evaluation gives the same result as a full one. Concurrent evaluations (multi-start workers and batched
+ * points) share the cache, so an entry is chosen under the cache's lock and pinned while its state is copied in or out
+ * after the lock is released: a pinned entry is neither evicted nor, while filling, resumed from. Each copy runs on
+ * the calling team with the kernels' static partition.
+ */
+
+#include "state_cache.h"
+#include "placement.h"
+
+/**
+ * @brief Copies a state with the kernels' static partition
+ * @param source The state copied
+ * @param target The state overwritten
+ * @param length The number of amplitudes
+ */
+static void copy_state(const MKL_Complex16 *source, MKL_Complex16 *target, MKL_INT length) {
+#pragma omp parallel for schedule(static)
+    for (MKL_INT i = 0; i < length; ++i) {
+        target[i] = source[i];
+    }
+}
+
+/**
+ * @brief Checks whether an entry was reached by the given angles
+ * @param entry The entry
+ * @param gamma The phase angle of each layer (at least entry->depth)
+ * @param beta The mixing angle of each layer
+ * @return Whether every layer of the entry has exactly these angles
+ */
+static bool prefix_matches(const state_cache_entry_t *entry, const double *gamma, const double *beta) {
+    for (int k = 0; k < entry->depth; ++k) {
+        if (entry->angles[2 * k] != gamma[k] || entry->angles[2 * k + 1] != beta[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Creates an empty cache for the evaluations of one run
+ * @param budget The memory the cached states may occupy in bytes
+ * @param length The number of amplitudes of each state
+ * @param max_depth The number of layers P
+ * @return The cache, to be released with state_cache_destroy(), or NULL if the budget does not hold a single state
+ */
+state_cache_t *state_cache_create(size_t budget, MKL_INT length, int max_depth) {
+    size_t capacity = budget / ((size_t) length * sizeof(MKL_Complex16));
+    if (capacity == 0 || max_depth < 1) {
+        return NULL;
+    }
+    if (capacity > STATE_CACHE_MAX_ENTRIES) {
+        capacity = STATE_CACHE_MAX_ENTRIES;
+    }
+    state_cache_t *cache = mkl_malloc(sizeof(state_cache_t), DEF_ALIGNMENT);
+    check_alloc(cache);
+    cache->length = length;
+    cache->max_depth = max_depth;
+    cache->capacity = (int) capacity;
+    cache->clock = 0;
+    cache->layers_applied = 0;
+    cache->layers_resumed = 0;
+    omp_init_lock(&cache->lock);
+    cache->entries = mkl_malloc(capacity * sizeof(state_cache_entry_t), DEF_ALIGNMENT);
+    check_alloc(cache->entries);
+    for (int e = 0; e < cache->capacity; ++e) {
+        cache->entries[e].depth = 0;
+        cache->entries[e].angles = mkl_malloc(2 * max_depth * sizeof(double), DEF_ALIGNMENT);
+        check_alloc(cache->entries[e].angles);
+        cache->entries[e].state = NULL;
+        cache->entries[e].used = 0;
+        cache->entries[e].readers = 0;
+        cache->entries[e].filling = false;
+    }
+    return cache;
+}
+
+/**
+ * @brief Copies out the deepest cached state whose layers have the given angles
+ * @details Also counts the layers resumed and, assuming the caller applies the rest, those applied.
+ * @param cache The cache
+ * @param gamma The phase angle of each of the P layers
+ * @param beta The mixing angle of each of the P layers
+ * @param state Receives the state after the returned number of layers (untouched if none match)
+ * @return The number of layers the state has had applied, 0 if no entry matches
+ */
+int state_cache_resume(state_cache_t *cache, const double *gamma, const double *beta, MKL_Complex16 *state) {
+    int depth = 0;
+    state_cache_entry_t *found = NULL;
+    omp_set_lock(&cache->lock);
+    for (int e = 0; e < cache->capacity; ++e) {
+        state_cache_entry_t *entry = cache->entries + e;
+        if (!entry->filling && entry->depth > depth && prefix_matches(entry, gamma, beta)) {
+            found = entry;
+            depth = entry->depth;
+        }
+    }
+    if (found != NULL) {
+        found->readers++;
+        found->used = ++cache->clock;
+    }
+    cache->layers_resumed += depth;
+    cache->layers_applied += cache->max_depth - depth;
+    omp_unset_lock(&cache->lock);
+
+    if (found != NULL) {
+        copy_state(found->state, state, cache->length);
+        omp_set_lock(&cache->lock);
+        found->readers--;
+        omp_unset_lock(&cache->lock);
+    }
+    return depth;
+}
+
+/**
+ * @brief Stores the state after a number of layers, replacing an unused or the least recently used entry
+ * @details Nothing is stored if the prefix is already held (or being stored) or every entry is pinned.
+ * @param cache The cache
+ * @param gamma The phase angle of each layer applied
+ * @param beta The mixing angle of each layer applied
+ * @param depth The number of layers applied (1 to P)
+ * @param state The state after them
+ */
+void state_cache_store(state_cache_t *cache, const double *gamma, const double *beta, int depth,
+                       const MKL_Complex16 *state) {
+    state_cache_entry_t *victim = NULL;
+    omp_set_lock(&cache->lock);
+    for (int e = 0; e < cache->capacity; ++e) {
+        state_cache_entry_t *entry = cache->entries + e;
+        //Another evaluation may have stored the same prefix meanwhile
+        if (entry->depth == depth && prefix_matches(entry, gamma, beta)) {
+            entry->used = ++cache->clock;
+            victim = NULL;
+            break;
+        }
+        if (entry->readers > 0 || entry->filling) {
+            continue;
+        }
+        if (victim == NULL || (victim->depth > 0 && (entry->depth == 0 || entry->used < victim->used))) {
+            victim = entry;
+        }
+    }
+    //The key is claimed now so the prefix is not stored twice, the state is filled in unlocked
+    if (victim != NULL) {
+        for (int k = 0; k < depth; ++k) {
+            victim->angles[2 * k] = gamma[k];
+            victim->angles[2 * k + 1] = beta[k];
+        }
+        victim->depth = depth;
+        victim->filling = true;
+    }
+    omp_unset_lock(&cache->lock);
+
+    if (victim != NULL) {
+        if (victim->state == NULL) {
+            victim->state = numa_allocate((size_t) cache->length, sizeof(MKL_Complex16));
+        }
+        copy_state(state, victim->state, cache->length);
+        omp_set_lock(&cache->lock);
+        victim->filling = false;
+        victim->used = ++cache->clock;
+        omp_unset_lock(&cache->lock);
+    }
+}
+
+/**
+ * @brief Reports how much evolution the cache saved
+ * @param cache The cache
+ * @param outfile The file stream to print to
+ */
+void state_cache_report(const state_cache_t *cache, FILE *outfile) {
+    int held = 0;
+    if (outfile == NULL) {
+        outfile = stdout;
+    }
+    for (int e = 0; e < cache->capacity; ++e) {
+        held += cache->entries[e].depth > 0;
+    }
+    fprintf(outfile, "State cache report:\n"
+                     "%d States held of %d\n"
+                     "%lld Layers applied\n"
+                     "%lld Layers resumed\n",
+            held, cache->capacity, cache->layers_applied, cache->layers_resumed);
+}
+
+/**
+ * @brief Releases a state cache
+ * @param cache The cache (may be NULL)
+ */
+void state_cache_destroy(state_cache_t *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    for (int e = 0; e < cache->capacity; ++e) {
+        if (cache->entries[e].state != NULL) {
+            numa_free(cache->entries[e].state);
+        }
+        mkl_free(cache->entries[e].angles);
+    }
+    omp_destroy_lock(&cache->lock);
+    mkl_free(cache->entries);
+    mkl_free(cache);
+}
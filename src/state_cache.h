@@ -0,0 +1,54 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief A cache of the states reached after each layer, keyed by the angles of the layers applied
+ * @details Derivative-free optimisers and finite differences often change only the later layers between evaluations.
+ * The evolution stores its state after every layer it applies and, on the next evaluation, resumes from the deepest
+ * stored layer whose angles (gamma and beta of every layer up to it) match exactly, applying only the layers after it.
+ * The cache holds as many states as fit in run_spec->state_cache_bytes and evicts the least recently used. It is
+ * created by qaoa_solve() for one run (a fixed P, restriction and set of operators) and shared by all of its
+ * evaluations, which may run concurrently.
+ */
+
+#ifndef QOLAB_STATE_CACHE_H
+#define QOLAB_STATE_CACHE_H
+
+#include <stdio.h>
+#include "globals.h"
+
+#define STATE_CACHE_MAX_ENTRIES 4096 /**< The most states held, whatever the budget (lookups scan every entry) */
+
+/*! One cached state */
+typedef struct {
+    int depth;                  /**< The number of layers applied to reach the state (0 while unused) */
+    double *angles;             /**< The gamma and beta of each of those layers, interleaved */
+    MKL_Complex16 *state;       /**< The state (NULL until first used) */
+    unsigned long long used;    /**< The cache clock when the entry was last stored or resumed from */
+    int readers;                /**< The evaluations copying the state out, which pin the entry */
+    bool filling;               /**< Whether an evaluation is copying the state in (not yet resumable) */
+} state_cache_entry_t;
+
+/*! The states after each layer of recent evaluations */
+typedef struct state_cache {
+    MKL_INT length;             /**< The number of amplitudes of each state */
+    int max_depth;              /**< The number of layers P */
+    int capacity;               /**< The number of states within the memory budget */
+    state_cache_entry_t *entries; /**< The cached states */
+    unsigned long long clock;   /**< Counts stores and resumes, ordering the entries by use */
+    long long layers_applied;   /**< The layers evolved while the cache was in use */
+    long long layers_resumed;   /**< The layers skipped by resuming from a cached state */
+    omp_lock_t lock;            /**< Guards the entries and counters, not the states being copied */
+} state_cache_t;
+
+state_cache_t *state_cache_create(size_t budget, MKL_INT length, int max_depth);
+
+int state_cache_resume(state_cache_t *cache, const double *gamma, const double *beta, MKL_Complex16 *state);
+
+void state_cache_store(state_cache_t *cache, const double *gamma, const double *beta, int depth,
+                       const MKL_Complex16 *state);
+
+void state_cache_report(const state_cache_t *cache, FILE *outfile);
+
+void state_cache_destroy(state_cache_t *cache);
+
+#endif //QOLAB_STATE_CACHE_H
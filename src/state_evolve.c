@@ -1,9 +1,73 @@
 #include <mkl.h>
 #include <mathimf.h>
+#include <float.h>
 #include "state_evolve.h"
 #include "matrix_expm.h"
 #include "measurement.h"
 #include "reporting.h"
+#include "profiling.h"
+#include "out_of_core.h"
+#include "placement.h"
+#include "trace.h"
+#include "lightcone.h"
+#include "ising.h"
+#include "cost_vector.h"
+#include "grover.h"
+#include "xy_mixer.h"
+#include "spectral_mixer.h"
+#include "state_cache.h"
+
+/**
+ * @brief Allocates a temporary of the size of a state, taken from the run's workspace when there is one
+ * @param meta_spec Data structure containing the size of the state-space and the workspace
+ * @return The temporary (its contents undefined), to be released with free_temporary()
+ */
+static void *allocate_temporary(qaoa_data_t *meta_spec) {
+    if (meta_spec->workspace != NULL) {
+        return numa_pool_take(meta_spec->workspace);
+    }
+    return numa_allocate((size_t) meta_spec->machine_spec->space_dimension, sizeof(MKL_Complex16));
+}
+
+/**
+ * @brief Releases a temporary allocated by allocate_temporary()
+ * @param temporary The temporary
+ * @param meta_spec Data structure containing the workspace
+ */
+static void free_temporary(void *temporary, qaoa_data_t *meta_spec) {
+    if (meta_spec->workspace != NULL) {
+        numa_pool_give(meta_spec->workspace, temporary);
+    } else {
+        numa_free(temporary);
+    }
+}
+
+/**
+ * @brief Allocates a vector over the state-space, memory-mapped when running out-of-core and otherwise taken from the
+ * run's workspace (or first touched with the kernels' static partition without one)
+ * @param meta_spec Data structure containing the size of the state-space, the out-of-core directory and the workspace
+ * @return The vector (its contents undefined), to be released with free_vector()
+ */
+MKL_Complex16 *allocate_vector(qaoa_data_t *meta_spec) {
+    size_t bytes = (size_t) meta_spec->machine_spec->space_dimension * sizeof(MKL_Complex16);
+    if (meta_spec->run_spec->ooc_directory != NULL) {
+        return ooc_allocate(bytes, meta_spec->run_spec->ooc_directory);
+    }
+    return allocate_temporary(meta_spec);
+}
+
+/**
+ * @brief Releases a vector allocated by allocate_vector()
+ * @param vector The vector
+ * @param meta_spec Data structure containing the size of the state-space, the out-of-core directory and the workspace
+ */
+void free_vector(MKL_Complex16 *vector, qaoa_data_t *meta_spec) {
+    if (meta_spec->run_spec->ooc_directory != NULL) {
+        ooc_free(vector, (size_t) meta_spec->machine_spec->space_dimension * sizeof(MKL_Complex16));
+    } else {
+        free_temporary(vector, meta_spec);
+    }
+}
 
 /**
  * @brief Initializes a state vector as an equal superposition of all bit-strings
@@ -13,8 +77,10 @@
 void initialise_state(MKL_Complex16 *state, machine_spec_t *mach_spec) {
     MKL_Complex16 init_value;
     init_value.real = 1.0 / sqrt(mach_spec->space_dimension);
+#pragma omp parallel for schedule(static)
     for(MKL_INT i = 0; i < mach_spec->space_dimension; ++i){
         state[i].real = init_value.real;
+        state[i].imag = 0.0;
     }
 }
 
@@ -25,23 +91,28 @@ void initialise_state(MKL_Complex16 *state, machine_spec_t *mach_spec) {
  * @param output The double array which will hold the result
  */
 void compute_probabilities(MKL_Complex16 *state, double *output, qaoa_data_t *meta_spec) {
-    MKL_Complex16 *z_probabilities = mkl_malloc(meta_spec->machine_spec->space_dimension * sizeof(MKL_Complex16),
-                                                DEF_ALIGNMENT);
-    check_alloc(z_probabilities);
+    MKL_Complex16 *z_probabilities = allocate_temporary(meta_spec);
     vzMulByConj(meta_spec->machine_spec->space_dimension, state, state, z_probabilities);
     vzAbs(meta_spec->machine_spec->space_dimension, z_probabilities, output);
-    mkl_free(z_probabilities);
+    free_temporary(z_probabilities, meta_spec);
 }
 
 /**
  * @brief Checks that a given state vector is normalised
+ * @details The equal superposition of all states has exact amplitudes, so its norm is held to 1e-15. The Grover and XY
+ * mixers start from superpositions of a subset of the states, whose amplitudes 1 / sqrt(k) are inexact unless k is a
+ * power of two; for them the rounding error of the norm's summation, growing with the number of amplitudes, is allowed.
  * @param state The input state
- * @param meta_spec Used to determine the size of the state vector
+ * @param meta_spec Used to determine the size of the state vector and the mixer
  */
 void check_probabilities(MKL_Complex16 *state, qaoa_data_t *meta_spec) {
     double result = 0.0;
+    double tolerance = 1e-15;
+    if (meta_spec->grover != NULL || meta_spec->run_spec->mixer == MIXER_XY) {
+        tolerance = fmax(tolerance, (double) meta_spec->machine_spec->space_dimension * DBL_EPSILON);
+    }
     cblas_zdotc_sub(meta_spec->machine_spec->space_dimension, state, 1, state, 1, &result);
-    if (fabs(result - 1.0) > 1e-15) {
+    if (fabs(result - 1.0) > tolerance) {
         fprintf(stderr, "State vector not normalized\n");
         exit(EXIT_FAILURE);
     }
@@ -50,76 +121,286 @@ void check_probabilities(MKL_Complex16 *state, qaoa_data_t *meta_spec) {
 
 /**
  * @brief Generalised method which performs a measurment on a given quantum state-vector
- * @details Currently supports computing the expectation value or estimating this value through sampling
+ * @details Currently supports computing the expectation value or estimating this value through sampling. Either may
+ * be replaced by the CVaR or Gibbs objective selected in the run specification. Out-of-core states are measured block
+ * by block (see streamed_objective()), and the exact expectation value directly from the state and the cost vector or
+ * Z strings (see cost_vector_expectation() and ising_expectation()) without forming the probabilities
  * @param state The state-vector in question
  * @param meta_spec Contains extra required information like whether we are sampling or not
  * @return An expectation value for the state (exact or estimated)
  */
 double measure(MKL_Complex16 *state, qaoa_data_t *meta_spec) {
     double result;
-    double *probabilities = mkl_malloc(meta_spec->machine_spec->space_dimension * sizeof(double), DEF_ALIGNMENT);
-    check_alloc(probabilities);
+    if (meta_spec->cost_data->hamiltonian != NULL) {
+        return ising_expectation(meta_spec->cost_data->hamiltonian, state, meta_spec->machine_spec->space_dimension);
+    }
+    if (meta_spec->run_spec->ooc_directory != NULL) {
+        PROFILE_BEGIN(streamed_mark);
+        result = streamed_objective(state, meta_spec);
+        PROFILE_END(meta_spec->run_spec->sampling ? PROFILE_SAMPLE : PROFILE_MEASURE, streamed_mark,
+                    meta_spec->machine_spec->space_dimension *
+                    (long long) (sizeof(MKL_Complex16) + cost_type_size(meta_spec->uc->type)), 0);
+        return result;
+    }
+    if (!meta_spec->run_spec->sampling && meta_spec->run_spec->objective == OBJECTIVE_EXPECTATION) {
+        PROFILE_BEGIN(expectation_mark);
+        result = cost_vector_expectation(meta_spec->uc, state);
+        PROFILE_END(PROFILE_MEASURE, expectation_mark, meta_spec->machine_spec->space_dimension *
+                    (long long) (sizeof(MKL_Complex16) + cost_type_size(meta_spec->uc->type)), 0);
+        return result;
+    }
+    double *probabilities = allocate_temporary(meta_spec);
 
+    PROFILE_BEGIN(profile_mark);
     compute_probabilities(state, probabilities, meta_spec);
 
     if (meta_spec->run_spec->sampling) {
         //Perform sampling
         result = sample(probabilities, meta_spec);
+        PROFILE_END(PROFILE_SAMPLE, profile_mark, meta_spec->machine_spec->space_dimension *
+                                                  (long long) (sizeof(MKL_Complex16) + 2 * sizeof(double) +
+                                                               cost_type_size(meta_spec->uc->type)), 0);
     } else {
-        //Perform expectation value
-        result = expectation_value(probabilities, meta_spec);
+        //Perform exact objective
+        result = objective_value(probabilities, meta_spec);
+        PROFILE_END(PROFILE_MEASURE, profile_mark, meta_spec->machine_spec->space_dimension *
+                                                   (long long) (sizeof(MKL_Complex16) + 2 * sizeof(double) +
+                                                                cost_type_size(meta_spec->uc->type)), 0);
     }
 
-    mkl_free(probabilities);
+    free_temporary(probabilities, meta_spec);
     return result;
 }
 
+/**
+ * @brief Applies the phase separator exp(-i gamma C) to a state
+ * @details Out-of-core states are streamed block by block. A cost function of Z strings is evaluated on the fly.
+ * @param state The state-vector, updated in place
+ * @param gamma The phase angle (negative to invert)
+ * @param meta_spec Data structure containing the cost function
+ */
+void apply_phase(MKL_Complex16 *state, double gamma, qaoa_data_t *meta_spec) {
+    if (meta_spec->cost_data->hamiltonian != NULL) {
+        ising_phase(meta_spec->cost_data->hamiltonian, gamma, state, meta_spec->machine_spec->space_dimension);
+    } else if (meta_spec->run_spec->ooc_directory != NULL) {
+        spmatrix_expm_z_diag_streamed(meta_spec->uc, gamma, state, meta_spec->run_spec->block_length);
+    } else {
+        spmatrix_expm_z_diag(meta_spec->uc, gamma, state);
+    }
+}
+
+/**
+ * @brief Applies the mixer exp(-i beta B) to a state
+ * @details Uses the engine selected by run_spec->mixer: the Chebyshev expansion over UB truncated at
+ * run_spec->cheby_tolerance (or UB's eigendecomposition on a small feasible space, see spectral_mixer.h), the exact
+ * blocked product of single-qubit rotations (the top qubit's rotation pairing complementary amplitudes in symmetric
+ * mode), the exact rank-one Grover reflection (see grover.h) or the Trotterised XY rotations (see xy_mixer.h)
+ * @param state The state-vector, updated in place
+ * @param beta The mixing angle (negative to invert)
+ * @param meta_spec Data structure containing the driver Hamiltonian
+ */
+void apply_mixer(MKL_Complex16 *state, double beta, qaoa_data_t *meta_spec) {
+    switch (meta_spec->run_spec->mixer) {
+        case MIXER_PRODUCT:
+            if (meta_spec->run_spec->symmetric) {
+                spmatrix_expm_product_x(state, beta, meta_spec->machine_spec->num_qubits - 1,
+                                        meta_spec->run_spec->block_length, meta_spec->run_spec->ooc_directory != NULL);
+                spmatrix_expm_flip_x(state, beta, meta_spec->machine_spec->space_dimension);
+            } else {
+                spmatrix_expm_product_x(state, beta, meta_spec->machine_spec->num_qubits,
+                                        meta_spec->run_spec->block_length, meta_spec->run_spec->ooc_directory != NULL);
+            }
+            break;
+        case MIXER_GROVER:
+            grover_expm(meta_spec->grover, beta, state);
+            break;
+        case MIXER_XY:
+            xy_mixer_expm(state, beta, meta_spec->machine_spec->num_qubits, meta_spec->run_spec->xy_topology,
+                          meta_spec->run_spec->xy_steps, meta_spec->run_spec->block_length);
+            break;
+        default:
+            if (meta_spec->spectral != NULL) {
+                spectral_expm(meta_spec->spectral, beta, state);
+                break;
+            }
+            spmatrix_expm_cheby(&meta_spec->ub, state, (MKL_Complex16) {beta, 0.0},
+                                (MKL_Complex16) {0.0, -meta_spec->ub_eigenvalue},
+                                (MKL_Complex16) {0.0, meta_spec->ub_eigenvalue},
+                                meta_spec->machine_spec->space_dimension, meta_spec->run_spec->cheby_tolerance,
+                                meta_spec->workspace);
+    }
+}
+
+/**
+ * @brief Applies the driver generator (the UB matrix, -iB) to a state
+ * @param state The state-vector
+ * @param output The result (distinct from state)
+ * @param meta_spec Data structure containing the driver Hamiltonian
+ */
+void apply_driver(MKL_Complex16 *state, MKL_Complex16 *output, qaoa_data_t *meta_spec) {
+    struct matrix_descr descr;
+    sparse_status_t status;
+    if (meta_spec->run_spec->mixer == MIXER_PRODUCT) {
+        spmatrix_product_x_mv(state, output, meta_spec->machine_spec->num_qubits, meta_spec->run_spec->symmetric);
+        return;
+    }
+    if (meta_spec->run_spec->mixer == MIXER_GROVER) {
+        grover_mv(meta_spec->grover, state, output);
+        return;
+    }
+    descr.type = SPARSE_MATRIX_TYPE_GENERAL;
+    PROFILE_BEGIN(spmv_mark);
+    status = mkl_sparse_z_mv(SPARSE_OPERATION_NON_TRANSPOSE, (MKL_Complex16) {1.0, 0.0}, meta_spec->ub, descr,
+                             state, (MKL_Complex16) {0.0, 0.0}, output);
+    PROFILE_END(PROFILE_SPMV, spmv_mark, spmv_bytes(meta_spec->ub), 0);
+    mkl_error_parse(status, stderr);
+}
+
+/**
+ * @brief Initialises the state every evolution starts from
+ * @details The equal superposition of all bit-strings or, for the Grover mixer, of the feasible ones (its eigenstate)
+ * and, for the XY mixer, of those of run_spec->xy_weight set bits
+ * @param state The vector which will be initialised
+ * @param meta_spec Data structure containing the state-space and mixer
+ */
+static void starting_state(MKL_Complex16 *state, qaoa_data_t *meta_spec) {
+    if (meta_spec->grover != NULL) {
+        grover_initialise(meta_spec->grover, state);
+    } else if (meta_spec->run_spec->mixer == MIXER_XY) {
+        xy_mixer_initialise(state, meta_spec->machine_spec->num_qubits, meta_spec->run_spec->xy_weight);
+    } else {
+        initialise_state(state, meta_spec->machine_spec);
+    }
+}
+
+/**
+ * @brief Records the result of an evaluation in the run statistics
+ * @details Counts the evaluation, stores it in the convergence trace (if kept), tracks the best value found and reports
+ * the iteration when verbose. Holds the batch lock while the evaluations of a batch share the statistics.
+ * @param result The value returned to the optimiser
+ * @param meta_spec Data structure containing the statistics of the optimiser which requested the evaluation
+ */
+void record_evaluation(double result, qaoa_data_t *meta_spec) {
+    qaoa_statistics_t *statistics = meta_spec->qaoa_statistics;
+    shared_lock(meta_spec->batch_lock);
+    statistics->num_evals++;
+    if (statistics->trace != NULL && statistics->num_evals <= statistics->trace_length) {
+        statistics->trace[statistics->num_evals - 1] = result;
+    }
+    if (result > statistics->best_expectation) {
+        statistics->best_expectation = result;
+    }
+    if (meta_spec->run_spec->verbose) {
+        iteration_report(result, meta_spec);
+    }
+    shared_unlock(meta_spec->batch_lock);
+}
+
+/**
+ * @brief Computes the gradient of the expectation value with respect to every gamma and beta by the adjoint method
+ * @details Propagates the final state and its image under the cost Hamiltonian backwards through each layer, taking
+ * the overlap with each layer's generator on the way. Costs roughly three forward evolutions regardless of P.
+ * @param state The final state of the forward evolution, overwritten by this function
+ * @param x The parameters the state was evolved with
+ * @param grad The buffer to hold the 2*P gradient entries
+ * @param meta_spec Data structure containing all simulation information
+ * @warning Only valid for the exact expectation objective with a Hermitian driver (the unrestricted QAOA)
+ */
+void adjoint_gradient(MKL_Complex16 *state, const double *x, double *grad, qaoa_data_t *meta_spec) {
+    int P = meta_spec->machine_spec->P;
+    MKL_INT space_dimension = meta_spec->machine_spec->space_dimension;
+    MKL_Complex16 overlap;
+    PROFILE_BEGIN(profile_mark);
+
+    MKL_Complex16 *costate = allocate_vector(meta_spec);
+    MKL_Complex16 *work = allocate_vector(meta_spec);
+
+    if (meta_spec->cost_data->hamiltonian != NULL) {
+        ising_apply(meta_spec->cost_data->hamiltonian, state, costate, space_dimension, false);
+    } else {
+        cost_vector_apply(meta_spec->uc, state, costate, false);
+    }
+
+    for (int i = P - 1; i >= 0; --i) {
+        apply_driver(state, work, meta_spec);
+        cblas_zdotc_sub(space_dimension, costate, 1, work, 1, &overlap);
+        grad[i + P] = 2.0 * overlap.real;
+        apply_mixer(state, -x[i + P], meta_spec);
+        apply_mixer(costate, -x[i + P], meta_spec);
+
+        if (meta_spec->cost_data->hamiltonian != NULL) {
+            ising_apply(meta_spec->cost_data->hamiltonian, state, work, space_dimension, true);
+        } else {
+            cost_vector_apply(meta_spec->uc, state, work, true);
+        }
+        cblas_zdotc_sub(space_dimension, costate, 1, work, 1, &overlap);
+        grad[i] = 2.0 * overlap.real;
+        apply_phase(state, -x[i], meta_spec);
+        apply_phase(costate, -x[i], meta_spec);
+    }
+
+    free_vector(work, meta_spec);
+    free_vector(costate, meta_spec);
+    //The co-state product and, per layer, two overlaps and the diagonal product (SpMVs are counted separately)
+    PROFILE_END(PROFILE_GRADIENT, profile_mark, (3LL + 7LL * P) * space_dimension * sizeof(MKL_Complex16), 0);
+}
+
 /**
  * @brief Performs a standard QAOA iteration (UBUC...)
- * @details Conforms to nlopt standards
+ * @details Conforms to nlopt standards, including computing the gradient when one is requested. With a state cache the
+ * evolution resumes after the deepest cached layer whose angles match and stores the state after each layer it applies.
  * @param num_params The number of optimimzation parameters present (2*P)
  * @param x The current candidate parameters
- * @param grad The gradient of the optimisation landscape (assumed to be NULL)
+ * @param grad The gradient of the optimisation landscape (NULL if not required)
  * @param meta_spec Data structure containing all simulation information
  * @return Either the expectation value or sampled output value
- * @warning Assumes order of gamma(UC) then beta(UB) parameters.
+ * @warning Assumes order of gamma(UC) then beta(UB) parameters. Gradients are only available for the exact
+ * expectation value.
  */
 double evolve(unsigned num_params, const double *x, double *grad, qaoa_data_t *meta_spec){
     double result;
     int P = meta_spec->machine_spec->P;
-    //Generate new initial state
-    MKL_Complex16 *state = mkl_calloc((size_t)meta_spec->machine_spec->space_dimension, sizeof(MKL_Complex16), DEF_ALIGNMENT);
-    check_alloc(state);
-    initialise_state(state, meta_spec->machine_spec);
+    int resumed = 0;
+    PROFILE_BEGIN(profile_mark);
+    //Resume from the deepest cached layer or generate new initial state
+    MKL_Complex16 *state = allocate_vector(meta_spec);
+    if (meta_spec->state_cache != NULL) {
+        resumed = state_cache_resume(meta_spec->state_cache, x, x + P, state);
+    }
+    if (resumed == 0) {
+        starting_state(state, meta_spec);
+    }
     //Apply our QAOA iteration
-    for(int i = 0; i < num_params / 2; ++i){
-        spmatrix_expm_z_diag(meta_spec->uc, x[i], meta_spec->machine_spec->space_dimension, state);
-        spmatrix_expm_cheby(&meta_spec->ub, state, (MKL_Complex16) {x[i + P], 0.0},
-                            (MKL_Complex16) {0.0, -meta_spec->ub_eigenvalue},
-                            (MKL_Complex16) {0.0, meta_spec->ub_eigenvalue}, meta_spec->machine_spec->space_dimension);
+    for(int i = resumed; i < num_params / 2; ++i){
+        apply_phase(state, x[i], meta_spec);
+        apply_mixer(state, x[i + P], meta_spec);
+        if (meta_spec->state_cache != NULL) {
+            state_cache_store(meta_spec->state_cache, x, x + P, i + 1, state);
+        }
     }
-    meta_spec->qaoa_statistics->num_evals++;
     //measure
     result = measure(state, meta_spec);
-    //teardown
-    mkl_free(state);
-    //Return single value;
-    if (result > meta_spec->qaoa_statistics->best_sample) {
-        meta_spec->qaoa_statistics->best_sample = result;
-    }
-    if (meta_spec->run_spec->verbose) {
-        printf("%d \n", meta_spec->qaoa_statistics->num_evals);
+    if (grad != NULL) {
+        if (!gradient_available(meta_spec)) {
+            fprintf(stderr, "Gradients are only available for the exact unrestricted expectation value\n");
+            exit(EXIT_FAILURE);
+        }
+        adjoint_gradient(state, x, grad, meta_spec);
     }
+    //teardown
+    free_vector(state, meta_spec);
+    PROFILE_END(PROFILE_EVALUATION, profile_mark, 0, 0);
+    record_evaluation(result, meta_spec);
     return result;
 }
 
 /**
  * @brief Peroform a restricted QAOA iteration (UBUCUB...)
  * @details Simlar to a standard QAOA iteration but reverses the application of operators and applies one extra
- * UB operation. Conforms to nlopt standards
+ * UB operation. Conforms to nlopt standards. Layers are cached as in evolve(), the final UB is always applied.
  * @param num_params The number of optimization parameters present (2*P + 1)
  * @param x The current candidate parameters
- * @param grad The gradient of the optimisation landscape (assumed to be NULL)
+ * @param grad The gradient of the optimisation landscape (must be NULL, the restricted driver is not Hermitian)
  * @param meta_spec Data structure containing all simulation information
  * @return Either the expectation value or sampled output value
  * @warning Assumes order of gamma(UC) then beta(UB) parameters.
@@ -127,38 +408,141 @@ double evolve(unsigned num_params, const double *x, double *grad, qaoa_data_t *m
 double evolve_restricted(unsigned num_params, const double *x, double *grad, qaoa_data_t *meta_spec) {
     double result;
     int P = meta_spec->machine_spec->P;
-    //Generate new initial state
-    MKL_Complex16 *state = mkl_calloc((size_t) meta_spec->machine_spec->space_dimension, sizeof(MKL_Complex16),
-                                      DEF_ALIGNMENT);
-    check_alloc(state);
-    initialise_state(state, meta_spec->machine_spec);
-    check_probabilities(state, meta_spec);
-    //Apply our restricted QAOA generation
-    for (int i = 0; i < (num_params - 1) / 2; ++i) {
-        spmatrix_expm_cheby(&meta_spec->ub, state, (MKL_Complex16) {x[i + P], 0.0},
-                            (MKL_Complex16) {0.0, -meta_spec->ub_eigenvalue},
-                            (MKL_Complex16) {0.0, meta_spec->ub_eigenvalue},
-                            meta_spec->machine_spec->space_dimension);
-        spmatrix_expm_z_diag(meta_spec->uc, x[i], meta_spec->machine_spec->space_dimension, state);
-    }
-    spmatrix_expm_cheby(&meta_spec->ub, state, (MKL_Complex16) {x[num_params], 0.0},
-                        (MKL_Complex16) {0.0, -meta_spec->ub_eigenvalue},
-                        (MKL_Complex16) {0.0, meta_spec->ub_eigenvalue},
-                        meta_spec->machine_spec->space_dimension);
-    meta_spec->qaoa_statistics->num_evals++;
+    int resumed = 0;
+    if (grad != NULL) {
+        fprintf(stderr, "Gradients are not available for the restricted QAOA\n");
+        exit(EXIT_FAILURE);
+    }
+    PROFILE_BEGIN(profile_mark);
+    //Resume from the deepest cached layer or generate new initial state
+    MKL_Complex16 *state = allocate_vector(meta_spec);
+    if (meta_spec->state_cache != NULL) {
+        resumed = state_cache_resume(meta_spec->state_cache, x, x + P, state);
+    }
+    if (resumed == 0) {
+        starting_state(state, meta_spec);
+        check_probabilities(state, meta_spec);
+    }
+    //Apply our restricted QAOA generation, the final mixer is not cached
+    for (int i = resumed; i < (num_params - 1) / 2; ++i) {
+        apply_mixer(state, x[i + P], meta_spec);
+        apply_phase(state, x[i], meta_spec);
+        if (meta_spec->state_cache != NULL) {
+            state_cache_store(meta_spec->state_cache, x, x + P, i + 1, state);
+        }
+    }
+    apply_mixer(state, x[num_params - 1], meta_spec);
     //measure
     result = measure(state, meta_spec);
-    if (meta_spec->run_spec->verbose) {
-        iteration_report(result, meta_spec);
-    }
     //teardown
-    mkl_free(state);
-    //Return single value;
-    if (result > meta_spec->qaoa_statistics->best_expectation) {
-        meta_spec->qaoa_statistics->best_expectation = result;
+    free_vector(state, meta_spec);
+    PROFILE_END(PROFILE_EVALUATION, profile_mark, 0, 0);
+    record_evaluation(result, meta_spec);
+    return result;
+}
+
+/**
+ * @brief Performs a standard QAOA iteration on the light cones of a MaxCut instance (see lightcone.h)
+ * @details Conforms to nlopt standards
+ * @param num_params The number of optimization parameters present (2*P)
+ * @param x The current candidate parameters
+ * @param grad The gradient of the optimisation landscape (must be NULL)
+ * @param meta_spec Data structure containing the light-cone evaluator
+ * @return The expectation value
+ * @warning Assumes order of gamma(UC) then beta(UB) parameters.
+ */
+double evolve_lightcone(unsigned num_params, const double *x, double *grad, qaoa_data_t *meta_spec) {
+    double result;
+    if (grad != NULL) {
+        fprintf(stderr, "Gradients are not available for light-cone evaluation\n");
+        exit(EXIT_FAILURE);
     }
-    if (meta_spec->run_spec->verbose) {
-        printf("%d \n", meta_spec->qaoa_statistics->num_evals);
+    PROFILE_BEGIN(profile_mark);
+    result = lightcone_expectation(meta_spec->lightcone, x, meta_spec->run_spec->block_length);
+    PROFILE_END(PROFILE_EVALUATION, profile_mark, 0, 0);
+    record_evaluation(result, meta_spec);
+    return result;
+}
+
+/**
+ * @brief Determines whether evolve() can provide analytic gradients for this run
+ * @param meta_spec Data structure containing all simulation information
+ * @return True if the objective is the exact expectation value of the unrestricted, full-state QAOA with a mixer of
+ * the form exp(-i beta B) (not the Trotterised XY mixer)
+ */
+bool gradient_available(qaoa_data_t *meta_spec) {
+    return !meta_spec->run_spec->restricted && !meta_spec->run_spec->sampling && !meta_spec->run_spec->lightcone &&
+           meta_spec->run_spec->objective == OBJECTIVE_EXPECTATION && meta_spec->run_spec->mixer != MIXER_XY;
+}
+
+/**
+ * @brief Evaluates a schedule of angles on the standard or restricted QAOA, or on the light cones of the instance
+ * @param num_params The number of angles present
+ * @param x The angles
+ * @param grad The gradient with respect to the angles (NULL if not required)
+ * @param meta_spec Data structure containing all simulation information
+ * @return Either the expectation value or sampled output value
+ */
+double evolve_schedule(unsigned num_params, const double *x, double *grad, qaoa_data_t *meta_spec) {
+    if (meta_spec->run_spec->lightcone) {
+        return evolve_lightcone(num_params, x, grad, meta_spec);
+    }
+    if (meta_spec->run_spec->restricted) {
+        return evolve_restricted(num_params, x, grad, meta_spec);
+    }
+    return evolve(num_params, x, grad, meta_spec);
+}
+
+/**
+ * @brief Evaluates the optimiser's parameters on the standard or restricted QAOA
+ * @details Under the FOURIER strategy x holds the amplitudes, which are expanded into angles before evolution and any
+ * gradient is mapped back onto them.
+ * @param num_params The number of optimization parameters present
+ * @param x The current candidate parameters
+ * @param grad The gradient of the optimisation landscape (NULL if not required)
+ * @param meta_spec Data structure containing all simulation information
+ * @return Either the expectation value or sampled output value
+ */
+double parameter_objective(unsigned num_params, const double *x, double *grad, qaoa_data_t *meta_spec) {
+    if (meta_spec->opt_spec->strategy != STRATEGY_FOURIER) {
+        return evolve_schedule(num_params, x, grad, meta_spec);
+    }
+    int P = meta_spec->machine_spec->P;
+    int q = (int) num_params / 2;
+    int length = schedule_length(meta_spec);
+    double *angles = mkl_malloc(length * sizeof(double), DEF_ALIGNMENT);
+    double *angle_grad = NULL;
+    check_alloc(angles);
+    if (grad != NULL) {
+        angle_grad = mkl_malloc(length * sizeof(double), DEF_ALIGNMENT);
+        check_alloc(angle_grad);
+    }
+    fourier_expand(P, q, meta_spec->run_spec->restricted, x, angles);
+    double result = evolve_schedule((unsigned) length, angles, angle_grad, meta_spec);
+    if (grad != NULL) {
+        fourier_gradient(P, q, meta_spec->run_spec->restricted, angle_grad, grad);
+        mkl_free(angle_grad);
+    }
+    mkl_free(angles);
+    return result;
+}
+
+/**
+ * @brief The objective handed to every optimiser, dispatching to the standard or restricted QAOA
+ * @details Conforms to nlopt standards. When tracing, the evaluation is pushed to the trace writer (see trace.h).
+ * @param num_params The number of optimization parameters present
+ * @param x The current candidate parameters
+ * @param grad The gradient of the optimisation landscape (NULL if not required)
+ * @param meta_spec Data structure containing all simulation information
+ * @return Either the expectation value or sampled output value
+ */
+double qaoa_objective(unsigned num_params, const double *x, double *grad, qaoa_data_t *meta_spec) {
+    if (meta_spec->trace == NULL) {
+        return parameter_objective(num_params, x, grad, meta_spec);
     }
+    double start = dsecnd();
+    double result = parameter_objective(num_params, x, grad, meta_spec);
+    trace_record(meta_spec->trace, meta_spec->qaoa_statistics->start, x, result,
+                 meta_spec->qaoa_statistics->best_sample, dsecnd() - start);
     return result;
 }
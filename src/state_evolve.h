@@ -7,8 +7,28 @@
 #define QOLAB_STATE_EVOLVE_H
 #include "globals.h"
 
+MKL_Complex16 *allocate_vector(qaoa_data_t *meta_spec);
+
+void free_vector(MKL_Complex16 *vector, qaoa_data_t *meta_spec);
+
+void initialise_state(MKL_Complex16 *state, machine_spec_t *mach_spec);
+
+void compute_probabilities(MKL_Complex16 *state, double *output, qaoa_data_t *meta_spec);
+
+double measure(MKL_Complex16 *state, qaoa_data_t *meta_spec);
+
+void apply_phase(MKL_Complex16 *state, double gamma, qaoa_data_t *meta_spec);
+
+void apply_mixer(MKL_Complex16 *state, double beta, qaoa_data_t *meta_spec);
+
+void apply_driver(MKL_Complex16 *state, MKL_Complex16 *output, qaoa_data_t *meta_spec);
+
 double evolve(unsigned num_params, const double *x, double *grad, qaoa_data_t *meta_spec);
 
 double evolve_restricted(unsigned num_params, const double *x, double *grad, qaoa_data_t *meta_spec);
 
+double qaoa_objective(unsigned num_params, const double *x, double *grad, qaoa_data_t *meta_spec);
+
+bool gradient_available(qaoa_data_t *meta_spec);
+
 #endif //QOLAB_STATE_EVOLVE_H
@@ -0,0 +1,199 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Asynchronous per-evaluation trace of the optimisation
+ * @details The ring is a bounded multi-producer single-consumer queue (D. Vyukov's sequenced slots): a producer claims
+ * a slot by advancing head with a compare-and-swap, fills it and publishes it by storing the slot's sequence; the
+ * writer thread consumes slots in order and hands each back to producers one lap later. Parameters live in a flat
+ * array alongside the slots.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "trace.h"
+
+#define TRACE_IDLE_NS 1000000
+
+/*! One evaluation waiting to be written */
+typedef struct {
+    size_t sequence;        /**< The lap counter of the slot: equal to its position when free, position + 1 when full */
+    int64_t evaluation;     /**< The completion order of the evaluation */
+    int32_t start;          /**< The start which requested it */
+    int32_t reserved;
+    double time;            /**< Seconds since the trace was opened */
+    double duration;        /**< Seconds spent in the evaluation */
+    double value;           /**< The value returned to the optimiser */
+    double best_sample;     /**< The best sampled value of the start so far */
+} trace_slot_t;
+
+/*! The ring, its writer thread and the file it drains to */
+struct trace_writer {
+    trace_slot_t *slots;    /**< TRACE_CAPACITY slots */
+    double *parameters;     /**< TRACE_CAPACITY * num_params parameters, one row per slot */
+    int num_params;         /**< The number of parameters of every record */
+    size_t head;            /**< The next position to be claimed by a producer */
+    size_t tail;            /**< The next position to be consumed (writer thread only) */
+    int closing;            /**< Set once no more records will be pushed */
+    double origin;          /**< dsecnd() when the trace was opened */
+    trace_format_t format;  /**< The file format */
+    FILE *file;             /**< The trace file */
+    pthread_t thread;       /**< The writer thread */
+};
+
+/**
+ * @brief Writes every record currently published in the ring
+ * @param writer The trace writer
+ * @return The number of records written
+ */
+static int trace_drain(trace_writer_t *writer) {
+    int count = 0;
+    for (;;) {
+        trace_slot_t *slot = &writer->slots[writer->tail & (TRACE_CAPACITY - 1)];
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != writer->tail + 1) {
+            return count;
+        }
+        double *x = writer->parameters + (writer->tail & (TRACE_CAPACITY - 1)) * writer->num_params;
+        if (writer->format == TRACE_CSV) {
+            fprintf(writer->file, "%lld,%d,%.6f,%.6e,%.17g,%.17g", (long long) slot->evaluation, (int) slot->start,
+                    slot->time, slot->duration, slot->value, slot->best_sample);
+            for (int j = 0; j < writer->num_params; ++j) {
+                fprintf(writer->file, ",%.17g", x[j]);
+            }
+            fputc('\n', writer->file);
+        } else {
+            fwrite(&slot->evaluation, sizeof(trace_slot_t) - offsetof(trace_slot_t, evaluation), 1, writer->file);
+            fwrite(x, sizeof(double), (size_t) writer->num_params, writer->file);
+        }
+        __atomic_store_n(&slot->sequence, writer->tail + TRACE_CAPACITY, __ATOMIC_RELEASE);
+        writer->tail++;
+        count++;
+    }
+}
+
+/**
+ * @brief The body of the writer thread, draining the ring until it is closed and empty
+ * @param argument The trace writer
+ * @return NULL
+ */
+static void *trace_thread(void *argument) {
+    trace_writer_t *writer = argument;
+    struct timespec idle = {0, TRACE_IDLE_NS};
+    for (;;) {
+        int closing = __atomic_load_n(&writer->closing, __ATOMIC_ACQUIRE);
+        if (trace_drain(writer) == 0) {
+            if (closing) {
+                return NULL;
+            }
+            fflush(writer->file);
+            nanosleep(&idle, NULL);
+        }
+    }
+}
+
+/**
+ * @brief Opens (appending) the trace file of the run, writes the run's header and starts the writer thread
+ * @param meta_spec Data structure containing the trace path and format and the machine specification
+ * @param num_params The number of parameters handed to the objective in this run
+ * @return The trace writer, exits on failure
+ */
+trace_writer_t *trace_open(qaoa_data_t *meta_spec, int num_params) {
+    trace_writer_t *writer = malloc(sizeof(trace_writer_t));
+    check_alloc(writer);
+    writer->slots = malloc(TRACE_CAPACITY * sizeof(trace_slot_t));
+    writer->parameters = malloc((size_t) TRACE_CAPACITY * num_params * sizeof(double));
+    check_alloc(writer->slots);
+    check_alloc(writer->parameters);
+    for (size_t i = 0; i < TRACE_CAPACITY; ++i) {
+        writer->slots[i].sequence = i;
+    }
+    writer->num_params = num_params;
+    writer->head = 0;
+    writer->tail = 0;
+    writer->closing = 0;
+    writer->format = meta_spec->run_spec->trace_format;
+    writer->file = fopen(meta_spec->run_spec->trace_path, writer->format == TRACE_CSV ? "a" : "ab");
+    if (writer->file == NULL) {
+        perror("Attempting to open trace file");
+        exit(EXIT_FAILURE);
+    }
+    if (writer->format == TRACE_CSV) {
+        fprintf(writer->file, "sequence,start,time,duration,value,best_sample");
+        for (int j = 0; j < num_params; ++j) {
+            fprintf(writer->file, ",x%d", j);
+        }
+        fputc('\n', writer->file);
+    } else {
+        int32_t header[4] = {meta_spec->machine_spec->num_qubits, meta_spec->machine_spec->P, num_params, 0};
+        fwrite("QOTRACE1", 1, 8, writer->file);
+        fwrite(header, sizeof(int32_t), 4, writer->file);
+    }
+    writer->origin = dsecnd();
+    if (pthread_create(&writer->thread, NULL, trace_thread, writer) != 0) {
+        fprintf(stderr, "Could not start the trace writer\n");
+        exit(EXIT_FAILURE);
+    }
+    return writer;
+}
+
+/**
+ * @brief Pushes an evaluation into the ring
+ * @details Lock-free and safe to call from concurrent evaluations. Only if the writer has fallen a whole ring behind
+ * does the caller yield until a slot is freed; records are never dropped.
+ * @param writer The trace writer
+ * @param start The start which requested the evaluation
+ * @param x The num_params parameters evaluated
+ * @param value The value returned to the optimiser
+ * @param best_sample The best sampled value of the start so far
+ * @param duration Seconds spent in the evaluation
+ */
+void trace_record(trace_writer_t *writer, int start, const double *x, double value, double best_sample,
+                  double duration) {
+    size_t position = __atomic_load_n(&writer->head, __ATOMIC_RELAXED);
+    trace_slot_t *slot;
+    for (;;) {
+        slot = &writer->slots[position & (TRACE_CAPACITY - 1)];
+        size_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if (sequence == position) {
+            if (__atomic_compare_exchange_n(&writer->head, &position, position + 1, true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else {
+            if (sequence < position) {
+                //Full: the slot still holds the record from the previous lap
+                sched_yield();
+            }
+            position = __atomic_load_n(&writer->head, __ATOMIC_RELAXED);
+        }
+    }
+    slot->evaluation = (int64_t) position;
+    slot->start = start;
+    slot->reserved = 0;
+    slot->time = dsecnd() - writer->origin;
+    slot->duration = duration;
+    slot->value = value;
+    slot->best_sample = best_sample;
+    memcpy(writer->parameters + (position & (TRACE_CAPACITY - 1)) * writer->num_params, x,
+           writer->num_params * sizeof(double));
+    __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Waits for the writer to drain every record, then closes the file and releases the writer
+ * @param writer The trace writer (no records may be pushed concurrently)
+ */
+void trace_close(trace_writer_t *writer) {
+    __atomic_store_n(&writer->closing, 1, __ATOMIC_RELEASE);
+    pthread_join(writer->thread, NULL);
+    fclose(writer->file);
+    free(writer->parameters);
+    free(writer->slots);
+    free(writer);
+}
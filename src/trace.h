@@ -0,0 +1,35 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief Asynchronous per-evaluation trace of the optimisation
+ * @details Evaluations push fixed-size records into a bounded lock-free ring which a background thread drains to the
+ * trace file, so the hot loop never waits on I/O (it only yields if the writer falls a full ring behind). Each run of
+ * qaoa() appends a header followed by its records.
+ *
+ * The binary format (native byte order, little-endian on every supported platform) is, per run:
+ *  - header: char magic[8] = "QOTRACE1", int32 num_qubits, int32 P, int32 num_params, int32 reserved
+ *  - records: int64 sequence, int32 start, int32 reserved, double time, double duration, double value,
+ *    double best_sample, double parameters[num_params]
+ *
+ * The CSV format writes a header line (sequence,start,time,duration,value,best_sample,x0,...) per run. The sequence is
+ * the order in which evaluations completed across all starts; time is seconds since the run began and duration the
+ * seconds spent in the evaluation.
+ */
+
+#ifndef QOLAB_TRACE_H
+#define QOLAB_TRACE_H
+
+#include "globals.h"
+
+#define TRACE_CAPACITY 4096
+
+typedef struct trace_writer trace_writer_t;
+
+trace_writer_t *trace_open(qaoa_data_t *meta_spec, int num_params);
+
+void trace_record(trace_writer_t *writer, int start, const double *x, double value, double best_sample,
+                  double duration);
+
+void trace_close(trace_writer_t *writer);
+
+#endif //QOLAB_TRACE_H
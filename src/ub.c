@@ -3,39 +3,74 @@
  * @date 1/07/2018
  */
 #include "ub.h"
+#include "placement.h"
+
+/**
+ * @brief The state a driver term connects to a given state
+ * @details Term j flips bit j. In symmetric mode the state-space is the lower half of num_qubits qubits and the term
+ * of the top qubit, whose partner lies in the upper half, is represented by that partner's complement: every lower
+ * bit flipped.
+ * @param i The state
+ * @param j The driver term (0 to num_qubits - 1)
+ * @param num_qubits The number of qubits
+ * @param space_dimension The number of states simulated
+ * @param symmetric Whether only the symmetric half-space is simulated
+ * @return The connected state
+ */
+static MKL_INT driver_neighbour(MKL_INT i, int j, int num_qubits, MKL_INT space_dimension, bool symmetric) {
+    if (symmetric && j == num_qubits - 1) {
+        return i ^ (space_dimension - 1);
+    }
+    return i ^ ((MKL_INT) 1 << j);
+}
 
 /**
  * @brief Generates the driver hamiltonian for a given problem with double values.
  * @details Defines the continuous time quantum walk that allows for 'probability' to flow around candidate solution bitstrings
  * In the standard QAOA this defines a fully connected hyper-cube, in a restricted QAOA this is a problem dependent
- * subset of this graph. The double values allow us to quickly solve for the eigenvalues of this matrix
+ * subset of this graph. The double values allow us to quickly solve for the eigenvalues of this matrix.
+ * Rows are counted and then filled in parallel with the kernels' static partition, so each thread first touches the
+ * rows it later multiplies; only the prefix sum between the two passes is serial. In symmetric mode the top qubit's
+ * term connects complementary states of the half-space (see driver_neighbour()).
  * @param meta_data Describes the full simulation. num_qubits, cost_data are used
  * @param mask (optional) Returns true given a valid input, false otherwise.
+ * @return The number of non-zero elements, num_qubits * pow(2, num_qubits) at most, which must fit in an MKL_INT
  * @warning Will need to be converted to a complex matrix before use with the QAOA module
  */
-MKL_INT generate_ub(qaoa_data_t *meta_data, bool (*mask)(unsigned int, cost_data_t *cost_data)) {
+MKL_INT generate_ub(qaoa_data_t *meta_data, bool (*mask)(MKL_INT, cost_data_t *cost_data)) {
     sparse_status_t status;
     MKL_INT nnz = 0;
     MKL_INT space_dimension = meta_data->machine_spec->space_dimension;
-    double *values = mkl_calloc((size_t) space_dimension * (meta_data->machine_spec->num_qubits + 1),
-                                sizeof(double), DEF_ALIGNMENT);
-    MKL_INT *row_begin = mkl_calloc((size_t) space_dimension + 1, sizeof(MKL_INT), DEF_ALIGNMENT);
-    MKL_INT *row_end = mkl_calloc((size_t) space_dimension + 1, sizeof(MKL_INT), DEF_ALIGNMENT);
-    MKL_INT *col_index = mkl_calloc((size_t) space_dimension * (meta_data->machine_spec->num_qubits) + 1,
-                                    sizeof(MKL_INT), DEF_ALIGNMENT);
-    check_alloc(values);
-    check_alloc(row_begin);
-    check_alloc(row_end);
-    check_alloc(col_index);
-    for (unsigned int i = 0; i < space_dimension; ++i) {
+    int num_qubits = meta_data->machine_spec->num_qubits;
+    bool symmetric = meta_data->run_spec->symmetric;
+    double *values = numa_allocate((size_t) space_dimension * (num_qubits + 1), sizeof(double));
+    MKL_INT *row_begin = numa_allocate((size_t) space_dimension + 1, sizeof(MKL_INT));
+    MKL_INT *row_end = numa_allocate((size_t) space_dimension + 1, sizeof(MKL_INT));
+    MKL_INT *col_index = numa_allocate((size_t) space_dimension * num_qubits + 1, sizeof(MKL_INT));
+#pragma omp parallel for schedule(static)
+    for (MKL_INT i = 0; i < space_dimension; ++i) {
+        MKL_INT count = 0;
+        for (int j = 0; j < num_qubits; ++j) {
+            count += mask(driver_neighbour(i, j, num_qubits, space_dimension, symmetric), meta_data->cost_data);
+        }
+        row_begin[i] = 0;
+        row_end[i] = count;
+    }
+    for (MKL_INT i = 0; i < space_dimension; ++i) {
         row_begin[i] = nnz;
-        for (unsigned int j = 0; j < meta_data->machine_spec->num_qubits; ++j) {
-            unsigned int col = ((i ^ ((unsigned int) 1 << j)));
+        nnz += row_end[i];
+        row_end[i] = nnz;
+    }
+    row_begin[space_dimension] = row_end[space_dimension] = nnz;
+#pragma omp parallel for schedule(static)
+    for (MKL_INT i = 0; i < space_dimension; ++i) {
+        MKL_INT k = row_begin[i];
+        for (int j = 0; j < num_qubits; ++j) {
+            MKL_INT col = driver_neighbour(i, j, num_qubits, space_dimension, symmetric);
             if (mask(col, meta_data->cost_data)) {
-                values[nnz] = 1.0;
-                row_end[i] = nnz;
-                col_index[nnz] = (MKL_INT) col;
-                nnz++;
+                values[k] = 1.0;
+                col_index[k] = col;
+                k++;
             }
         }
     }
@@ -60,15 +95,17 @@ void convert_ub(qaoa_data_t *meta_data, MKL_INT ub_nnz) {
     MKL_INT *rows_end;
     MKL_INT *col_indx;
     double *values;
-    MKL_Complex16 *new_values = mkl_calloc((size_t) ub_nnz, sizeof(MKL_Complex16), DEF_ALIGNMENT);
-    check_alloc(new_values);
+    sparse_matrix_t real_ub = meta_data->ub;
+    MKL_Complex16 *new_values = numa_allocate((size_t) ub_nnz, sizeof(MKL_Complex16));
 
-    status = mkl_sparse_d_export_csr(meta_data->ub, &index_base, &rows, &cols, &rows_start, &rows_end, &col_indx,
+    status = mkl_sparse_d_export_csr(real_ub, &index_base, &rows, &cols, &rows_start, &rows_end, &col_indx,
                                      &values);
     mkl_error_parse(status, stderr);
 
+#pragma omp parallel for schedule(static)
     for (MKL_INT i = 0; i < ub_nnz; ++i) {
         //Shortcut to avoid * -I later
+        new_values[i].real = 0.0;
         new_values[i].imag = -1.0;
     }
 
@@ -76,5 +113,29 @@ void convert_ub(qaoa_data_t *meta_data, MKL_INT ub_nnz) {
                                      new_values);
     mkl_error_parse(status, stderr);
 
-    mkl_free(values);
-}
\ No newline at end of file
+    //The CSR index arrays now belong to the complex matrix, destroying the handle does not free them
+    mkl_sparse_destroy(real_ub);
+    numa_free(values);
+}
+
+/**
+ * @brief Destroys a complex valued UB matrix along with the CSR arrays it was created from (which MKL does not own)
+ * @param ub The UB matrix, after convert_ub()
+ */
+void destroy_ub(sparse_matrix_t ub) {
+    sparse_index_base_t index_base;
+    MKL_INT rows;
+    MKL_INT cols;
+    MKL_INT *rows_start;
+    MKL_INT *rows_end;
+    MKL_INT *col_indx;
+    MKL_Complex16 *values;
+
+    mkl_error_parse(mkl_sparse_z_export_csr(ub, &index_base, &rows, &cols, &rows_start, &rows_end, &col_indx,
+                                            &values), stderr);
+    mkl_sparse_destroy(ub);
+    numa_free(rows_start);
+    numa_free(rows_end);
+    numa_free(col_indx);
+    numa_free(values);
+}
@@ -13,8 +13,10 @@
 #include <stdbool.h>
 #include "globals.h"
 
-MKL_INT generate_ub(qaoa_data_t *meta_data, bool (*mask)(unsigned int, cost_data_t *cost_data));
+MKL_INT generate_ub(qaoa_data_t *meta_data, bool (*mask)(MKL_INT, cost_data_t *cost_data));
 
 void convert_ub(qaoa_data_t *meta_data, MKL_INT ub_nnz);
 
+void destroy_ub(sparse_matrix_t ub);
+
 #endif //GRAPHSIMILARITY_UB_H
@@ -1,4 +1,6 @@
+#include <stdint.h>
 #include "uc.h"
+#include "cost_vector.h"
 
 /**
  * @brief Generates the solution hamiltonian which encodes the problem dependent solutions to every possible bit-string.
@@ -6,27 +8,79 @@
  * @param Cx The function which implements the problem-dependent cost-function
  * @param mask (Optional) A bit-string mask (the same as UB-generation) to avoid computing the cost-function for
  * invalid candidate solutions in the restricted QAOA.
+ * @details Allocates meta_data->uc (memory-mapped when running out-of-core), to be released with cost_vector_free().
+ * The costs are written as 32-bit integers and then narrowed to the smallest type holding their range (see
+ * cost_vector.h). The loop uses the kernels' static partition so each thread first touches its own share of uc. The
+ * maximum is reduced from per-thread maxima, keeping the first index attaining it. In symmetric mode only the lower
+ * half-space is generated and the means are weighted for the complements it stands for.
  * @warning Will probably hit double precision for the c_sum statistic very quickly
  */
-void generate_uc(qaoa_data_t *meta_data, int (*Cx)(int, int, cost_data_t *),
-                 bool (*mask)(unsigned int, cost_data_t *cost_data)) {
-    int current, i, num_qubits;
+void generate_uc(qaoa_data_t *meta_data, int (*Cx)(MKL_INT, int, cost_data_t *),
+                 bool (*mask)(MKL_INT, cost_data_t *cost_data)) {
+    int num_qubits;
     num_qubits = meta_data->machine_spec->num_qubits;
     double c_sum = 0.0, classic_prob;
-    classic_prob = (double) 1.0 / meta_data->cost_data->x_range;
+    int minimum = INT_MAX, maximum = INT_MIN;
+    const char *directory = meta_data->run_spec->ooc_directory;
+    cost_vector_t *cost = cost_vector_allocate(meta_data->machine_spec->space_dimension, COST_INT32, directory);
+    int32_t *values = cost->values;
+    //A symmetric half-space stands for each of its states and their complements
+    double multiplicity = meta_data->run_spec->symmetric ? 2.0 : 1.0;
+    classic_prob = multiplicity / meta_data->cost_data->x_range;
     meta_data->qaoa_statistics->max_value = INT_MIN;
     meta_data->qaoa_statistics->max_index = 0;
-    for (i = 0; i < meta_data->machine_spec->space_dimension; ++i) {
-        current = Cx(i, num_qubits, meta_data->cost_data);
-        //current = 0;
-        if (current > meta_data->qaoa_statistics->max_value && mask((unsigned) i, meta_data->cost_data)) {
-            meta_data->qaoa_statistics->max_value = current;
-            meta_data->qaoa_statistics->max_index = i;
+#pragma omp parallel
+    {
+        int local_max = INT_MIN;
+        MKL_INT local_index = 0;
+#pragma omp for schedule(static) reduction(+:c_sum) reduction(min:minimum) reduction(max:maximum)
+        for (MKL_INT i = 0; i < meta_data->machine_spec->space_dimension; ++i) {
+            int current = Cx(i, num_qubits, meta_data->cost_data);
+            if (current > local_max && mask(i, meta_data->cost_data)) {
+                local_max = current;
+                local_index = i;
+            }
+            c_sum += (double) current * classic_prob;
+            minimum = current < minimum ? current : minimum;
+            maximum = current > maximum ? current : maximum;
+            values[i] = current;
+        }
+#pragma omp critical
+        if (local_max > meta_data->qaoa_statistics->max_value ||
+            (local_max == meta_data->qaoa_statistics->max_value &&
+             local_index < meta_data->qaoa_statistics->max_index)) {
+            meta_data->qaoa_statistics->max_value = local_max;
+            meta_data->qaoa_statistics->max_index = local_index;
         }
-        c_sum += (double) current * classic_prob;
-        //Pre-multplying by -I to save time later.
-        meta_data->uc[i].imag = -current;
     }
+    meta_data->uc = cost_vector_narrow(cost, minimum, maximum, directory);
     meta_data->qaoa_statistics->classical_exp = c_sum;
-    meta_data->qaoa_statistics->random_exp = c_sum * 1 / classic_prob / pow(2, num_qubits);
+    meta_data->qaoa_statistics->random_exp = c_sum * multiplicity / classic_prob / pow(2, num_qubits);
+}
+
+/**
+ * @brief Checks that the cost function and mask are invariant under flipping every bit, C(x) = C(~x)
+ * @details Required before evolving only the symmetric half-space (run_spec->symmetric). The uniform initial state and
+ * the transverse-field driver preserve the symmetry, so the whole evolution stays in the states with
+ * psi(x) = psi(~x).
+ * @param meta_data Contains the full machine specification and the cost data
+ * @param Cx The function which implements the problem-dependent cost-function
+ * @param mask The bit-string mask of valid candidate solutions
+ * @return The first state of the lower half-space breaking the symmetry, or -1 if there is none
+ */
+MKL_INT check_symmetry(qaoa_data_t *meta_data, int (*Cx)(MKL_INT, int, cost_data_t *),
+                       bool (*mask)(MKL_INT, cost_data_t *cost_data)) {
+    int num_qubits = meta_data->machine_spec->num_qubits;
+    MKL_INT half = meta_data->machine_spec->space_dimension / 2;
+    MKL_INT complement = meta_data->machine_spec->space_dimension - 1;
+    MKL_INT broken = half;
+#pragma omp parallel for schedule(static) reduction(min:broken)
+    for (MKL_INT i = 0; i < half; ++i) {
+        if (i < broken && (Cx(i, num_qubits, meta_data->cost_data) != Cx(i ^ complement, num_qubits,
+                                                                          meta_data->cost_data) ||
+                           mask(i, meta_data->cost_data) != mask(i ^ complement, meta_data->cost_data))) {
+            broken = i;
+        }
+    }
+    return broken == half ? -1 : broken;
 }
@@ -15,7 +15,10 @@
 #include "qaoa.h"
 #include "problem_code.h"
 
-void generate_uc(qaoa_data_t *meta_data, int (*Cx)(int, int, cost_data_t *),
-                 bool (*mask)(unsigned int, cost_data_t *cost_data));
+void generate_uc(qaoa_data_t *meta_data, int (*Cx)(MKL_INT, int, cost_data_t *),
+                 bool (*mask)(MKL_INT, cost_data_t *cost_data));
+
+MKL_INT check_symmetry(qaoa_data_t *meta_data, int (*Cx)(MKL_INT, int, cost_data_t *),
+                       bool (*mask)(MKL_INT, cost_data_t *cost_data));
 
 #endif //GRAPHSIMILARITY_UC_H
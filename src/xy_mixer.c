@@ -0,0 +1,194 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief The Trotterised XY mixer and its Dicke starting state
+ * @details A term on qubits low < high rotates each amplitude with low set and high clear together with its partner,
+ * low clear and high set. The k-th such pair is found by inserting the two qubits' bits into k, so one term is a
+ * single loop over a quarter of the state, statically divided between threads as in the other kernels.
+ */
+
+#include <mathimf.h>
+#include "xy_mixer.h"
+#include "profiling.h"
+
+/**
+ * @brief Inserts a zero bit into an index
+ * @param k The index
+ * @param bit The position of the new bit
+ * @return k with the bits from position bit upwards moved up by one
+ */
+static inline MKL_INT insert_zero(MKL_INT k, int bit) {
+    MKL_INT low = k & (((MKL_INT) 1 << bit) - 1);
+    return ((k - low) << 1) | low;
+}
+
+/**
+ * @brief Rotates a range of the pairs of one XY term by exp(-i theta (X X + Y Y) / 2)
+ * @param state The amplitudes the term acts on, updated in place
+ * @param first The first pair
+ * @param count The number of pairs
+ * @param low The lower qubit of the term
+ * @param high The higher qubit of the term
+ * @param c cos(theta)
+ * @param s sin(theta)
+ */
+static void rotate_term(MKL_Complex16 *state, MKL_INT first, MKL_INT count, int low, int high, double c, double s) {
+    MKL_INT low_bit = (MKL_INT) 1 << low;
+    MKL_INT high_bit = (MKL_INT) 1 << high;
+    for (MKL_INT k = first; k < first + count; ++k) {
+        MKL_INT i = insert_zero(insert_zero(k, low), high) | low_bit;
+        MKL_INT j = i ^ low_bit ^ high_bit;
+        MKL_Complex16 x = state[i];
+        MKL_Complex16 y = state[j];
+        state[i].real = c * x.real + s * y.imag;
+        state[i].imag = c * x.imag - s * y.real;
+        state[j].real = c * y.real + s * x.imag;
+        state[j].imag = c * y.imag - s * x.real;
+    }
+}
+
+/**
+ * @brief Lists the terms of the XY mixer, ordered by their higher then lower qubit
+ * @param num_qubits The number of qubits (at least 2)
+ * @param topology The coupled pairs
+ * @param low Receives the lower qubit of each term (xy_mixer_terms() entries)
+ * @param high Receives the higher qubit of each term
+ */
+static void list_terms(int num_qubits, xy_topology_t topology, int *low, int *high) {
+    int count = 0;
+    for (int h = 1; h < num_qubits; ++h) {
+        if (topology == XY_COMPLETE) {
+            for (int l = 0; l < h; ++l) {
+                low[count] = l;
+                high[count++] = h;
+            }
+        } else {
+            //The ring closes with the pair of the end qubits, unless that is the only pair
+            if (h == num_qubits - 1 && num_qubits > 2) {
+                low[count] = 0;
+                high[count++] = h;
+            }
+            low[count] = h - 1;
+            high[count++] = h;
+        }
+    }
+}
+
+/**
+ * @brief Counts the leading terms of the order of list_terms() whose qubits all lie within a block
+ * @param num_qubits The number of qubits (at least 2)
+ * @param topology The coupled pairs
+ * @param block The number of amplitudes per block (a power of two, at most the state's)
+ * @return The number of terms applied block by block
+ */
+static int resident_terms(int num_qubits, xy_topology_t topology, MKL_INT block) {
+    int resident = 0;
+    while (((MKL_INT) 1 << resident) < block) {
+        resident++;
+    }
+    if (resident == 0) {
+        return 0;
+    }
+    if (topology == XY_COMPLETE) {
+        return resident * (resident - 1) / 2;
+    }
+    return resident - 1 + (resident == num_qubits && num_qubits > 2 ? 1 : 0);
+}
+
+/**
+ * @brief Counts the terms of the XY mixer, which bounds the spectrum of its driver
+ * @param num_qubits The number of qubits (at least 2)
+ * @param topology The coupled pairs
+ * @return The number of coupled pairs
+ */
+int xy_mixer_terms(int num_qubits, xy_topology_t topology) {
+    if (topology == XY_COMPLETE) {
+        return num_qubits * (num_qubits - 1) / 2;
+    }
+    return num_qubits > 2 ? num_qubits : 1;
+}
+
+/**
+ * @brief The bytes moved by xy_mixer_expm(): a blocked pass reads and writes every amplitude, each other term the half
+ * of them it couples
+ * @param num_qubits The number of qubits (at least 2)
+ * @param topology The coupled pairs
+ * @param steps The number of Trotter steps
+ * @param block_length The number of amplitudes per block (a power of two)
+ * @return The number of bytes
+ */
+long long xy_mixer_bytes(int num_qubits, xy_topology_t topology, int steps, MKL_INT block_length) {
+    MKL_INT dimension = (MKL_INT) 1 << num_qubits;
+    int num_terms = xy_mixer_terms(num_qubits, topology);
+    int num_resident = resident_terms(num_qubits, topology, block_length < dimension ? block_length : dimension);
+    return (long long) steps * ((num_resident > 0 ? 2 : 0) + num_terms - num_resident) * dimension *
+           (long long) sizeof(MKL_Complex16);
+}
+
+/**
+ * @brief Initialises a state to the Dicke state, the equal superposition of every state of a Hamming weight
+ * @param state The vector which will be initialised, pow(2, num_qubits) amplitudes
+ * @param num_qubits The number of qubits
+ * @param weight The Hamming weight (0 to num_qubits)
+ */
+void xy_mixer_initialise(MKL_Complex16 *state, int num_qubits, int weight) {
+    MKL_INT dimension = (MKL_INT) 1 << num_qubits;
+    double count = 1.0;
+    for (int j = 1; j <= weight; ++j) {
+        count = count * (num_qubits - weight + j) / j;
+    }
+    double amplitude = 1.0 / sqrt(count);
+#pragma omp parallel for schedule(static)
+    for (MKL_INT i = 0; i < dimension; ++i) {
+        state[i].real = __builtin_popcountll((unsigned long long) i) == weight ? amplitude : 0.0;
+        state[i].imag = 0.0;
+    }
+}
+
+/**
+ * @brief Computes the action of the Trotterised XY mixer on a vector
+ * @details Every step applies the terms in the order of list_terms(). As that order leads with the terms whose higher
+ * qubit lies within a block, those are applied block by block in one pass; each remaining term makes a pass of its own
+ * over the half of the state it couples. The result does not depend on the block length.
+ * @param state The vector to which the action is applied
+ * @param beta The mixing angle (negative to invert)
+ * @param num_qubits The number of qubits (the state has pow(2, num_qubits) amplitudes, at least 2 qubits)
+ * @param topology The coupled pairs
+ * @param steps The number of Trotter steps
+ * @param block_length The number of amplitudes per block (a power of two)
+ */
+void xy_mixer_expm(MKL_Complex16 *state, double beta, int num_qubits, xy_topology_t topology, int steps,
+                   MKL_INT block_length) {
+    PROFILE_BEGIN(profile_mark);
+    MKL_INT dimension = (MKL_INT) 1 << num_qubits;
+    MKL_INT block = block_length < dimension ? block_length : dimension;
+    MKL_INT num_blocks = dimension / block;
+    MKL_INT chunk = block / 4 > 0 ? block / 4 : 1;
+    int num_terms = xy_mixer_terms(num_qubits, topology);
+    double c = cos(beta / steps);
+    double s = sin(beta / steps);
+    int *low = mkl_malloc(2 * num_terms * sizeof(int), DEF_ALIGNMENT);
+    check_alloc(low);
+    int *high = low + num_terms;
+    list_terms(num_qubits, topology, low, high);
+    int num_resident = resident_terms(num_qubits, topology, block);
+
+    for (int step = 0; step < steps; ++step) {
+        if (num_resident > 0) {
+#pragma omp parallel for schedule(static)
+            for (MKL_INT b = 0; b < num_blocks; ++b) {
+                for (int t = 0; t < num_resident; ++t) {
+                    rotate_term(state + b * block, 0, block / 4, low[t], high[t], c, s);
+                }
+            }
+        }
+        for (int t = num_resident; t < num_terms; ++t) {
+#pragma omp parallel for schedule(static)
+            for (MKL_INT first = 0; first < dimension / 4; first += chunk) {
+                rotate_term(state, first, chunk, low[t], high[t], c, s);
+            }
+        }
+    }
+    mkl_free(low);
+    PROFILE_END(PROFILE_MIXER, profile_mark, xy_mixer_bytes(num_qubits, topology, steps, block_length), 0);
+}
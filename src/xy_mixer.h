@@ -0,0 +1,30 @@
+/**
+ * @author Nicholas Pritchard
+ * @date 18/10/2026
+ * @brief The XY mixer, a Trotterised exp(-i beta B) for B = sum over coupled pairs (j, k) of (X_j X_k + Y_j Y_k) / 2
+ * @details Each term swaps the amplitudes of |01> and |10> on its pair, so the mixer preserves the Hamming weight of
+ * every state: a Hamming-weight constraint is kept by construction, without mask() or UB. The pairs are a ring or the
+ * complete graph (run_spec->xy_topology) and each of run_spec->xy_steps Trotter steps applies every term's exact
+ * rotation by beta / xy_steps in place, in order of their higher then lower qubit. The terms between qubits that lie
+ * within a block of run_spec->block_length amplitudes are applied together while the block is resident, each other
+ * term takes one pass over half the state. The evolution starts from the Dicke state of weight run_spec->xy_weight,
+ * the equal superposition of the states of that weight.
+ *
+ * Selected by run_spec->mixer = MIXER_XY in the standard and restricted QAOA.
+ */
+
+#ifndef QOLAB_XY_MIXER_H
+#define QOLAB_XY_MIXER_H
+
+#include "globals.h"
+
+int xy_mixer_terms(int num_qubits, xy_topology_t topology);
+
+long long xy_mixer_bytes(int num_qubits, xy_topology_t topology, int steps, MKL_INT block_length);
+
+void xy_mixer_initialise(MKL_Complex16 *state, int num_qubits, int weight);
+
+void xy_mixer_expm(MKL_Complex16 *state, double beta, int num_qubits, xy_topology_t topology, int steps,
+                   MKL_INT block_length);
+
+#endif //QOLAB_XY_MIXER_H